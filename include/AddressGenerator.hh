@@ -10,6 +10,7 @@
 #include <assert.h>
 #include <iostream>
 #include <string>
+#include <utility>
 
 using std::cout;
 using std::endl;
@@ -39,6 +40,8 @@ struct Descriptor_2D
     int y_modify;          // number of floats between each transfer/wait
     int x_counter;
     int y_counter;
+    unsigned int modulo_base;   // first index of the ring the addresses wrap in
+    unsigned int modulo_length; // ring length, 0 for linear addressing
 
     Descriptor_2D(unsigned int _next, unsigned int _start, DescriptorState _state,
                   unsigned int _x_count, int _x_modify, unsigned int _y_count,
@@ -52,10 +55,17 @@ struct Descriptor_2D
     
     void y_count_update(int count);
 
+    // index folded back into the ring, unchanged for linear descriptors
+    unsigned int wrap(long int index) const;
+
+    // lowest and highest index a GENERATE descriptor visits
+    std::pair<long int, long int> address_range() const;
+
     static void make_sequential(vector<Descriptor_2D>& program);
 
     static Descriptor_2D delay_inst(int delay_time);
-    static Descriptor_2D stream_inst(int start_idx, int stream_size, int repeats);
+    static Descriptor_2D stream_inst(int start_idx, int stream_size, int repeats, int stride = 1);
+    static Descriptor_2D ring_stream_inst(int start_idx, int stream_size, int ring_base, int ring_length);
     static Descriptor_2D genhold_inst(int start_idx, int hold_time, int repeats, int access_offset);
     static Descriptor_2D suspend_inst();
 
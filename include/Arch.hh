@@ -0,0 +1,615 @@
+#if !defined(__ARCH_CPP__)
+#define __ARCH_CPP__
+
+#include <systemc>
+#include "AddressGenerator.hh"
+#include "GlobalBuffer.hh"
+#include "GlobalControl.hh"
+#include "Mapper.hh"
+#include "MemoryHierarchy.hh"
+#include "PostProcessor.hh"
+#include "ProcEngine.hh"
+#include "SAM.hh"
+#include "TensorLayout.hh"
+#include "Watchdog.hh"
+#include "WeightPacker.hh"
+#include "ZeroCompression.hh"
+#include <iostream>
+#include <string>
+#include <tuple>
+#include <vector>
+#include <xtensor/xarray.hpp>
+
+using std::cout;
+using std::endl;
+using std::string;
+using std::tuple;
+using std::vector;
+using namespace sc_core;
+using namespace sc_dt;
+
+template <typename DataType>
+struct SignalVectorCreator
+{
+    SignalVectorCreator(unsigned int _width, sc_trace_file *_tf) : tf(_tf), width(_width) {}
+
+    sc_vector<sc_signal<DataType>> *operator()(const char *name, size_t)
+    {
+        return new sc_vector<sc_signal<DataType>>(name, width);
+    }
+    sc_trace_file *tf;
+    unsigned int width;
+};
+
+template <typename DataType>
+struct PeCreator
+{
+    PeCreator(sc_trace_file *_tf) : tf(_tf)
+    {
+    }
+    PE<DataType> *operator()(const char *name, size_t)
+    {
+        return new PE<DataType>(name, this->tf);
+    }
+    sc_trace_file *tf;
+};
+
+template <typename DataType>
+struct Arch : public sc_module
+{
+    // Member Signals
+private:
+    sc_in_clk _clk;
+
+public:
+    sc_port<GlobalControlChannel_IF> control;
+    sc_vector<PE<DataType>> pe_array;
+    // sc_vector<sc_signal<DataType>> filter_psum_out{"filter_psum_out", filter_count};
+    sc_trace_file *tf;
+    SAM<DataType> psum_mem;
+    sc_vector<sc_vector<sc_signal<DataType>>> psum_mem_read;
+
+    sc_vector<sc_vector<sc_signal<DataType>>> psum_mem_write;
+    SAM<DataType> ifmap_mem;
+    sc_vector<sc_vector<sc_signal<DataType>>> ifmap_mem_read;
+    sc_vector<sc_vector<sc_signal<DataType>>> ifmap_mem_write;
+    vector<PostProcessor<DataType>> psum_post_processors;
+    Mapping mapping; // filter_count x channel_count is the logical array of the mapping
+    TensorLayout ifmap_layout; // placement of the ifmap in ifmap mem
+    TensorLayout ofmap_layout; // placement of psums and the ofmap in psum mem
+    int ifmap_channels{0};     // channels of the layer load_weights loaded
+    int ofmap_channels{0};
+
+    // line buffer mode, column ch streams through its own ring of
+    // ifmap_ring_length words at ch * ifmap_ring_length and every word read
+    // is replaced by the one ifmap_ring_length reads ahead from DRAM
+    int ifmap_ring_length{0};                // 0 keeps the whole ifmap resident
+    vector<vector<int>> ifmap_ring_channels; // per column, channels in stream order
+    vector<vector<int>> ifmap_ring_feed;     // per column, words in read order
+    vector<unsigned int> ifmap_ring_reads;
+
+    // ifmap planes are stored compressed and decompressed on the read channels
+    CompressionFormat ifmap_compression{CompressionFormat::NONE};
+    ZeroDecompressor<DataType> ifmap_decompressor;
+    long int ifmap_stored_words{0}; // over every ifmap written, compressed
+    long int ifmap_dense_words{0};  // and uncompressed
+
+    // weights reach the PEs from the weight SAM, channel ch serves the
+    // rows/columns ch, ch + weight_channel_count, ... in turn
+    WeightBufferConfig weight_config;
+    int weight_channel_count;
+    SAM<DataType> weight_mem;
+    sc_vector<sc_vector<sc_signal<DataType>>> weight_mem_read;
+    sc_vector<sc_vector<sc_signal<DataType>>> weight_mem_write;
+    vector<unsigned int> weight_region_base; // per channel, set by load_weights
+    PackedWeights weight_image;               // what load_weights wrote to the weight SAM
+    vector<bool> weight_pending;              // a read was issued last cycle
+    vector<unsigned int> weight_pending_addr;
+    int weight_preload_cycles{0};
+
+    unsigned int dram_access_counter{0};
+    unsigned int weight_dram_access_counter{0}; // the weight part of dram_access_counter
+    unsigned int onchip_transfer_counter{0};
+    bool pause_on_suspend{false}; // multi phase runs pause instead of ending the simulation
+    bool stop_on_suspend{true};   // clusters leave stopping to a ClusterMonitor
+    bool suspended{false};
+    sc_time suspend_time;
+    ProgressWatchdog watchdog; // unbounded unless a budget or stall limit is set
+    bool hung{false};
+    int filter_count;
+    int channel_count;
+    int psum_mem_size;
+    int ifmap_mem_size;
+    int weight_mem_size;
+
+    // rows for ROW delivery, columns for COLUMN delivery
+    int weight_lines()
+    {
+        return (weight_config.delivery == WeightDelivery::ROW) ? filter_count : channel_count;
+    }
+
+    int weight_lanes()
+    {
+        return (weight_config.delivery == WeightDelivery::ROW) ? channel_count : filter_count;
+    }
+
+    int weight_lines_of_channel(int channel)
+    {
+        return weight_channel_lines(weight_lines(), weight_channel_count, channel);
+    }
+
+    PE<DataType> &weight_destination(int line, int lane)
+    {
+        return (weight_config.delivery == WeightDelivery::ROW) ? pe_array[line * channel_count + lane] : pe_array[lane * channel_count + line];
+    }
+
+    // A word read in the previous cycle is on the read bus now, its address
+    // tells which row/column of PEs it belongs to.
+    void deliver_weights()
+    {
+        for (int channel = 0; channel < weight_channel_count; channel++)
+        {
+            if (weight_pending[channel])
+            {
+                int offset = weight_pending_addr[channel] - weight_region_base.at(channel);
+                int line = (offset % weight_lines_of_channel(channel)) * weight_channel_count + channel;
+                for (int lane = 0; lane < weight_lanes(); lane++)
+                {
+                    weight_destination(line, lane).pushWeight((int)weight_mem_read[channel][lane].read());
+                }
+            }
+            weight_pending[channel] = weight_mem.channels[channel].enabled();
+            weight_pending_addr[channel] = weight_mem.channels[channel].addr();
+        }
+    }
+
+    // Memory samples the ring word before this write lands so the slot can
+    // be refilled in the cycle it is read.
+    void refill_ifmap_rings()
+    {
+        if (!ifmap_ring_length)
+        {
+            return;
+        }
+        for (int column = 0; column < channel_count; column++)
+        {
+            if (!ifmap_mem.channels[column].enabled())
+            {
+                continue;
+            }
+            unsigned int read = ifmap_ring_reads[column]++;
+            unsigned int addr = ifmap_mem.channels[column].addr();
+            assert(addr == column * ifmap_ring_length + read % ifmap_ring_length);
+            if (read + ifmap_ring_length < ifmap_ring_feed[column].size())
+            {
+                ifmap_mem.mem.ram.at(addr).at(0) = ifmap_ring_feed[column][read + ifmap_ring_length];
+                dram_access_counter++;
+                ifmap_mem.mem.access_counter++;
+            }
+        }
+    }
+
+    // control state of every generator and PE, data and utilization
+    // counters are left out so an idle but stuck arch hashes the same
+    uint64_t state_signature()
+    {
+        StateHasher hasher;
+        for (auto *sam : {&ifmap_mem, &psum_mem, &weight_mem})
+        {
+            for (auto &gen : sam->generators)
+            {
+                hasher.add(gen.execute_index.read());
+                hasher.add(gen.current_ram_index.read());
+                hasher.add(gen.x_count_remaining.read());
+                hasher.add(gen.y_count_remaining.read());
+                hasher.add(gen.repeat.read());
+            }
+        }
+        for (auto &pe : pe_array)
+        {
+            auto &descriptor = pe.program.at(pe.prog_idx);
+            hasher.add(pe.prog_idx);
+            hasher.add(descriptor.x_counter);
+            hasher.add(descriptor.y_counter);
+            hasher.add(pe.weight_idx);
+            hasher.add(pe.weight_fill);
+        }
+        return hasher.hash;
+    }
+
+    void dump_state()
+    {
+        cout << "Watchdog: " << watchdog.reason() << " at " << sc_time_stamp() << endl;
+        vector<pair<string, SAM<DataType> *>> sams = {{"ifmap", &ifmap_mem}, {"psum", &psum_mem}, {"weight", &weight_mem}};
+        for (auto &sam : sams)
+        {
+            for (unsigned int idx = 0; idx < sam.second->generators.size(); idx++)
+            {
+                auto &gen = sam.second->generators[idx];
+                auto descriptor = gen.currentDescriptor();
+                cout << sam.first << " generator " << idx << " descriptor " << gen.execute_index.read() << "/" << gen.descriptors.size() << " state " << (int)descriptor.state << " next " << descriptor.next << " addr " << gen.current_ram_index.read() << " x " << gen.x_count_remaining.read() << " y " << gen.y_count_remaining.read() << " repeat " << gen.repeat.read() << endl;
+            }
+        }
+        for (unsigned int idx = 0; idx < pe_array.size(); idx++)
+        {
+            auto &pe = pe_array[idx];
+            auto &descriptor = pe.program.at(pe.prog_idx);
+            cout << "pe " << idx / channel_count << "," << idx % channel_count << " descriptor " << pe.prog_idx << "/" << pe.program.size() << " state " << (int)descriptor.state << " next " << descriptor.next << " x " << descriptor.x_counter << " y " << descriptor.y_counter << " weight " << pe.weight_idx << endl;
+        }
+    }
+
+    void suspend_monitor()
+    {
+        while (1)
+        {
+            while (control->enable())
+            {
+                // a suspended arch waiting for others to finish is not stalled
+                if (!suspended && (watchdog.cycle_budget || watchdog.stall_limit) && watchdog.observe(state_signature()) != WatchdogVerdict::RUNNING)
+                {
+                    if (!hung)
+                    {
+                        hung = true;
+                        dump_state();
+                        sc_stop();
+                    }
+                    wait();
+                    continue;
+                }
+                bool pes_suspended = true;
+                for (auto &pe : pe_array)
+                {
+                    pes_suspended &= (pe.program.at(pe.prog_idx).state == DescriptorState::SUSPENDED);
+                }
+                bool ifmap_generators_suspended = true;
+                for (auto &gen : ifmap_mem.generators)
+                {
+                    ifmap_generators_suspended &= (gen.currentDescriptor().state == DescriptorState::SUSPENDED);
+                }
+                bool psum_generators_suspended = true;
+                for (auto &gen : psum_mem.generators)
+                {
+                    psum_generators_suspended &= (gen.currentDescriptor().state == DescriptorState::SUSPENDED);
+                }
+                bool weight_generators_suspended = true;
+                for (auto &gen : weight_mem.generators)
+                {
+                    weight_generators_suspended &= (gen.currentDescriptor().state == DescriptorState::SUSPENDED);
+                }
+                if (pes_suspended && ifmap_generators_suspended && psum_generators_suspended && weight_generators_suspended)
+                {
+                    if (!suspended)
+                    {
+                        suspended = true;
+                        suspend_time = sc_time_stamp();
+                    }
+                    if (stop_on_suspend && pause_on_suspend)
+                    {
+                        sc_pause();
+                    }
+                    else if (stop_on_suspend)
+                    {
+                        sc_stop();
+                    }
+                }
+                else
+                {
+                    suspended = false;
+                }
+                wait();
+            }
+            wait();
+        }
+    }
+
+    void update_1x1()
+    {
+        while (1)
+        {
+            while (control->enable())
+            {
+                deliver_weights();
+                refill_ifmap_rings();
+                for (int filter_row = 0; filter_row < filter_count; filter_row++)
+                {
+                    PE<DataType> &first_pe_in_row = this->pe_array[filter_row * channel_count];
+                    first_pe_in_row.psum_in = psum_mem_read.at(filter_row + filter_count).at(0).read();
+                }
+                for (int filter_row = 0; filter_row < filter_count; filter_row++)
+                {
+                    for (int channel_column = 0; channel_column < channel_count - 1; channel_column++)
+                    {
+
+                        PE<DataType> &cur_pe = this->pe_array[filter_row * channel_count + channel_column];
+                        PE<DataType> &next_pe = this->pe_array[filter_row * channel_count + channel_column + 1];
+                        if (cur_pe.current_weight.read() != weight_packer::PAD)
+                        {
+                            cur_pe.active_counter++;
+                            next_pe.psum_in = cur_pe.compute(ifmap_mem_read[channel_column][0].read());
+                        }
+                        else
+                        {
+                            // bypass
+                            cur_pe.inactive_counter++;
+                            next_pe.psum_in = cur_pe.psum_in.read();
+                        }
+                        cur_pe.updateState();
+                    }
+                    PE<DataType> &last_pe = this->pe_array[filter_row * channel_count + channel_count - 1];
+
+                    if (last_pe.current_weight.read() != weight_packer::PAD)
+                    {
+                        last_pe.active_counter++;
+                        psum_mem_write[filter_row][0] = last_pe.compute(ifmap_mem_read[channel_count - 1][0].read());
+                    }
+                    else
+                    {
+                        last_pe.inactive_counter++;
+                        psum_mem_write[filter_row][0] = last_pe.psum_in.read();
+                    }
+                    last_pe.updateState();
+                }
+                // for(int i =0 ; i < 7; i++)
+                // {
+                //     for(int j = 0; j<9; j++)
+                //     {
+                //         cout << this->pe_array[i*9 + j].current_weight.read() << " ";
+                //     }
+                //     cout << endl;
+                // }
+                wait();
+            }
+            wait();
+        }
+    }
+
+    // Constructor
+    Arch(
+        sc_module_name name,
+        GlobalControlChannel &_control,
+        int filter_count,
+        int channel_count,
+        int psum_mem_size,
+        int ifmap_mem_size,
+        int weight_mem_size,
+        sc_trace_file *_tf,
+        const WeightBufferConfig &_weight_config = WeightBufferConfig()) : sc_module(name),
+                              pe_array("pe_array", filter_count * channel_count, PeCreator<DataType>(_tf)),
+                              tf(_tf),
+                              psum_mem("psum_mem", _control, filter_count * 2, psum_mem_size, 1, _tf),
+                              psum_mem_read("psum_mem_read", filter_count * 2, SignalVectorCreator<DataType>(1, tf)),
+                              psum_mem_write("psum_mem_write", filter_count * 2, SignalVectorCreator<DataType>(1, tf)),
+                              ifmap_mem("ifmap_mem", _control, channel_count, ifmap_mem_size, 1, _tf),
+                              ifmap_mem_read("ifmap_mem_read", channel_count, SignalVectorCreator<DataType>(1, tf)),
+                              ifmap_mem_write("ifmap_mem_write", channel_count, SignalVectorCreator<DataType>(1, tf)),
+                              psum_post_processors(filter_count),
+                              mapping(UnrollOrientation::HORIZONTAL, LoopOrder::FILTER_TILES_OUTER, filter_count, channel_count),
+                              weight_config(_weight_config),
+                              weight_channel_count(weight_channel_count_of(_weight_config, filter_count, channel_count)),
+                              weight_mem("weight_mem", _control, weight_channel_count, weight_mem_lines(_weight_config, filter_count, channel_count, weight_mem_size), weight_lanes_of(_weight_config, filter_count, channel_count), _tf),
+                              weight_mem_read("weight_mem_read", weight_channel_count, SignalVectorCreator<DataType>(weight_lanes_of(_weight_config, filter_count, channel_count), tf)),
+                              weight_mem_write("weight_mem_write", weight_channel_count, SignalVectorCreator<DataType>(weight_lanes_of(_weight_config, filter_count, channel_count), tf)),
+                              weight_region_base(weight_channel_count, 0),
+                              weight_pending(weight_channel_count, false),
+                              weight_pending_addr(weight_channel_count, 0)
+    {
+        control(_control);
+        _clk(control->clk());
+        this->filter_count = filter_count;
+        this->channel_count = channel_count;
+        this->psum_mem_size = psum_mem_size;
+        this->ifmap_mem_size = ifmap_mem_size;
+        this->weight_mem_size = weight_mem_size;
+
+        // for(auto& psum: this->filter_psum_out)
+        // {
+        //     sc_trace(tf, psum, psum.name());
+        // }
+
+        // psum_read/write
+        for (int i = 0; i < filter_count * 2; i++)
+        {
+            psum_mem.read_channel_data[i][0](psum_mem_read[i][0]);
+            psum_mem.write_channel_data[i][0](psum_mem_write[i][0]);
+        }
+        for (int i = 0; i < filter_count; i++)
+        {
+            psum_mem.channels[i].set_mode(MemoryChannelMode::WRITE);
+            sc_trace(tf, psum_mem_write[i][0], (this->psum_mem_write[i][0].name()));
+        }
+        for (int i = filter_count; i < filter_count * 2; i++)
+        {
+            psum_mem.channels[i].set_mode(MemoryChannelMode::READ);
+            sc_trace(tf, psum_mem_read[i][0], (this->psum_mem_read[i][0].name()));
+        }
+
+        for (int i = 0; i < channel_count; i++)
+        {
+            ifmap_mem.channels[i].set_mode(MemoryChannelMode::READ);
+            ifmap_mem.read_channel_data[i][0](ifmap_mem_read[i][0]);
+            ifmap_mem.write_channel_data[i][0](ifmap_mem_write[i][0]);
+            sc_trace(tf, ifmap_mem_read[i][0], (this->ifmap_mem_read[i][0].name()));
+        }
+
+        for (int i = 0; i < weight_channel_count; i++)
+        {
+            weight_mem.channels[i].set_mode(MemoryChannelMode::READ);
+            for (int lane = 0; lane < weight_lanes(); lane++)
+            {
+                weight_mem.read_channel_data[i][lane](weight_mem_read[i][lane]);
+                weight_mem.write_channel_data[i][lane](weight_mem_write[i][lane]);
+            }
+        }
+        for (auto &pe : pe_array)
+        {
+            pe.weight_reg_capacity = weight_config.reg_capacity;
+        }
+
+        SC_THREAD(update_1x1);
+        sensitive << _clk.pos();
+        sensitive << control->reset();
+
+        SC_THREAD(suspend_monitor);
+        sensitive << _clk.pos();
+        sensitive << control->reset();
+        cout << "Arch MODULE: " << name << " has been instantiated " << endl;
+    }
+
+    static int weight_channel_count_of(const WeightBufferConfig &config, int filter_count, int channel_count)
+    {
+        int lines = (config.delivery == WeightDelivery::ROW) ? filter_count : channel_count;
+        return (config.channel_count > 0) ? std::min(config.channel_count, lines) : lines;
+    }
+
+    static int weight_lanes_of(const WeightBufferConfig &config, int filter_count, int channel_count)
+    {
+        return (config.delivery == WeightDelivery::ROW) ? channel_count : filter_count;
+    }
+
+    static int weight_mem_lines(const WeightBufferConfig &config, int filter_count, int channel_count, int weight_mem_size)
+    {
+        int lanes = weight_lanes_of(config, filter_count, channel_count);
+        return (weight_mem_size + lanes - 1) / lanes;
+    }
+
+    SC_HAS_PROCESS(Arch);
+};
+
+// Weight program timing, in cycles, taken from the generator and the
+// weight path. A generator descriptor of count n occupies n plus
+// DESCRIPTOR_OVERHEAD_CYCLES, the cycle it is loaded in and the one its
+// channel enable takes to settle, so a stream of l words (count l - 1) takes
+// l + 1 cycles and delay_inst(d) d + 2.
+constexpr int DESCRIPTOR_OVERHEAD_CYCLES = 2;
+
+// From a weight SAM address to the word in the PE register: the SAM read and
+// deliver_weights' pending stage.
+constexpr int WEIGHT_READ_CYCLES = 2;
+
+// From enable to the last preloaded weight in its register: the preload
+// stream's descriptor overhead and the weight read.
+constexpr int WEIGHT_PRELOAD_LATENCY = DESCRIPTOR_OVERHEAD_CYCLES + WEIGHT_READ_CYCLES;
+
+// words of the weight SAM image load_weights packs for a layer
+int padded_weight_size(const Mapping &mapping, int filter_count, int channel_count, int f_out, int c_in, int k);
+
+template <typename DataType>
+void set_channel_modes(Arch<DataType> &arch);
+
+// Writes C x H x W activations into ifmap mem compressed plane by plane,
+// each plane's metadata then values right after the previous plane, and
+// puts the decompressor on the read channels. Returns the words written.
+template <typename DataType>
+int store_compressed_ifmap(Arch<DataType> &arch, const xt::xarray<int> &planes);
+
+// Loads the ifmap into the outermost level, moves it level by level down
+// the hierarchy and hands the innermost level's copy to ifmap mem, one
+// access per word on both sides.
+template <typename DataType>
+xt::xarray<int> stage_ifmap(Arch<DataType> &arch, MemoryHierarchy<DataType> &hierarchy, int channel_in, int ifmap_h, int ifmap_w);
+
+template <typename DataType>
+xt::xarray<int> dram_load(Arch<DataType> &arch, int channel_in, int ifmap_h, int ifmap_w);
+
+// filter_stride is the plane each filter was laid out with in psum mem, 0
+// means the ofmap's own plane
+template <typename DataType>
+xt::xarray<int> dram_store(Arch<DataType> &arch, int filter_out, int ofmap_h, int ofmap_w, int filter_stride = 0);
+
+template <typename DataType>
+void dram_load_strip(Arch<DataType> &arch, xt::xarray<int> ifmap, int row_start, int row_count);
+
+// Moves a layer's output from psum mem into ifmap mem for the next fused
+// layer without a DRAM round trip. The move is modelled as a streaming
+// transfer over min(filter_count, channel_count) lanes, one word per lane
+// per cycle.
+template <typename DataType>
+void onchip_transfer(Arch<DataType> &arch, int channels, int ofmap_h, int ofmap_w, int filter_stride);
+
+// Cycles until every weight SAM channel has preloaded preload_tiles tiles of
+// max_lines words each, the slowest channel holds max_lines per tile.
+int weight_preload_cycles(int preload_tiles, int max_lines);
+
+// Every weight SAM channel first preloads as many tiles as the PE registers
+// hold, compute starts once the slowest channel is done. Further tiles are
+// streamed while the array computes, each one after the tile it replaces has
+// left every PE of the row/column. The windows are sized from the last
+// column, which sees its weights channel_count cycles late.
+template <typename DataType>
+void generate_and_load_weight_program(Arch<DataType> &arch, int tile_count, int ifmap_h, int ifmap_w);
+
+template <typename DataType>
+void generate_and_load_pe_program(Arch<DataType> &arch, const WeightTiles &tiles, int ifmap_h, int ifmap_w);
+
+template <typename DataType>
+void generate_and_load_psum_program(Arch<DataType> &arch, const WeightTiles &tiles, int ofmap_h, int ofmap_w);
+
+template <typename DataType>
+void generate_and_load_post_processors(Arch<DataType> &arch, const WeightTiles &tiles, xt::xarray<int> biases, int ofmap_h, int ofmap_w, const PostProcessConfig &config);
+
+template <typename DataType>
+void generate_and_load_ifmap_in_program(Arch<DataType> &arch, const WeightTiles &tiles, int ifmap_h, int ifmap_w);
+
+// Line buffer counterpart of dram_load, run after the ifmap programs are
+// generated. Lays out every column's reads in order and preloads the first
+// ring's worth, the rest arrives through refill_ifmap_rings.
+template <typename DataType>
+void load_ifmap_rings(Arch<DataType> &arch, const xt::xarray<int> &ifmap);
+
+// weights.shape() = F*C*K*K, returns the tile grid of the unrolled
+// F x C*K*K weight matrix under the mapping. The program generators read
+// which PEs of a tile are active from it, no padded copy of the weights is
+// built, the weight SAM image is packed straight from the raw weights.
+template <typename DataType>
+WeightTiles weight_tiles(Arch<DataType> &arch, const xt::xarray<int> &weights);
+
+// packs the raw weights into the weight SAM, returns their weight_tiles
+template <typename DataType>
+WeightTiles load_weights(Arch<DataType> &arch, xt::xarray<int> weights);
+
+template <typename DataType>
+tuple<xt::xarray<int>, WeightTiles> generate_and_load_weights(Arch<DataType> &arch, int filter_out_dim, int channel_in_dim, int kernel);
+
+// Unit stride address runs the generators issue, a strided stream breaks
+// into single words. Fewer, longer runs are what wide SRAM rows and DRAM
+// bursts reward.
+template <typename DataType>
+int count_stream_runs(sc_vector<AddressGenerator<DataType>> &generators);
+
+// What the descriptor passes would save on the generator programs. Only
+// reported, merged streams drop switch bubbles the PE programs are timed
+// against. Generators run in parallel, so the largest saving of any one is
+// what the run could shorten by.
+template <typename DataType>
+void print_program_optimization(Arch<DataType> &arch);
+
+// Carves the layer's regions out of the global buffer and rejects programs
+// that leave them, must run after the programs are generated.
+template <typename DataType>
+void partition_global_buffer(Arch<DataType> &arch, GlobalBuffer &buffer, int ifmap_words, int psum_words, int weight_words);
+
+template <typename DataType>
+void print_compression(Arch<DataType> &arch);
+
+template <typename DataType>
+void print_memory_hierarchy(MemoryHierarchy<DataType> &hierarchy);
+
+// Reuse profile of the addresses a SAM actually saw next to the ones its
+// programs expand to, capacities are in SAM lines.
+template <typename DataType>
+void print_reuse(const string &label, SAM<DataType> &sam, const vector<unsigned int> &trace, double hit_rate, int window);
+
+void print_global_buffer(const string &label, const GlobalBuffer &buffer);
+
+// Bounds the arch's run to its next suspend, by --max_cycles or else the
+// estimate with --cycle_margin, and by --stall_cycles. What an earlier run
+// of the same arch counted is cleared.
+template <typename DataType>
+void arm_watchdog(Arch<DataType> &arch, const WatchdogConfig &config, long int estimated_cycles);
+
+// Reports a run the watchdog stopped. The simulation has ended then, the
+// caller has to return without starting it again.
+template <typename DataType>
+bool watchdog_stopped(const Arch<DataType> &arch);
+
+#endif
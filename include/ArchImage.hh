@@ -0,0 +1,30 @@
+#if !defined(__ARCH_IMAGE_CPP__)
+#define __ARCH_IMAGE_CPP__
+
+#include "Arch.hh"
+#include "ControlRegisters.hh"
+#include "DramArbiter.hh"
+#include "ProgramImage.hh"
+
+// Everything the weight and program builders loaded, taken before the run
+// since PE programs count down in place.
+template <typename DataType>
+ProgramImage capture_program_image(Arch<DataType> &arch, const LayerShape &layer);
+
+template <typename DataType>
+void load_image_program(Arch<DataType> &arch, ProgramTarget target, unsigned int idx, vector<Descriptor_2D> &program);
+
+// Stands in for load_weights and the program builders, the image must have
+// been captured for the same array and layer. Weights are written to the
+// weight SAM straight from the image.
+template <typename DataType>
+void apply_program_image(Arch<DataType> &arch, const ProgramImageView &image, const LayerShape &layer);
+
+// Puts everything the builders loaded back through the array's control
+// registers, whose callbacks write the same state the builders wrote
+// directly, and advances the simulation by the time the host took. Returns
+// the configuration cycles.
+template <typename DataType>
+unsigned long int configure_over_bus(Arch<DataType> &arch, ControlRegisters &csr, DramPort &host, const LayerShape &layer, ConfigPath path);
+
+#endif
@@ -0,0 +1,87 @@
+#if !defined(__CHANNEL_TRACE_CPP__)
+#define __CHANNEL_TRACE_CPP__
+
+#include "Memory_Channel.hh"
+#include <assert.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+struct ChannelAccess
+{
+    unsigned long int cycle;
+    unsigned int channel;
+    MemoryChannelMode mode;
+    unsigned int addr; // line address
+};
+
+/**
+ * @brief Every access a Memory served, in the order it served them, with
+ * the geometry it was recorded on. The binary image is a header followed by
+ * one record per access: the cycle delta, channel and mode packed in one
+ * varint, and the zigzag delta to the channel's previous address, so
+ * streaming channels cost about three bytes an access.
+ */
+struct ChannelTrace
+{
+    unsigned int channel_count;
+    unsigned int length;
+    unsigned int width;
+    vector<ChannelAccess> accesses;
+
+    void record(unsigned long int cycle, unsigned int channel, MemoryChannelMode mode, unsigned int addr);
+
+    vector<uint8_t> encode() const;
+    static ChannelTrace decode(const vector<uint8_t>& image);
+
+    void save(const string& path) const;
+    static ChannelTrace load(const string& path);
+
+    ChannelTrace(unsigned int _channel_count, unsigned int _length, unsigned int _width);
+};
+
+#define CHANNEL_TRACE_MAGIC "CHTR"
+#define CHANNEL_TRACE_VERSION 1
+
+/**
+ * @brief Memory variant a trace is replayed into. Lines are interleaved
+ * over single ported banks, a line access occupies its bank for a cycle.
+ * Changing the width re-slices the recorded lines: narrower lines cost
+ * several accesses, accesses of one cycle that land in the same wider line
+ * and mode merge into one.
+ */
+struct ReplayConfig
+{
+    unsigned int banks;
+    unsigned int latency; // cycles from issue to data
+    unsigned int width;   // words per line
+
+    string to_string() const;
+};
+
+// comma separated banks:latency:width variants
+vector<ReplayConfig> replay_configs_from_string(const string& configs);
+
+struct ReplayResult
+{
+    ReplayConfig config;
+    unsigned long int cycles;         // first issue to last data
+    unsigned long int stall_cycles;   // cycles every later access was pushed back by bank conflicts
+    unsigned long int line_accesses;  // after re-slicing to the variant's width
+    unsigned long int conflict_cycles; // recorded cycles that needed more than one bank cycle
+    vector<unsigned long int> bank_accesses;
+
+    double bank_utilization() const;
+};
+
+// Open loop: accesses keep their recorded order and spacing, only conflicts
+// push them back, there is no feedback from data arrival to issue.
+ReplayResult replay_trace(const ChannelTrace& trace, const ReplayConfig& config);
+
+// one variant per job spread over `threads` workers, results in config order
+vector<ReplayResult> replay_variants(const ChannelTrace& trace, const vector<ReplayConfig>& configs, unsigned int threads);
+
+#endif
@@ -0,0 +1,30 @@
+#if !defined(__CLUSTER_PARTITION_CPP__)
+#define __CLUSTER_PARTITION_CPP__
+
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+enum class ClusterPartition
+{
+    FILTERS, // each cluster computes a slice of the output channels over the whole ofmap
+    ROWS     // each cluster computes every output channel over a band of ofmap rows
+};
+
+struct ClusterWork
+{
+    int filter_start;
+    int filter_out;
+    int row_start; // in ofmap rows
+    int row_count;
+};
+
+ClusterPartition cluster_partition_from_string(const string &partition);
+
+// Splits the layer as evenly as possible, row bands stay a multiple of
+// row_alignment so fused pooling windows never straddle two clusters.
+vector<ClusterWork> partition_cluster_work(ClusterPartition partition, int cluster_count, int f_out, int ofmap_h, int row_alignment);
+
+#endif
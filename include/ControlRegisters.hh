@@ -0,0 +1,105 @@
+#if !defined(__CONTROL_REGISTERS_CPP__)
+#define __CONTROL_REGISTERS_CPP__
+
+#include "DramArbiter.hh"
+#include "ProgramImage.hh"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <systemc>
+#include <tlm>
+#include <tlm_utils/simple_target_socket.h>
+#include <vector>
+
+using std::string;
+using std::vector;
+using namespace sc_core;
+using namespace sc_dt;
+
+// byte offsets of the 32 bit registers
+#define CSR_ID 0x00              // read only, CSR_ID_VALUE
+#define CSR_STATUS 0x04          // read only, programs committed since reset
+#define CSR_PROGRAM_SELECT 0x08  // target << 24 | generator or PE index
+#define CSR_PROGRAM_COMMIT 0x0c  // any write loads the staged descriptors into the selected program
+#define CSR_DESCRIPTOR_FIFO 0x10 // descriptor records, word by word
+#define CSR_WEIGHT_LANES 0x14    // words per weight SAM line
+#define CSR_WEIGHT_ADDR 0x18     // weight SAM line the next full line goes to
+#define CSR_WEIGHT_FIFO 0x1c     // weights, lane by lane
+#define CSR_REGION_SELECT 0x20   // weight channel
+#define CSR_REGION_BASE 0x24     // region base of the selected weight channel
+#define CSR_PRELOAD_CYCLES 0x28
+#define CSR_SIZE 0x2c
+#define CSR_ID_VALUE 0x43535231 // "CSR1"
+
+/**
+ * @brief Cost of an access over the register bus. A single word access is
+ * a register access, anything longer is a burst from the host's DMA engine
+ * that pays a setup and then streams bytes_per_cycle a cycle.
+ */
+struct CsrTiming
+{
+    unsigned int register_cycles{4};
+    unsigned int burst_setup_cycles{16};
+    unsigned int bytes_per_cycle{4};
+};
+
+enum class ConfigPath
+{
+    DIRECT,    // programs and weights are copied in, configuration is free
+    REGISTERS, // every word is its own register write
+    DMA        // one burst per program and one for the weights
+};
+
+ConfigPath config_path_from_string(const string& path);
+
+/**
+ * @brief Memory mapped control block of an array, a loosely timed TLM
+ * target. Descriptors and weights are pushed through FIFO registers, a
+ * burst to a FIFO register pushes every word of it. Committed state is
+ * handed to the callbacks right away, the access cost is added to the
+ * caller's annotated delay so the host sees configuration in its own
+ * timeline.
+ */
+struct ControlRegisters : public sc_module
+{
+    tlm_utils::simple_target_socket<ControlRegisters> socket;
+
+    const sc_time cycle;
+    const CsrTiming timing;
+
+    // where committed state goes, set by the owner of the array
+    std::function<void(ProgramTarget, unsigned int, vector<Descriptor_2D>&)> load_program;
+    std::function<void(unsigned int, const vector<int>&)> load_weight_line;
+    std::function<void(unsigned int, unsigned int)> set_region_base;
+    std::function<void(unsigned int)> set_preload_cycles;
+
+    uint32_t program_select;
+    uint32_t weight_lanes;
+    uint32_t weight_addr;
+    uint32_t region_select;
+    uint32_t committed;
+    vector<uint32_t> staged_descriptor_words;
+    vector<int> staged_weight_line;
+
+    unsigned long int register_accesses;
+    unsigned long int burst_accesses;
+    unsigned long int byte_counter;
+    sc_time busy_time;
+
+    void b_transport(tlm::tlm_generic_payload& trans, sc_time& delay);
+
+    void reset();
+
+    // Constructor
+    ControlRegisters(sc_module_name name, sc_time _cycle, const CsrTiming& _timing);
+
+private:
+    tlm::tlm_response_status write(sc_dt::uint64 addr, const uint32_t* words, unsigned int count);
+};
+
+// Writes everything in the image through the block mapped at base: weight
+// geometry and region bases, each program followed by its commit, then the
+// weights from line 0. Returns the port's timeline after the last write.
+sc_time configure_from_image(DramPort& host, sc_dt::uint64 base, const ProgramImage& image, ConfigPath path);
+
+#endif
@@ -0,0 +1,86 @@
+#if !defined(__DESCRIPTOR_COMPILER_CPP__)
+#define __DESCRIPTOR_COMPILER_CPP__
+
+#include "AddressGenerator.hh"
+#include <assert.h>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+struct AccessLoop
+{
+    int count;  // trips
+    int stride; // address step per trip
+};
+
+/**
+ * @brief A loop nest over addresses. The innermost loop streams one address
+ * a cycle, gap idle cycles separate consecutive innermost runs. Outer loops
+ * with stride 0 revisit the same addresses.
+ */
+struct AccessPattern
+{
+    unsigned int base;
+    vector<AccessLoop> loops; // outermost first
+    int gap;
+
+    // every element of extent starting at offset of a row major tensor, in order
+    static AccessPattern slice(const vector<int>& shape, const vector<int>& offset, const vector<int>& extent);
+
+    // the whole pattern again, count times stride apart
+    AccessPattern repeated(int count, int stride = 0) const;
+
+    long int addresses() const;
+};
+
+// Cycles a GENERATE or WAIT descriptor occupies its generator, every
+// descriptor ends on a one cycle switch bubble. 0 for SUSPENDED, -1 when the
+// state has no fixed length.
+long int descriptor_cycles(const Descriptor_2D& desc);
+
+// cycles until the first SUSPENDED, -1 when any descriptor has no fixed length
+long int program_cycles(const vector<Descriptor_2D>& program);
+
+// One stream per innermost run and one delay per gap, the way the program
+// builders write them, sequential and closed by a suspend. With hoist,
+// stride 0 loops directly around the innermost loop become the stream's
+// rows instead of separate streams.
+vector<Descriptor_2D> lower_access_pattern(const AccessPattern& pattern, bool hoist = false);
+
+// Folds consecutive streams whose rows continue one another into a single
+// 2D descriptor, each fold saves a descriptor and its switch bubble.
+vector<Descriptor_2D> merge_streams(const vector<Descriptor_2D>& program);
+
+// Replaces back to back delays with one delay of the same length, cycle exact.
+vector<Descriptor_2D> coalesce_delays(const vector<Descriptor_2D>& program);
+
+struct PassReport
+{
+    string pass;
+    int descriptors;
+    long int cycles;
+};
+
+/**
+ * @brief A program and the size and cycles after each pass, the first
+ * report is the input.
+ */
+struct CompiledProgram
+{
+    vector<Descriptor_2D> program;
+    vector<PassReport> reports;
+
+    int descriptors_saved() const;
+    long int cycles_saved() const;
+};
+
+CompiledProgram compile_access_pattern(const AccessPattern& pattern);
+
+// Runs merge_streams and coalesce_delays over a built program. Programs
+// that are not sequential, or use modulo or hold descriptors where the
+// passes would touch them, keep those descriptors as they are.
+CompiledProgram optimize_program(const vector<Descriptor_2D>& program);
+
+#endif
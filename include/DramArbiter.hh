@@ -0,0 +1,70 @@
+#if !defined(__DRAM_ARBITER_CPP__)
+#define __DRAM_ARBITER_CPP__
+
+#include <systemc>
+#include <tlm>
+#include <tlm_utils/simple_initiator_socket.h>
+#include <tlm_utils/simple_target_socket.h>
+#include <vector>
+
+using std::vector;
+using namespace sc_core;
+using namespace sc_dt;
+
+/**
+ * @brief Bandwidth model of a single DRAM channel shared by several masters.
+ * Sits between the interconnect and the DRAM target. Every transaction
+ * occupies the channel for ceil(length / bytes_per_cycle) cycles, a
+ * transaction issued while the channel is still busy stalls until it frees
+ * up. Masters are told apart by the genattr master_id of the transaction,
+ * transactions without one are charged to master 0. The stall and the
+ * occupancy are added to the caller's annotated delay so loosely timed
+ * masters see the contention in their own timeline.
+ */
+struct DramArbiter : public sc_module
+{
+    tlm_utils::simple_target_socket<DramArbiter> target_socket;
+    tlm_utils::simple_initiator_socket<DramArbiter> init_socket;
+
+    const sc_time cycle;
+    const unsigned int bytes_per_cycle;
+    sc_time busy_until;
+    sc_time busy_time;
+
+    // per master statistics
+    vector<unsigned long int> transaction_counter;
+    vector<unsigned long int> byte_counter;
+    vector<sc_time> stall_time;
+
+    void b_transport(tlm::tlm_generic_payload& trans, sc_time& delay);
+
+    unsigned int transport_dbg(tlm::tlm_generic_payload& trans);
+
+    void reset();
+
+    sc_time total_stall_time() const;
+
+    // Constructor
+    DramArbiter(sc_module_name name, sc_time _cycle, unsigned int _bytes_per_cycle, unsigned int master_count);
+};
+
+/**
+ * @brief Loosely timed DRAM master. Transfers are issued back to back on the
+ * port's own timeline (local_time, an offset from the current simulation
+ * time) so several ports can be interleaved from outside a process without
+ * advancing the simulation.
+ */
+struct DramPort : public sc_module
+{
+    tlm_utils::simple_initiator_socket<DramPort> socket;
+    const unsigned int master_id;
+    sc_time local_time;
+
+    // returns the completion time of the transfer on the port's timeline
+    sc_time transfer(tlm::tlm_command cmd, sc_dt::uint64 addr, unsigned char* data, unsigned int length);
+
+    // Constructor
+    DramPort(sc_module_name name, unsigned int _master_id);
+};
+
+#endif
@@ -0,0 +1,43 @@
+#if !defined(__EXTRAPOLATION_CPP__)
+#define __EXTRAPOLATION_CPP__
+
+#include "Mapper.hh"
+#include <assert.h>
+#include <vector>
+
+using std::vector;
+
+/**
+ * @brief Tiles of a layer's schedule that run the same programs. Edge tiles
+ * of the filter and reduction dims are smaller than the rest and every
+ * channel tile after the first accumulates onto the psums of the one
+ * before, so a layer has at most six strata. Tiles are indices into
+ * Mapping::tile_schedule.
+ */
+struct TileStratum
+{
+    int filters;     // filters in the tile
+    int columns;     // channel_in * k * k columns in the tile
+    bool accumulate; // reads back the psums of the previous channel tile
+    vector<int> tiles;
+};
+
+vector<TileStratum> stratify_tiles(const Mapping& mapping, const LayerShape& layer);
+
+struct RowExtrapolation
+{
+    double estimate;
+    double error; // bound on |estimate - cost at the target rows|
+
+    double low() const;
+    double high() const;
+};
+
+// Extrapolates a cost measured at ascending row counts to target_rows. A
+// measurement at target_rows is exact. Otherwise the last three are used:
+// the line through the last two predicts the target and the miss of the
+// line through the first two at the last one gives the curvature that
+// bounds the error. The bound is exact for a cost quadratic in the rows.
+RowExtrapolation extrapolate_rows(const vector<int>& rows, const vector<double>& costs, int target_rows);
+
+#endif
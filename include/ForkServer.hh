@@ -0,0 +1,72 @@
+#if !defined(__FORK_SERVER_CPP__)
+#define __FORK_SERVER_CPP__
+
+#include <functional>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+using std::map;
+using std::string;
+using std::vector;
+
+// argv style arguments of one configuration line, split on whitespace with
+// single and double quotes grouping, blank lines and # comments give none
+vector<string> split_config_line(const string& line);
+
+string json_escape(const string& text);
+
+// the value bare when it is a number by JSON's grammar that fits a double,
+// a JSON string otherwise
+string json_value(const string& value);
+
+/**
+ * @brief Result of one configuration as reported by the server. Metrics are
+ * the "label value" lines the environment prints with a 20 column label,
+ * status is PASS or FAIL from the output or CRASH when the child printed
+ * neither. Build is always written as a string.
+ */
+struct ConfigResult
+{
+    int id;
+    string config;
+    string status;
+    int exit_code; // -signal when the child was killed
+    string error;
+    map<string, string> metrics;
+
+    string to_json() const;
+};
+
+ConfigResult parse_config_result(int id, const string& config, int exit_code, const string& output);
+
+/**
+ * @brief Runs configurations in forked children of an already loaded
+ * process so every point only pays for its own elaboration and simulation.
+ * Up to jobs children run at once, each one's stdout is collected through a
+ * pipe and its result written to out as a JSON line as soon as it exits, so
+ * results arrive in completion order and carry the configuration's id (its
+ * index among the non empty lines). Configurations are read from in only
+ * when a job slot is free. With a timeout, a child still running that many
+ * seconds after it was forked is killed along with any processes it forked
+ * and reported as FAIL.
+ */
+struct ForkServer
+{
+    typedef std::function<int(int, char**)> Configuration;
+
+    const int jobs;
+    const string program_name;
+    const double timeout; // wall-clock seconds per configuration, 0 for none
+    int completed{0};
+    int failed{0};
+
+    // returns the number of configurations run
+    int run(std::istream& in, std::ostream& out, const Configuration& configuration);
+
+    // Constructor
+    ForkServer(int _jobs, const string& _program_name, double _timeout = 0.0);
+};
+
+#endif
@@ -0,0 +1,62 @@
+#if !defined(__GLOBAL_BUFFER_CPP__)
+#define __GLOBAL_BUFFER_CPP__
+
+#include "AddressGenerator.hh"
+#include <assert.h>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+enum class BufferRegion
+{
+    IFMAP = 0,
+    PSUM = 1,
+    WEIGHT = 2
+};
+
+#define BUFFER_REGION_COUNT 3
+
+struct RegionAllocation
+{
+    int base;     // first word of the region in the global buffer
+    int words;
+    int channels; // taken from the global buffer's channel pool
+};
+
+/**
+ * @brief One global buffer of `capacity` words and `channel_pool` channels
+ * shared by the ifmap, psum and weight regions of a layer. allocate carves
+ * the regions back to back for each layer, so the split follows the layer
+ * instead of being fixed at design time. Generators address their region
+ * from 0, verify rejects a program that can step outside it.
+ */
+struct GlobalBuffer
+{
+    int capacity;
+    int channel_pool;
+    RegionAllocation regions[BUFFER_REGION_COUNT];
+
+    GlobalBuffer(int _capacity, int _channel_pool);
+
+    // throws std::length_error if the layer does not fit
+    void allocate(int ifmap_words, int ifmap_channels, int psum_words, int psum_channels, int weight_words, int weight_channels);
+
+    bool fits(int ifmap_words, int ifmap_channels, int psum_words, int psum_channels, int weight_words, int weight_channels) const;
+
+    const RegionAllocation& region(BufferRegion region) const;
+
+    // word_width words per address, the weight SAM reads one wide word per lane set
+    void verify(BufferRegion region, const vector<Descriptor_2D>& program, int word_width = 1) const;
+
+    int used_words() const;
+
+    int used_channels() const;
+
+    double utilization() const;
+
+    static string region_name(BufferRegion region);
+};
+
+#endif
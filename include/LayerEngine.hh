@@ -0,0 +1,17 @@
+#if !defined(__LAYER_ENGINE_CPP__)
+#define __LAYER_ENGINE_CPP__
+
+#include "Mapper.hh"
+
+/**
+ * @brief Runs a conv layer without elaborating the arch, so it can be called
+ * any number of times in one process. The ofmap is computed exactly as the
+ * array produces it, 32 bit accumulation wrapping like sc_int<32>, and the
+ * counters come from the analytic mapping model. Tensors are row major,
+ * ifmap c_in x ifmap_h x ifmap_w, weights f_out x c_in x k x k and ofmap
+ * f_out x ofmap_h x ofmap_w, written into caller owned memory so bindings
+ * can hand over their own buffers.
+ */
+MappingCost run_layer_engine(const int* ifmap, const int* weights, int* ofmap, const LayerShape& layer, const Mapping& mapping, const ArrayShape& array);
+
+#endif
@@ -0,0 +1,114 @@
+#if !defined(__MAPPER_CPP__)
+#define __MAPPER_CPP__
+
+#include <assert.h>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using std::cout;
+using std::endl;
+using std::pair;
+using std::string;
+using std::vector;
+
+enum UnrollOrientation
+{
+    HORIZONTAL = 1, // filters on array rows, channel_in * k * k on array columns
+    VERTICLE = 2    // channel_in * k * k on array rows, filters on array columns
+};
+
+enum class LoopOrder
+{
+    FILTER_TILES_OUTER, // every channel tile of a filter tile before the next filter tile
+    CHANNEL_TILES_OUTER // every filter tile of a channel tile before the next channel tile
+};
+
+struct LayerShape
+{
+    int c_in;
+    int f_out;
+    int k;
+    int ofmap_h;
+    int ofmap_w;
+
+    int ifmap_size() const;
+    int ofmap_size() const;
+};
+
+struct ArrayShape
+{
+    int rows;
+    int cols;
+    int ifmap_mem_size;
+    int psum_mem_size;
+};
+
+/**
+ * @brief One way of running a conv layer on the systolic array. The
+ * orientation picks which physical array dimension carries the filters, the
+ * array is then treated as a logical filter_rows x channel_cols array whose
+ * psum chain runs along the logical rows. A tile covers filter_tile filters
+ * and channel_tile of the channel_in * k * k reduction, smaller tiles than
+ * the logical array leave the remaining PEs bypassed. The loop order picks
+ * how the tiles are traversed in time.
+ */
+struct Mapping
+{
+    UnrollOrientation orientation;
+    LoopOrder loop_order;
+    int filter_tile;
+    int channel_tile;
+
+    Mapping(UnrollOrientation _orientation, LoopOrder _loop_order, int _filter_tile, int _channel_tile);
+
+    // logical array dims
+    int filter_rows(const ArrayShape& array) const;
+    int channel_cols(const ArrayShape& array) const;
+
+    int filter_tiles(const LayerShape& layer) const;
+    int channel_tiles(const LayerShape& layer) const;
+
+    // (filter tile, channel tile) pairs in the order the array runs them
+    vector<pair<int, int>> tile_schedule(int filter_tile_count, int channel_tile_count) const;
+
+    bool legal(const LayerShape& layer, const ArrayShape& array) const;
+
+    string to_string() const;
+
+    static Mapping full_array(const ArrayShape& array);
+
+    static UnrollOrientation orientation_from_string(const string& orientation);
+
+    static LoopOrder loop_order_from_string(const string& loop_order);
+};
+
+struct MappingCost
+{
+    bool fits;
+    long int cycles;
+    long int macs;
+    long int ifmap_reads;
+    long int psum_reads;
+    long int psum_writes;
+    long int weight_loads;
+    long int dram_words;
+    double pe_utilization;
+    double energy; // normalised to one MAC
+    double score;  // energy delay product, lower is better
+};
+
+// relative access energies, DRAM >> SAM > PE local
+#define DRAM_ACCESS_ENERGY 200.0
+#define SAM_ACCESS_ENERGY 6.0
+#define PE_ACCESS_ENERGY 1.0
+
+MappingCost estimate_mapping_cost(const Mapping& mapping, const LayerShape& layer, const ArrayShape& array);
+
+vector<Mapping> enumerate_mappings(const LayerShape& layer, const ArrayShape& array);
+
+// legal mappings ranked best first, ties keep enumeration order
+vector<pair<Mapping, MappingCost>> search_mappings(const LayerShape& layer, const ArrayShape& array);
+
+#endif
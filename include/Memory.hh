@@ -7,10 +7,15 @@
 #include <systemc>
 #include "Memory_Channel.hh"
 #include "GlobalControl.hh"
+#include "PostProcessor.hh"
+#include "ZeroCompression.hh"
+#include "ChannelTrace.hh"
+#include <vector>
 
 using std::cout;
 using std::endl;
 using std::string;
+using std::vector;
 using namespace sc_core;
 using namespace sc_dt;
 
@@ -35,6 +40,10 @@ public:
     sc_vector<sc_port<MemoryChannel_IF<DataType>>> channels;
     const unsigned int width, length, channel_count;
     int access_counter;
+    vector<PostProcessor<DataType>*> post_processors; // optional, per channel
+    ZeroDecompressor<DataType>* decompressor;         // optional, on every read channel
+    vector<unsigned int>* address_trace;              // optional, line address of every access
+    ChannelTrace* channel_trace;                      // optional, every access with its cycle, channel and mode
 
     void update();
 
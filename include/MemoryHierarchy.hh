@@ -0,0 +1,110 @@
+#if !defined(__MEMORY_HIERARCHY_CPP__)
+#define __MEMORY_HIERARCHY_CPP__
+
+#include <systemc>
+#include "SAM.hh"
+#include "GlobalControl.hh"
+#include <assert.h>
+#include <deque>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using std::cout;
+using std::endl;
+using std::pair;
+using std::string;
+using std::vector;
+using namespace sc_core;
+using namespace sc_dt;
+
+struct MemoryLevelConfig
+{
+    int length;  // lines
+    int width;   // words per line
+    int latency; // cycles a line spends on the link to the next level
+};
+
+// comma separated length:width:latency levels, outermost first
+vector<MemoryLevelConfig> memory_levels_from_string(const string& levels);
+
+template <typename DataType>
+struct MemoryLevelCreator
+{
+    MemoryLevelCreator(GlobalControlChannel& _control, const vector<MemoryLevelConfig>& _configs, sc_trace_file* _tf);
+    SAM<DataType>* operator()(const char* name, size_t level);
+    GlobalControlChannel& control;
+    vector<MemoryLevelConfig> configs;
+    sc_trace_file* tf;
+};
+
+// one signal vector per level and channel, as wide as the level
+template <typename DataType>
+struct LevelSignalCreator
+{
+    LevelSignalCreator(const vector<MemoryLevelConfig>& _configs);
+    sc_vector<sc_signal<DataType>>* operator()(const char* name, size_t idx);
+    vector<MemoryLevelConfig> configs;
+};
+
+#define LEVEL_FILL_CHANNEL 0  // written from the level above
+#define LEVEL_DRAIN_CHANNEL 1 // read into the level below
+
+/**
+ * @brief Chain of SAM levels, outermost first, each with its own length,
+ * width and link latency. Level i's drain channel feeds level i + 1's fill
+ * channel through a link that delays lines by the level's latency and
+ * splits a line into width(i) / width(i + 1) lines of the level below, so
+ * widths must not grow towards the array. Both ends of a transfer are
+ * driven by the levels' address generators, the link only stages lines
+ * until the fill channel takes them. Runs on its own control so transfers
+ * can be simulated before the array is programmed.
+ */
+template <typename DataType>
+struct MemoryHierarchy : public sc_module
+{
+private:
+    sc_in_clk _clk;
+
+public:
+    sc_port<GlobalControlChannel_IF> control;
+    vector<MemoryLevelConfig> configs;
+    sc_vector<SAM<DataType>> levels;
+    sc_vector<sc_vector<sc_signal<DataType>>> read_data;  // level * 2 + channel
+    sc_vector<sc_vector<sc_signal<DataType>>> write_data; // level * 2 + channel
+
+    // per link
+    vector<std::deque<pair<unsigned long int, vector<DataType>>>> link_lines; // ready cycle, lower level line
+    vector<bool> link_pending;   // the upper level read a line last cycle
+    vector<bool> link_presented; // a line waits on the lower level's fill channel
+
+    // per level
+    vector<unsigned long int> read_lines;
+    vector<unsigned long int> write_lines;
+    unsigned long int cycle_counter;
+    bool transfer_active;
+
+    void update();
+
+    // host side access to the outermost level, counts one access per word
+    void load(const vector<int>& words);
+
+    // host side read of the innermost level, counts one access
+    DataType word(int level, int addr);
+
+    // moves upper_lines lines of level `link` into level link + 1, returns once done
+    void run_transfer(int link, int src_line, int dst_line, int upper_lines);
+
+    bool transfer_done();
+
+    // lines moved over the level's ports per cycle of transfers, 1 per port at peak
+    double read_utilization(int level) const;
+    double write_utilization(int level) const;
+
+    MemoryHierarchy(sc_module_name name, GlobalControlChannel& _control, const vector<MemoryLevelConfig>& _configs, sc_trace_file* tf);
+
+    SC_HAS_PROCESS(MemoryHierarchy);
+};
+
+#endif
@@ -0,0 +1,81 @@
+#if !defined(__POST_PROCESSOR_CPP__)
+#define __POST_PROCESSOR_CPP__
+
+#include <systemc>
+#include <vector>
+#include <assert.h>
+#include <iostream>
+#include <string>
+
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+using namespace sc_core;
+using namespace sc_dt;
+
+enum class PoolMode
+{
+    NONE, // write every element of the final pass
+    MAX,  // 2x2 stride 2 max pooling
+    AVG   // 2x2 stride 2 average pooling
+};
+
+struct PostProcessConfig
+{
+    bool bias;
+    bool relu;
+    bool clamp;
+    int clamp_min;
+    int clamp_max;
+    PoolMode pool;
+
+    PostProcessConfig();
+
+    bool enabled() const;
+
+    static PoolMode pool_mode_from_string(const string& mode);
+};
+
+/**
+ * @brief Post processing unit sitting on a single psum write channel. Every
+ * write committed by the channel passes through process() which counts the
+ * writes to recover which accumulation pass (horizontal tile) and which
+ * element of the ofmap is being written. Partial passes are committed
+ * untouched, the final pass is biased, rectified/clamped and optionally
+ * pooled through a line buffer of ofmap_w/2 entries before being committed.
+ * Pooled outputs of a filter are packed at the start of that filter's psum
+ * region, windows that are still incomplete suppress their write entirely.
+ * Consecutive elements of a filter sit element_stride words apart.
+ */
+template <typename DataType>
+struct PostProcessor
+{
+    PostProcessConfig config;
+    unsigned int ofmap_h;
+    unsigned int ofmap_w;
+    unsigned int pass_count;
+    bool passes_outer; // accumulation passes sweep every active tile before the next pass
+    unsigned int element_stride;
+    vector<int> tile_biases; // bias of the filter handled in each active verticle tile
+
+    unsigned int write_counter;
+    vector<long int> line_buffer;
+    int processed_counter;
+    int suppressed_write_counter;
+
+    void configure(const PostProcessConfig& _config, const vector<int>& _tile_biases,
+                   unsigned int _pass_count, unsigned int _ofmap_h, unsigned int _ofmap_w,
+                   bool _passes_outer = false, unsigned int _element_stride = 1);
+
+    void reset();
+
+    long int activate(long int value, unsigned int tile);
+
+    // returns true if the (possibly remapped) write should be committed
+    bool process(unsigned int& addr, DataType& data);
+
+    PostProcessor();
+};
+
+#endif
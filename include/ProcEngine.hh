@@ -24,8 +24,10 @@ struct PE : public sc_module
 
 public:
     sc_trace_file *tf;
-    vector<int> weights;
+    vector<int> weights; // weight registers, weight n lives in slot n % weight_reg_capacity
     int weight_idx;
+    int weight_fill;         // weights written into the registers so far
+    int weight_reg_capacity; // 0 holds every weight of the layer
     sc_signal<DataType> psum_in;
     sc_signal<int> current_weight;
     int prog_idx;
@@ -44,8 +46,15 @@ public:
 
     void resetWeights();
 
-    void loadWeights(vector<int> &weights);
+    // copies count weights in as one block, throws like pushWeight on overrun
+    void loadWeights(const int *weights, int count);
 
+    // throws std::runtime_error when the registers would overrun
+    void pushWeight(int weight);
+
+    bool weightsResident(int weight_count);
+
+    // throws std::runtime_error on a register underrun or a bad program
     void updateState();
 
     void loadProgram(vector<Descriptor_2D> &_program);
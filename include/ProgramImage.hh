@@ -0,0 +1,126 @@
+#if !defined(__PROGRAM_IMAGE_CPP__)
+#define __PROGRAM_IMAGE_CPP__
+
+#include "AddressGenerator.hh"
+#include "Mapper.hh"
+#include <assert.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+#define PROGRAM_IMAGE_MAGIC "CPIM"
+#define PROGRAM_IMAGE_VERSION 1
+
+enum class ProgramTarget : uint32_t
+{
+    IFMAP_GENERATOR,
+    PSUM_GENERATOR,
+    WEIGHT_GENERATOR,
+    PE
+};
+
+struct ImageProgram
+{
+    ProgramTarget target;
+    unsigned int index; // generator or PE index within its target
+    vector<Descriptor_2D> program;
+};
+
+/**
+ * @brief Everything the program builders produce for one layer on one
+ * array: the generator and PE programs, the packed weight SAM image and its
+ * region bases. The binary image is little endian 32 bit words throughout
+ * so a mapped file can be read in place:
+ *
+ *   header       16 words, magic, version, array, layer, section counts, 0
+ *   programs     4 words each, target, index, first descriptor, length
+ *   region base  one word per weight channel
+ *   descriptors  12 words each, the Descriptor_2D fields in declaration order
+ *   weights      weight_words x weight_lanes words, row major
+ */
+struct ProgramImage
+{
+    unsigned int filter_count;
+    unsigned int channel_count;
+    unsigned int weight_channel_count;
+    unsigned int weight_lanes;
+    LayerShape layer;
+    unsigned int weight_preload_cycles;
+    vector<ImageProgram> programs;
+    vector<int> weight_region_base;
+    unsigned int weight_words;
+    vector<int> weights;
+
+    vector<uint8_t> encode() const;
+
+    void save(const string& path) const;
+};
+
+#define PROGRAM_IMAGE_HEADER_WORDS 16
+#define PROGRAM_IMAGE_ENTRY_WORDS 4
+#define PROGRAM_IMAGE_DESCRIPTOR_WORDS 12
+
+// The 12 word record a descriptor is stored as, in images and wherever
+// descriptors are written over a bus.
+void encode_descriptor(const Descriptor_2D& desc, uint32_t* words);
+Descriptor_2D decode_descriptor(const uint32_t* words);
+
+/**
+ * @brief Reads an encoded image in place. The header and section bounds are
+ * checked on construction, programs are decoded on request and weights read
+ * straight out of the buffer, which must outlive the view.
+ */
+struct ProgramImageView
+{
+    const uint8_t* data;
+    size_t size;
+
+    unsigned int filter_count;
+    unsigned int channel_count;
+    unsigned int weight_channel_count;
+    unsigned int weight_lanes;
+    LayerShape layer;
+    unsigned int weight_preload_cycles;
+    unsigned int program_count;
+    unsigned int descriptor_count;
+    unsigned int weight_words;
+
+    ProgramTarget target(unsigned int program) const;
+    unsigned int index(unsigned int program) const;
+    vector<Descriptor_2D> program(unsigned int program) const;
+
+    int region_base(unsigned int channel) const;
+    int weight(unsigned int addr, unsigned int lane) const;
+
+    ProgramImageView(const uint8_t* _data, size_t _size);
+
+private:
+    size_t entries_offset() const;
+    size_t region_base_offset() const;
+    size_t descriptors_offset() const;
+    size_t weights_offset() const;
+};
+
+/**
+ * @brief A program image file mapped read only for as long as it lives,
+ * nothing is copied until a program or weight is read out of view().
+ */
+struct MappedProgramImage
+{
+    const uint8_t* data;
+    size_t size;
+
+    ProgramImageView view() const;
+
+    MappedProgramImage(const string& path);
+    ~MappedProgramImage();
+
+    MappedProgramImage(const MappedProgramImage&) = delete;
+    MappedProgramImage& operator=(const MappedProgramImage&) = delete;
+};
+
+#endif
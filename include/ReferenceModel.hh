@@ -0,0 +1,20 @@
+#if !defined(__REFERENCE_MODEL_CPP__)
+#define __REFERENCE_MODEL_CPP__
+
+#include "PostProcessor.hh"
+#include <xtensor/xarray.hpp>
+
+xt::xarray<int> generate_ifmap(int channel_in, int ifmap_h, int ifmap_w);
+
+xt::xarray<int> generate_weights(int filter_out_dim, int channel_in_dim, int kernel);
+
+xt::xarray<int> generate_expected_output(xt::xarray<int> ifmap, xt::xarray<int> weights);
+
+// bias centred on each filter's mean output so relu/clamp see both signs
+xt::xarray<int> generate_biases(xt::xarray<int> ofmap);
+
+xt::xarray<int> generate_expected_post_processed_output(xt::xarray<int> ofmap, xt::xarray<int> biases, const PostProcessConfig &config);
+
+bool validate_expected_output(xt::xarray<int> expected, xt::xarray<int> result);
+
+#endif
@@ -0,0 +1,55 @@
+#if !defined(__REUSE_ANALYSIS_CPP__)
+#define __REUSE_ANALYSIS_CPP__
+
+#include "AddressGenerator.hh"
+#include <assert.h>
+#include <map>
+#include <vector>
+
+using std::map;
+using std::vector;
+
+// Walks a generator program the way AddressGenerator does: a GENERATE
+// descriptor emits (x_count + 1) * (y_count + 1) addresses, WAIT emits
+// none and SUSPENDED ends the stream. Programs that loop are cut off after
+// max_addresses.
+vector<unsigned int> expand_program(const vector<Descriptor_2D>& program, unsigned long int max_addresses = 1UL << 24);
+
+// One address per stream in turn, as channels streaming side by side would
+// hit the SAM. Streams that run out drop out of the rotation.
+vector<unsigned int> interleave_streams(const vector<vector<unsigned int>>& streams);
+
+/**
+ * @brief Reuse profile of one address stream. The reuse distance of an
+ * access is the number of distinct other addresses touched since the
+ * previous access to the same address, so a fully associative LRU buffer
+ * of C lines hits exactly the accesses with distance < C. First touches
+ * have no distance and always miss. The working set is the number of
+ * distinct addresses in each consecutive window of `window` accesses.
+ */
+struct ReuseProfile
+{
+    unsigned long int accesses;
+    unsigned long int footprint;                      // distinct addresses
+    map<unsigned long int, unsigned long int> reuse;  // distance, access count
+    unsigned long int window;
+    vector<unsigned long int> working_set;            // per window
+
+    ReuseProfile(const vector<unsigned int>& stream, unsigned long int _window);
+
+    // hit rate of an LRU buffer holding `capacity` lines
+    double hit_rate(unsigned long int capacity) const;
+
+    // what a buffer holding the footprint achieves, only first touches miss
+    double max_hit_rate() const;
+
+    // smallest LRU capacity reaching hit_rate, -1 if first touches alone miss too often
+    long int min_buffer_size(double hit_rate) const;
+
+    unsigned long int peak_working_set() const;
+
+    // access counts for distances 0, 1, 2-3, 4-7, ...
+    vector<unsigned long int> log2_histogram() const;
+};
+
+#endif
@@ -0,0 +1,71 @@
+#if !defined(__RUN_OPTIONS_CPP__)
+#define __RUN_OPTIONS_CPP__
+
+#include "ClusterPartition.hh"
+#include "ControlRegisters.hh"
+#include "GlobalBuffer.hh"
+#include "Mapper.hh"
+#include "MemoryHierarchy.hh"
+#include "PostProcessor.hh"
+#include "TensorLayout.hh"
+#include "Watchdog.hh"
+#include "WeightPacker.hh"
+#include "ZeroCompression.hh"
+#include <memory>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+/**
+ * @brief Options of one configuration. run_configuration fills them from the
+ * command line, every simulation mode reads the ones that apply to it.
+ */
+struct RunOptions
+{
+    // layer and array
+    int ifmap_h{10};
+    int ifmap_w{10};
+    int k{1};
+    int c_in{16};
+    int f_out{16};
+    int filter_count{7};
+    int channel_count{9};
+    PostProcessConfig post_process_config;
+
+    // fused and pipelined chains, the first layer's f_out included
+    vector<int> layer_f_out;
+    int ifmap_mem_size{0};
+    int psum_mem_size{0};
+    int strip_rows{0};
+    int pipeline_images{0};
+
+    // clusters sharing DRAM
+    int cluster_count{1};
+    ClusterPartition partition{ClusterPartition::FILTERS};
+    int dram_words_per_cycle{1};
+    int dram_latency{10};
+
+    // single layer runs
+    Mapping mapping{UnrollOrientation::HORIZONTAL, LoopOrder::FILTER_TILES_OUTER, 0, 0};
+    WeightBufferConfig weight_config;
+    TensorLayout ifmap_layout;
+    TensorLayout ofmap_layout;
+    int ifmap_line_rows{0};
+    std::shared_ptr<GlobalBuffer> global_buffer; // null keeps separate SAMs
+    CompressionFormat compression{CompressionFormat::NONE};
+    vector<MemoryLevelConfig> memory_levels;
+    double reuse_hit_rate{0.0};
+    int reuse_window{1024};
+    string trace_prefix;
+    string save_program;
+    string load_program;
+    ConfigPath config_path{ConfigPath::DIRECT};
+    int extrapolation_rows{0};
+    bool fast_forward{false};
+
+    WatchdogConfig watchdog_config;
+};
+
+#endif
@@ -0,0 +1,59 @@
+#if !defined(__SIM_CLUSTERS_CPP__)
+#define __SIM_CLUSTERS_CPP__
+
+#include "Arch.hh"
+#include "RunOptions.hh"
+
+#define MAX_CLUSTERS 8
+
+// Stops (pauses) the simulation once every cluster behind the shared global
+// control has run its program to completion.
+template <typename DataType>
+struct ClusterMonitor : public sc_module
+{
+private:
+    sc_in_clk _clk;
+
+public:
+    sc_port<GlobalControlChannel_IF> control;
+    vector<Arch<DataType> *> clusters;
+
+    void monitor()
+    {
+        while (1)
+        {
+            bool clusters_suspended = control->enable();
+            for (auto cluster : clusters)
+            {
+                clusters_suspended &= cluster->suspended;
+            }
+            if (clusters_suspended)
+            {
+                sc_pause();
+            }
+            wait();
+        }
+    }
+
+    ClusterMonitor(sc_module_name name, GlobalControlChannel &_control, vector<Arch<DataType> *> _clusters) : sc_module(name), clusters(_clusters)
+    {
+        control(_control);
+        _clk(_control.clk());
+        for (auto cluster : clusters)
+        {
+            cluster->stop_on_suspend = false;
+        }
+        SC_THREAD(monitor);
+        sensitive << _clk.pos();
+    }
+
+    SC_HAS_PROCESS(ClusterMonitor);
+};
+
+// Splits one layer across cluster_count arches that share DRAM through an
+// arbiter, each cluster fetches its own ifmap and weights and writes back
+// its part of the ofmap.
+template <typename DataType>
+void sim_clusters_and_get_results(const RunOptions &options);
+
+#endif
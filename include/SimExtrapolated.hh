@@ -0,0 +1,15 @@
+#if !defined(__SIM_EXTRAPOLATED_CPP__)
+#define __SIM_EXTRAPOLATED_CPP__
+
+#include "RunOptions.hh"
+
+// Simulates every tile shape of the layer in detail over a few ofmap row
+// counts and extrapolates each one to the layer's full rows. No tile is
+// left out: tiles of a stratum run the same programs, so a stratum's total
+// is its size times its shape's cost, and accumulating channel tiles add
+// their psum read back exactly. What is not exact, the extrapolation in the
+// rows, is bounded by the curvature seen over the simulated row counts.
+template <typename DataType>
+void sim_extrapolated_and_get_results(const RunOptions &options);
+
+#endif
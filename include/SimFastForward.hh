@@ -0,0 +1,21 @@
+#if !defined(__SIM_FAST_FORWARD_CPP__)
+#define __SIM_FAST_FORWARD_CPP__
+
+#include "RunOptions.hh"
+
+// Runs the layer cut down to the first steady_tiles filter tiles (plus the
+// edge tile), checks from its programs that every filter tile repeats the
+// same control states and from the time and counters at the start of each
+// filter tile, where the psum writes enter the tile's first descriptor,
+// that the run has settled, then skips the remaining filter tiles by adding
+// the measured per period deltas. Only the cut down run's output is checked
+// against the golden model, the skipped tiles produce no output, so the
+// mode reports latency and access counts of the full layer, not its ofmap.
+// Only the weights grow with the skipped tiles outside the period:
+// the preload, which covers every tile the registers hold up front, is
+// added from the weight program and the weight SAM reads, one tile's worth
+// per tile preloaded or refilled, scale with the tile count.
+template <typename DataType>
+void sim_fast_forward_and_get_results(const RunOptions &options);
+
+#endif
@@ -0,0 +1,21 @@
+#if !defined(__SIM_FUSED_CPP__)
+#define __SIM_FUSED_CPP__
+
+#include "RunOptions.hh"
+
+// Every fused layer is a 1x1 conv so only fused pooling changes the spatial
+// dims a strip sees from one layer to the next. Returns the tallest strip of
+// first layer ifmap rows whose per layer ifmap and psum footprints fit the
+// SAM capacities, or of the one global buffer the layer's ifmap, psum and
+// weight regions share when it is given, or 0 if no strip fits. With
+// pooling every strip but the last must cover a whole number of 2x2 windows
+// at each layer.
+int schedule_fused_strip_rows(const vector<int> &layer_channels, int ifmap_h, int ifmap_w, const PostProcessConfig &config, int ifmap_mem_size, int psum_mem_size, const GlobalBuffer *global_buffer = nullptr, const vector<int> &layer_weight_words = {}, const vector<int> &layer_region_channels = {});
+
+// Runs the chain of 1x1 layers strip by strip on one arch, a layer's output
+// stays on chip as the next layer's ifmap and only the last layer's goes
+// back to DRAM.
+template <typename DataType>
+void sim_fused_and_get_results(const RunOptions &options);
+
+#endif
@@ -0,0 +1,11 @@
+#if !defined(__SIM_LAYER_CPP__)
+#define __SIM_LAYER_CPP__
+
+#include "RunOptions.hh"
+
+// Runs a single layer in detail on one arch and checks its ofmap against the
+// golden model, the default mode.
+template <typename DataType>
+void sim_and_get_results(const RunOptions &options);
+
+#endif
@@ -0,0 +1,13 @@
+#if !defined(__SIM_PIPELINE_CPP__)
+#define __SIM_PIPELINE_CPP__
+
+#include "RunOptions.hh"
+
+// One cluster per 1x1 conv layer, images flow through the clusters in lock
+// step: in step t the cluster of layer l works on image t - l. Weights stay
+// resident in each cluster, activations move between clusters through
+// double buffered stage buffers.
+template <typename DataType>
+void sim_pipeline_and_get_results(const RunOptions &options);
+
+#endif
@@ -0,0 +1,49 @@
+#if !defined(__STEADY_STATE_CPP__)
+#define __STEADY_STATE_CPP__
+
+#include "AddressGenerator.hh"
+#include <assert.h>
+#include <vector>
+
+using std::vector;
+
+// Descriptors that drive a generator through the same control states for
+// the same number of cycles, whatever addresses they visit.
+bool same_control_state(const Descriptor_2D& a, const Descriptor_2D& b);
+
+/**
+ * @brief A program as prefix, `repeats` copies of a `length` descriptor
+ * body that agree modulo addresses, then whatever is left (at least the
+ * closing suspend).
+ */
+struct DescriptorPeriod
+{
+    int prefix;
+    int length;
+    int repeats;
+};
+
+// The body covering the most descriptors, shortest body and prefix first.
+// A program without a repeating body comes back as one repeat of itself.
+DescriptorPeriod detect_descriptor_period(const vector<Descriptor_2D>& program, int max_prefix = 4);
+
+/**
+ * @brief Counter snapshots taken one candidate period apart. The run is
+ * in steady state once the last two periods moved every counter by the
+ * same amount, further periods can then be skipped by adding that delta.
+ */
+struct PeriodDetector
+{
+    vector<vector<long int>> snapshots;
+
+    void record(const vector<long int>& counters);
+
+    bool steady() const;
+
+    vector<long int> period_delta() const;
+
+    // counters after `periods` more periods on top of `counters`
+    vector<long int> skip(const vector<long int>& counters, long int periods) const;
+};
+
+#endif
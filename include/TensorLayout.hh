@@ -0,0 +1,46 @@
+#if !defined(__TENSOR_LAYOUT_CPP__)
+#define __TENSOR_LAYOUT_CPP__
+
+#include <assert.h>
+#include <string>
+
+using std::string;
+
+enum class LayoutKind
+{
+    NCHW,  // channel planes back to back
+    NHWC,  // all channels of a pixel back to back
+    NCHWc  // blocks of `block` channels stored NHWC, blocks stored NCHW
+};
+
+/**
+ * @brief Placement of a channels x plane activation tensor in a width 1 SAM
+ * or DRAM. In every layout the elements of one channel sit at a fixed
+ * stride from its base, so a generator streams a channel plane with a
+ * single strided stream instruction.
+ */
+struct TensorLayout
+{
+    LayoutKind kind;
+    int block; // channels per block, NCHWc only
+
+    TensorLayout(LayoutKind _kind = LayoutKind::NCHW, int _block = 1);
+
+    // address of element 0 of channel c
+    int base(int c, int plane) const;
+
+    // address distance between consecutive elements of one channel
+    int stride(int channels) const;
+
+    int index(int c, int element, int channels, int plane) const;
+
+    // words occupied, NCHWc pads the channels to a whole block
+    int size(int channels, int plane) const;
+
+    string to_string() const;
+
+    // nchw, nhwc or nchw<block>c e.g. nchw4c
+    static TensorLayout from_string(const string& layout);
+};
+
+#endif
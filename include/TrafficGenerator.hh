@@ -0,0 +1,142 @@
+#if !defined(__TRAFFIC_GENERATOR_CPP__)
+#define __TRAFFIC_GENERATOR_CPP__
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <string>
+#include <systemc>
+#include <tlm>
+#include <tlm_utils/simple_initiator_socket.h>
+#include <vector>
+
+using std::map;
+using std::string;
+using std::vector;
+using namespace sc_core;
+using namespace sc_dt;
+
+enum class TrafficPattern
+{
+    SEQUENTIAL, // slot after slot, wrapping at the end of the range
+    STRIDED,    // stride bytes apart, wrapping at the end of the range
+    RANDOM      // uniformly random slot
+};
+
+TrafficPattern traffic_pattern_from_string(const string& pattern);
+
+/**
+ * @brief What a TrafficGenerator issues. Transactions are size bytes at
+ * size aligned offsets into [base, base + range). Issues are at least
+ * interval apart, a zero interval issues as fast as the outstanding limit
+ * lets it.
+ */
+struct TrafficConfig
+{
+    TrafficPattern pattern{TrafficPattern::SEQUENTIAL};
+    sc_dt::uint64 base{0};
+    sc_dt::uint64 range{4096};
+    unsigned int size{64};
+    unsigned int stride{0}; // STRIDED only, a multiple of size
+    double read_fraction{0.0};
+    sc_time interval{SC_ZERO_TIME};
+    unsigned int max_outstanding{1};
+    unsigned long int transactions{1000};
+    unsigned int seed{1};
+
+    // throws std::invalid_argument on an unusable config
+    void validate() const;
+};
+
+struct TrafficRequest
+{
+    tlm::tlm_command cmd;
+    sc_dt::uint64 addr;
+};
+
+// the requests of a config in issue order, deterministic for a seed
+struct TrafficSequence
+{
+    const TrafficConfig config;
+    std::mt19937 rng;
+    unsigned long int issued;
+
+    TrafficRequest next();
+
+    TrafficSequence(const TrafficConfig& _config);
+};
+
+/**
+ * @brief Latency and throughput of a run in cycles. Latency runs from the
+ * scheduled issue to the end of the annotated delay, so time spent waiting
+ * for an outstanding slot is not counted, queueing in the target is.
+ * Throughput is kept as bytes completed per window of window_cycles.
+ */
+struct TrafficStats
+{
+    unsigned long int reads{0};
+    unsigned long int writes{0};
+    unsigned long int errors{0};
+    unsigned long int bytes{0};
+    unsigned long int first_issue{0};
+    unsigned long int last_done{0};
+    map<unsigned long int, unsigned long int> latency; // cycles, transaction count
+    unsigned long int window_cycles;
+    vector<unsigned long int> window_bytes;
+    double wall_seconds{0.0};
+
+    void record(unsigned long int issue_cycle, unsigned long int done_cycle, unsigned int length, bool read, bool ok);
+
+    unsigned long int transactions() const;
+    double mean_latency() const;
+
+    // smallest latency at least fraction of the transactions finished within
+    unsigned long int latency_percentile(double fraction) const;
+
+    // transaction counts for latencies 0, 1, 2-3, 4-7, ...
+    vector<unsigned long int> log2_histogram() const;
+
+    double bytes_per_cycle() const;
+    double transactions_per_wall_second() const;
+
+    TrafficStats(unsigned long int _window_cycles = 1000);
+};
+
+/**
+ * @brief Loosely timed master that loads a TLM path with a configurable
+ * mix of reads and writes. Keeps up to max_outstanding blocking transports
+ * in flight, one process each, and waits out every annotated delay so the
+ * latency seen is the target's. Starts once `after` fires, if set, and
+ * notifies done when the last transaction completes.
+ */
+template <unsigned int BUSWIDTH = 32>
+struct TrafficGenerator : public sc_module
+{
+    tlm_utils::simple_initiator_socket<TrafficGenerator, BUSWIDTH> socket;
+
+    const TrafficConfig config;
+    const sc_time cycle;
+    TrafficStats stats;
+    sc_event* after;
+    sc_event done;
+
+    // Constructor
+    TrafficGenerator(sc_module_name name, const TrafficConfig& _config, sc_time _cycle, unsigned long int window_cycles = 1000);
+
+private:
+    TrafficSequence sequence;
+    sc_event start;
+    sc_time next_issue;
+    unsigned long int issued;
+    unsigned long int completed;
+    std::chrono::high_resolution_clock::time_point wall_start;
+
+    void starter();
+    void worker();
+
+public:
+    SC_HAS_PROCESS(TrafficGenerator);
+};
+
+#endif
@@ -0,0 +1,61 @@
+#if !defined(__WATCHDOG_CPP__)
+#define __WATCHDOG_CPP__
+
+#include <cstdint>
+#include <string>
+
+using std::string;
+
+enum class WatchdogVerdict
+{
+    RUNNING,
+    OVER_BUDGET, // more cycles than the budget allows
+    STALLED      // no state changed for the stall limit
+};
+
+// FNV-1a over the values that make up a cycle's control state
+struct StateHasher
+{
+    uint64_t hash{14695981039346656037ULL};
+
+    void add(uint64_t value);
+};
+
+/**
+ * @brief Bounds a run that is supposed to end on its own. Fed one state
+ * signature per enabled cycle, it trips once the cycles exceed the budget
+ * or the signature has not changed for stall_limit cycles. Zero disables
+ * either bound. A program looping through states forever is caught by the
+ * budget, one stuck in a single state by the stall limit, usually long
+ * before the budget runs out.
+ */
+struct ProgressWatchdog
+{
+    unsigned long int cycle_budget{0};
+    unsigned long int stall_limit{0};
+    unsigned long int cycles{0};
+    unsigned long int last_change{0}; // cycle the signature last changed
+    uint64_t signature{0};
+    WatchdogVerdict verdict{WatchdogVerdict::RUNNING};
+
+    WatchdogVerdict observe(uint64_t state_signature);
+
+    bool tripped() const;
+
+    string reason() const;
+
+    void reset();
+};
+
+struct WatchdogConfig
+{
+    unsigned long int max_cycles{0}; // 0 derives the budget from the estimate
+    double cycle_margin{2.0};        // budget relative to the estimate, 0 for none
+    unsigned long int stall_cycles{1000};
+};
+
+// Analytic cycles with a relative margin plus a fixed slack for the short
+// phases the estimate leaves out.
+unsigned long int cycle_budget_from_estimate(long int estimated_cycles, double margin, unsigned long int slack = 1000);
+
+#endif
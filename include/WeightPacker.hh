@@ -0,0 +1,83 @@
+#if !defined(__WEIGHT_PACKER_CPP__)
+#define __WEIGHT_PACKER_CPP__
+
+#include "Mapper.hh"
+#include <assert.h>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+namespace weight_packer
+{
+constexpr int PAD = -1; // weight of a bypassed PE
+}
+
+enum class WeightDelivery
+{
+    ROW,   // a weight SAM word holds one array row, lane j goes to column j
+    COLUMN // a weight SAM word holds one array column, lane i goes to row i
+};
+
+WeightDelivery weight_delivery_from_string(const string& delivery);
+
+struct WeightBufferConfig
+{
+    WeightDelivery delivery{WeightDelivery::ROW};
+    int channel_count{0}; // weight SAM channels, 0 gives every row/column its own
+    int reg_capacity{0};  // weights per PE, 0 holds every weight of the layer
+};
+
+// rows/columns weight SAM channel `channel` serves when it owns every
+// weight_channel_count'th of `lines`
+int weight_channel_lines(int lines, int weight_channel_count, int channel);
+
+/**
+ * @brief Tile grid an f_out x reduction weight matrix takes on a
+ * filter_count x channel_count array. Stands in for a padded copy of the
+ * weights: a PE row/column of a tile is active when the tile puts a weight
+ * there, otherwise the PE holds PAD and bypasses.
+ */
+struct WeightTiles
+{
+    int f_out{0};
+    int reduction{0};
+    int filter_tile{1};
+    int channel_tile{1};
+    int verticle_tile_count{0};
+    int horizontal_tile_count{0};
+
+    WeightTiles() = default;
+    WeightTiles(int _f_out, int _reduction, const Mapping& mapping);
+
+    int tile_count() const;
+    bool filter_active(int verticle_tile, int filter_row) const;
+    bool column_active(int horizontal_tile, int channel_column) const;
+};
+
+/**
+ * @brief Weight SAM image of one layer. Every channel owns a region holding
+ * its rows/columns of each tile back to back in tile schedule order, so the
+ * channel streams a tile from consecutive addresses. data is words x lanes.
+ */
+struct PackedWeights
+{
+    int lanes;
+    int words;
+    int tile_count;
+    vector<unsigned int> region_base; // per weight channel
+    vector<int> data;
+
+    const int* word(int addr) const;
+};
+
+/**
+ * @brief Packs an f_out x reduction row major weight matrix straight into
+ * the weight SAM image in one pass, no padded copy of the weights is made.
+ * Lanes of a ROW word are contiguous in the source and copied as a block.
+ */
+PackedWeights pack_weights(const int* weights, int f_out, int reduction, const Mapping& mapping,
+                           int filter_count, int channel_count, WeightDelivery delivery, int weight_channel_count);
+
+#endif
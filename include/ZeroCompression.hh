@@ -0,0 +1,80 @@
+#if !defined(__ZERO_COMPRESSION_CPP__)
+#define __ZERO_COMPRESSION_CPP__
+
+#include <systemc>
+#include <assert.h>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+using namespace sc_core;
+using namespace sc_dt;
+
+enum class CompressionFormat
+{
+    NONE,    // every element stored
+    BITMASK, // one presence bit per element, then the nonzero values
+    RLE      // (zero run, value) pairs, runs packed RLE_RUNS_PER_WORD to a word
+};
+
+CompressionFormat compression_format_from_string(const string& format);
+
+string compression_format_to_string(CompressionFormat format);
+
+#define BITMASK_BITS_PER_WORD 32
+#define RLE_RUN_BITS 8
+#define RLE_RUNS_PER_WORD 4
+#define RLE_MAX_RUN 255 // longer runs store an explicit zero value
+
+/**
+ * @brief Compressed image of one activation plane. Stored as the metadata
+ * words followed by the value words. Trailing zeros cost nothing in either
+ * format, the plane length is known to the reader.
+ */
+struct CompressedPlane
+{
+    int length;
+    vector<int> metadata;
+    vector<int> values;
+
+    int words() const;
+};
+
+CompressedPlane compress_plane(const int* data, int length, CompressionFormat format);
+
+vector<int> decompress_plane(const CompressedPlane& plane, CompressionFormat format);
+
+/**
+ * @brief Decompression stage on the read channels of a SAM holding
+ * compressed planes back to back. Generators keep streaming uncompressed
+ * element addresses (plane * plane_length + element), read() turns an
+ * address into the element value and only touches the SAM for the value
+ * word of a nonzero and for a metadata word the channel has not fetched
+ * yet, so access counts follow the compressed size. The per element slot
+ * tables stand in for the running popcount/run decoder of the hardware.
+ */
+template <typename DataType>
+struct ZeroDecompressor
+{
+    CompressionFormat format;
+    int plane_length;
+    vector<int> plane_base;              // first metadata word of every plane
+    vector<int> plane_metadata_words;
+    vector<vector<int>> value_slot;      // per plane and element, -1 for an implicit zero
+    vector<vector<int>> metadata_word;   // per plane and element
+    vector<long int> last_metadata;      // per channel, plane * plane_length + word last fetched
+
+    // appends a plane stored at `base`
+    void add_plane(const CompressedPlane& plane, int base);
+
+    void clear(int _plane_length, CompressionFormat _format);
+
+    void reset();
+
+    DataType read(unsigned int channel, unsigned int addr, sc_vector<sc_vector<sc_signal<DataType>>>& ram, int& access_counter);
+
+    ZeroDecompressor();
+};
+
+#endif
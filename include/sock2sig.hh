@@ -12,12 +12,28 @@
 
 #include <tlm_utils/simple_target_socket.h>
 
+#include <cstdint>
 #include <memory>
 #include <systemc>
 
 using namespace sc_core;
 using namespace sc_dt;
 
+// Signal type of one beat. sc_int holds up to 64 bits, wider buses use
+// sc_biguint. pack assembles a beat from up to BUSWIDTH / 8 little endian
+// bytes, the bits past them are zero.
+template <unsigned int BUSWIDTH, bool WIDE = (BUSWIDTH > 64)>
+struct SockBeat {
+  typedef sc_int<BUSWIDTH> type;
+  static type pack(const uint8_t* bytes, size_t count);
+};
+
+template <unsigned int BUSWIDTH>
+struct SockBeat<BUSWIDTH, true> {
+  typedef sc_biguint<BUSWIDTH> type;
+  static type pack(const uint8_t* bytes, size_t count);
+};
+
 template <unsigned int BUSWIDTH>
 class Sock2Sig : public sc_module {
   SC_HAS_PROCESS(Sock2Sig<BUSWIDTH>);
@@ -26,7 +42,7 @@ class Sock2Sig : public sc_module {
   Sock2Sig(int readyDelay = 1, sc_module_name moduleName = "sock-2-sig");
 
   tlm_utils::simple_target_socket<Sock2Sig, BUSWIDTH> inputSock;
-  sc_out<sc_int<BUSWIDTH>> outputSig;
+  sc_out<typename SockBeat<BUSWIDTH>::type> outputSig;
   sc_out<bool> dataReady;
   sc_in<bool> assertRead;
 
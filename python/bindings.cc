@@ -0,0 +1,122 @@
+#include "LayerEngine.hh"
+#include "Mapper.hh"
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+namespace py = pybind11;
+
+// int32 C order arrays are used in place, anything else is converted once
+typedef py::array_t<int, py::array::c_style | py::array::forcecast> IntArray;
+
+// Every counter comes from the analytic cost model, not from a simulated
+// run, so the keys say they are estimates.
+static py::dict cost_to_dict(const MappingCost& cost)
+{
+    py::dict counters;
+    counters["fits"] = cost.fits;
+    counters["estimated_cycles"] = cost.cycles;
+    counters["estimated_macs"] = cost.macs;
+    counters["estimated_ifmap_reads"] = cost.ifmap_reads;
+    counters["estimated_psum_reads"] = cost.psum_reads;
+    counters["estimated_psum_writes"] = cost.psum_writes;
+    counters["estimated_weight_loads"] = cost.weight_loads;
+    counters["estimated_dram_words"] = cost.dram_words;
+    counters["estimated_pe_utilization"] = cost.pe_utilization;
+    counters["estimated_energy"] = cost.energy;
+    counters["estimated_score"] = cost.score;
+    return counters;
+}
+
+// Runs one layer in process, the ofmap is allocated as a numpy array and
+// written in place so nothing is copied on the way out. The ofmap is the
+// computed conv, the counters next to it are the mapping's estimates. The ifmap is
+// c_in x h x w and the weights f_out x c_in x k x k.
+static py::dict run_layer(IntArray ifmap, IntArray weights, int filter_count, int channel_count, py::object mapping_arg)
+{
+    if (ifmap.ndim() != 3 || weights.ndim() != 4 || weights.shape(1) != ifmap.shape(0) || weights.shape(2) != weights.shape(3))
+    {
+        throw std::invalid_argument("expected a c_in x h x w ifmap and f_out x c_in x k x k weights");
+    }
+    int k = weights.shape(3);
+    LayerShape layer{(int)ifmap.shape(0), (int)weights.shape(0), k, (int)ifmap.shape(1) - k + 1, (int)ifmap.shape(2) - k + 1};
+    ArrayShape array{filter_count, channel_count, layer.c_in * layer.ifmap_size(), layer.f_out * layer.ofmap_size()};
+    Mapping mapping = (mapping_arg.is_none()) ? Mapping::full_array(array) : mapping_arg.cast<Mapping>();
+
+    IntArray ofmap(vector<py::ssize_t>{layer.f_out, layer.ofmap_h, layer.ofmap_w});
+    MappingCost cost;
+    {
+        py::gil_scoped_release release;
+        cost = run_layer_engine(ifmap.data(), weights.data(), ofmap.mutable_data(), layer, mapping, array);
+    }
+    py::dict result = cost_to_dict(cost);
+    result["mapping"] = mapping.to_string();
+    result["ofmap"] = ofmap;
+    return result;
+}
+
+PYBIND11_MODULE(cnn_sim, m)
+{
+    m.doc() = "In process bindings of the systolic array model";
+
+    py::enum_<UnrollOrientation>(m, "UnrollOrientation")
+        .value("HORIZONTAL", UnrollOrientation::HORIZONTAL)
+        .value("VERTICLE", UnrollOrientation::VERTICLE);
+
+    py::enum_<LoopOrder>(m, "LoopOrder")
+        .value("FILTER_TILES_OUTER", LoopOrder::FILTER_TILES_OUTER)
+        .value("CHANNEL_TILES_OUTER", LoopOrder::CHANNEL_TILES_OUTER);
+
+    py::class_<LayerShape>(m, "LayerShape")
+        .def(py::init([](int c_in, int f_out, int k, int ofmap_h, int ofmap_w) { return LayerShape{c_in, f_out, k, ofmap_h, ofmap_w}; }),
+             py::arg("c_in"), py::arg("f_out"), py::arg("k"), py::arg("ofmap_h"), py::arg("ofmap_w"))
+        .def_readwrite("c_in", &LayerShape::c_in)
+        .def_readwrite("f_out", &LayerShape::f_out)
+        .def_readwrite("k", &LayerShape::k)
+        .def_readwrite("ofmap_h", &LayerShape::ofmap_h)
+        .def_readwrite("ofmap_w", &LayerShape::ofmap_w)
+        .def("ifmap_size", &LayerShape::ifmap_size)
+        .def("ofmap_size", &LayerShape::ofmap_size);
+
+    py::class_<ArrayShape>(m, "ArrayShape")
+        .def(py::init([](int rows, int cols, int ifmap_mem_size, int psum_mem_size) { return ArrayShape{rows, cols, ifmap_mem_size, psum_mem_size}; }),
+             py::arg("rows"), py::arg("cols"), py::arg("ifmap_mem_size"), py::arg("psum_mem_size"))
+        .def_readwrite("rows", &ArrayShape::rows)
+        .def_readwrite("cols", &ArrayShape::cols)
+        .def_readwrite("ifmap_mem_size", &ArrayShape::ifmap_mem_size)
+        .def_readwrite("psum_mem_size", &ArrayShape::psum_mem_size);
+
+    py::class_<Mapping>(m, "Mapping")
+        .def(py::init<UnrollOrientation, LoopOrder, int, int>(), py::arg("orientation"), py::arg("loop_order"), py::arg("filter_tile"), py::arg("channel_tile"))
+        .def_readwrite("orientation", &Mapping::orientation)
+        .def_readwrite("loop_order", &Mapping::loop_order)
+        .def_readwrite("filter_tile", &Mapping::filter_tile)
+        .def_readwrite("channel_tile", &Mapping::channel_tile)
+        .def("filter_tiles", &Mapping::filter_tiles)
+        .def("channel_tiles", &Mapping::channel_tiles)
+        .def("tile_schedule", &Mapping::tile_schedule)
+        .def("legal", &Mapping::legal)
+        .def("__repr__", &Mapping::to_string)
+        .def_static("full_array", &Mapping::full_array)
+        .def_static("from_strings", [](const string& orientation, const string& loop_order, int filter_tile, int channel_tile) {
+            return Mapping(Mapping::orientation_from_string(orientation), Mapping::loop_order_from_string(loop_order), filter_tile, channel_tile);
+        });
+
+    m.def("estimate_mapping_cost", [](const Mapping& mapping, const LayerShape& layer, const ArrayShape& array) { return cost_to_dict(estimate_mapping_cost(mapping, layer, array)); },
+          py::arg("mapping"), py::arg("layer"), py::arg("array"));
+
+    m.def("enumerate_mappings", &enumerate_mappings, py::arg("layer"), py::arg("array"));
+
+    m.def("search_mappings", [](const LayerShape& layer, const ArrayShape& array) {
+              py::list ranked;
+              for (auto& candidate : search_mappings(layer, array))
+              {
+                  ranked.append(py::make_tuple(candidate.first, cost_to_dict(candidate.second)));
+              }
+              return ranked;
+          },
+          py::arg("layer"), py::arg("array"));
+
+    m.def("run_layer", &run_layer, py::arg("ifmap"), py::arg("weights"), py::arg("filter_count") = 7, py::arg("channel_count") = 9, py::arg("mapping") = py::none(),
+          "Runs a conv layer without SystemC, returns the ofmap as an int32 array next to the estimated_* counters of the analytic cost model");
+}
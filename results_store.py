@@ -0,0 +1,137 @@
+"""Append only SQLite store of sweep results.
+
+Every run is one row of the runs table. The layer and arch config, status,
+build and sweep name are fixed columns. Every metric a run reports becomes
+its own column, named after its snake_cased label, and is added the first
+time it shows up. Timings printed as "<n>ms" land in "<label>_ms" integer
+columns. The notebook can load and filter a sweep without parsing text:
+
+    import sqlite3, pandas as pd
+    con = sqlite3.connect("results.sqlite")
+    df = pd.read_sql("select * from runs where sweep = 'ifmap' and status = 'PASS'", con)
+
+Fork server output can also be ingested from the shell:
+
+    build/tests/estimation_enviornment --serve < configs.txt | python results_store.py --db results.sqlite --sweep ifmap
+"""
+import argparse
+import json
+import re
+import sqlite3
+import sys
+import time
+
+CONFIG_COLUMNS = (
+    "ifmap_h",
+    "ifmap_w",
+    "k",
+    "c_in",
+    "f_out",
+    "filter_count",
+    "channel_count",
+)
+
+SCHEMA = f"""
+create table if not exists runs (
+    row_id integer primary key,
+    sweep text not null,
+    build text,
+    created real not null,
+    run_id integer,
+    config text,
+    {", ".join(f"{column} integer" for column in CONFIG_COLUMNS)},
+    status text not null,
+    exit_code integer,
+    error text
+)
+"""
+
+
+def column_name(label):
+    return re.sub(r"[^0-9a-z]+", "_", label.lower()).strip("_")
+
+
+def column_value(label, value):
+    """Returns the column and value of a metric, "12ms" timings become
+    integer columns suffixed _ms, other numbers stay numbers."""
+    column = column_name(label)
+    if isinstance(value, str):
+        timing = re.fullmatch(r"(\d+)ms", value)
+        if timing:
+            return f"{column}_ms", int(timing.group(1))
+    return column, value
+
+
+def config_from_line(config):
+    """Pulls the layer and arch options out of a configuration line."""
+    args = config.split()
+    values = {}
+    for idx, arg in enumerate(args[:-1]):
+        name = arg.lstrip("-")
+        if arg.startswith("--") and name in CONFIG_COLUMNS:
+            values[name] = int(args[idx + 1])
+    return values
+
+
+class ResultsStore:
+    def __init__(self, path):
+        self.con = sqlite3.connect(path)
+        self.con.execute("pragma journal_mode = wal")
+        self.con.execute(SCHEMA)
+        self.con.execute("create index if not exists runs_sweep on runs (sweep, status)")
+        self.columns = {row[1] for row in self.con.execute("pragma table_info(runs)")}
+
+    def _ensure_column(self, column, value):
+        if column in self.columns:
+            return
+        kind = "real" if isinstance(value, float) else "integer" if isinstance(value, int) else "text"
+        self.con.execute(f'alter table runs add column "{column}" {kind}')
+        self.columns.add(column)
+
+    def append(self, sweep, result, config=None):
+        """Appends one fork server result (a parsed JSON line), config
+        overrides the layer and arch columns parsed from its config line."""
+        row = {
+            "sweep": sweep,
+            "created": time.time(),
+            "run_id": result.get("id"),
+            "config": result.get("config"),
+            "status": result["status"],
+            "exit_code": result.get("exit_code"),
+            "error": result.get("error"),
+        }
+        row.update(config_from_line(result.get("config", "")))
+        if config:
+            row.update(config)
+        for label, value in result.get("metrics", {}).items():
+            column, value = column_value(label, value)
+            if column in CONFIG_COLUMNS:
+                continue
+            row[column] = value
+        for column, value in row.items():
+            self._ensure_column(column, value)
+        columns = ", ".join(f'"{column}"' for column in row)
+        marks = ", ".join("?" for _ in row)
+        self.con.execute(f"insert into runs ({columns}) values ({marks})", tuple(row.values()))
+
+    def commit(self):
+        self.con.commit()
+
+    def close(self):
+        self.con.commit()
+        self.con.close()
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="append fork server JSON lines to a results store")
+    parser.add_argument("--db", required=True, help="SQLite file, created if missing")
+    parser.add_argument("--sweep", required=True, help="name the rows are stored under")
+    parser.add_argument("--commit_every", type=int, default=1000, help="rows per transaction")
+    args = parser.parse_args()
+
+    store = ResultsStore(args.db)
+    for count, line in enumerate(sys.stdin, 1):
+        store.append(args.sweep, json.loads(line))
+        if count % args.commit_every == 0:
+            store.commit()
+    store.close()
@@ -1,4 +1,5 @@
 #include "AddressGenerator.hh"
+#include <algorithm>
 
 Descriptor_2D::Descriptor_2D(unsigned int _next, unsigned int _start, DescriptorState _state,
                              unsigned int _x_count, int _x_modify, unsigned int _y_count,
@@ -14,6 +15,8 @@ Descriptor_2D::Descriptor_2D(unsigned int _next, unsigned int _start, Descriptor
     this->x_counter = _x_count;
     this->y_counter = _y_count;
     this->repeat = 0;
+    this->modulo_base = 0;
+    this->modulo_length = 0;
 }
 
 Descriptor_2D::Descriptor_2D(const Descriptor_2D &rhs)
@@ -28,6 +31,8 @@ Descriptor_2D::Descriptor_2D(const Descriptor_2D &rhs)
     this->x_counter = rhs.x_counter;
     this->y_counter = rhs.y_counter;
     this->repeat = rhs.repeat;
+    this->modulo_base = rhs.modulo_base;
+    this->modulo_length = rhs.modulo_length;
 }
 
 Descriptor_2D Descriptor_2D::default_descriptor()
@@ -59,19 +64,28 @@ Descriptor_2D Descriptor_2D::delay_inst(int delay_time)
         /*y_modify*/ 0);
 }
 
-Descriptor_2D Descriptor_2D::stream_inst(int start_idx, int stream_size, int repeats)
+Descriptor_2D Descriptor_2D::stream_inst(int start_idx, int stream_size, int repeats, int stride)
 {
     return Descriptor_2D(
         /*next*/ 0,
         /*start*/ start_idx,
         /*state*/ DescriptorState::GENERATE,
         /*x_count*/ stream_size,
-        /*x_modify*/ 1,
+        /*x_modify*/ stride,
         /*y_count*/ repeats,
-        /*y_modify*/ -(stream_size));
+        /*y_modify*/ -(stream_size * stride));
 }
 
 
+Descriptor_2D Descriptor_2D::ring_stream_inst(int start_idx, int stream_size, int ring_base, int ring_length)
+{
+    assert(ring_length > 0 && start_idx >= ring_base && start_idx < ring_base + ring_length);
+    Descriptor_2D desc = stream_inst(start_idx, stream_size, 0);
+    desc.modulo_base = ring_base;
+    desc.modulo_length = ring_length;
+    return desc;
+}
+
 Descriptor_2D Descriptor_2D::genhold_inst(int start_idx, int hold_time, int repeats, int access_offset)
 {
     return Descriptor_2D(
@@ -107,7 +121,41 @@ bool Descriptor_2D::operator==(const Descriptor_2D &rhs)
     return this->next == rhs.next && this->start == rhs.start &&
            this->state == rhs.state && this->x_count == rhs.x_count &&
            this->x_modify == rhs.x_modify && this->y_count == rhs.y_count &&
-           this->y_modify == rhs.y_modify;
+           this->y_modify == rhs.y_modify && this->modulo_base == rhs.modulo_base &&
+           this->modulo_length == rhs.modulo_length;
+}
+
+unsigned int Descriptor_2D::wrap(long int index) const
+{
+    if (modulo_length == 0)
+    {
+        return index;
+    }
+    long int offset = (index - (long int)modulo_base) % (long int)modulo_length;
+    return modulo_base + ((offset < 0) ? offset + modulo_length : offset);
+}
+
+// Rows start y_modify past the end of the previous one, so the extremes of
+// the linear walk are at its corners.
+std::pair<long int, long int> Descriptor_2D::address_range() const
+{
+    if (modulo_length != 0)
+    {
+        return {modulo_base, (long int)modulo_base + modulo_length - 1};
+    }
+    long int row_step = (long int)x_count * x_modify + y_modify;
+    long int first = start;
+    long int last = start;
+    for (long int row : {0L, (long int)y_count})
+    {
+        for (long int column : {0L, (long int)x_count})
+        {
+            long int index = start + row * row_step + column * x_modify;
+            first = std::min(first, index);
+            last = std::max(last, index);
+        }
+    }
+    return {first, last};
 }
 
 template <typename DataType>
@@ -195,18 +243,20 @@ void AddressGenerator<DataType>::updateCurrentIndex()
     {
         if (y_count_remaining != 0)
         {
-            current_ram_index = current_ram_index + currentDescriptor().y_modify;
+            unsigned int next_index = currentDescriptor().wrap(current_ram_index + currentDescriptor().y_modify);
+            current_ram_index = next_index;
             // HACK WITH CHANNEL->SET_ADDR
-            channel->set_addr(current_ram_index + currentDescriptor().y_modify);
+            channel->set_addr(next_index);
             x_count_remaining = currentDescriptor().x_count;
             y_count_remaining = y_count_remaining - 1;
         }
     }
     else
     {
+        unsigned int next_index = currentDescriptor().wrap(current_ram_index + currentDescriptor().x_modify);
+        current_ram_index = next_index;
         // HACK WITH CHANNEL->SET_ADDR
-        current_ram_index = current_ram_index + currentDescriptor().x_modify;
-        channel->set_addr(current_ram_index + currentDescriptor().x_modify);
+        channel->set_addr(next_index);
     }
 }
 
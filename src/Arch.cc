@@ -0,0 +1,761 @@
+#include "Arch.hh"
+#include "DescriptorCompiler.hh"
+#include "ReferenceModel.hh"
+#include "ReuseAnalysis.hh"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <stdexcept>
+#include <xtensor/xio.hpp>
+#include <xtensor/xview.hpp>
+
+int padded_weight_size(const Mapping &mapping, int filter_count, int channel_count, int f_out, int c_in, int k)
+{
+    LayerShape layer{c_in, f_out, k, 1, 1};
+    return mapping.filter_tiles(layer) * mapping.channel_tiles(layer) * filter_count * channel_count;
+}
+
+template <typename DataType>
+void set_channel_modes(Arch<DataType> &arch)
+{
+
+    for (int i = 0; i < arch.filter_count; i++)
+    {
+        arch.psum_mem.channels[i].set_mode(MemoryChannelMode::WRITE);
+    }
+    for (int i = arch.filter_count; i < arch.filter_count * 2; i++)
+    {
+        arch.psum_mem.channels[i].set_mode(MemoryChannelMode::READ);
+    }
+
+    for (int i = 0; i < arch.channel_count; i++)
+    {
+        arch.ifmap_mem.channels[i].set_mode(MemoryChannelMode::READ);
+    }
+
+    for (int i = 0; i < arch.weight_channel_count; i++)
+    {
+        arch.weight_mem.channels[i].set_mode(MemoryChannelMode::READ);
+    }
+}
+
+template <typename DataType>
+int store_compressed_ifmap(Arch<DataType> &arch, const xt::xarray<int> &planes)
+{
+    int channels = planes.shape(0);
+    int plane_w = planes.shape(2);
+    int plane_length = planes.shape(1) * plane_w;
+    arch.ifmap_decompressor.clear(plane_length, arch.ifmap_compression);
+    vector<int> data(plane_length);
+    int base = 0;
+    for (int c = 0; c < channels; c++)
+    {
+        for (int element = 0; element < plane_length; element++)
+        {
+            data[element] = planes(c, element / plane_w, element % plane_w);
+        }
+        auto compressed = compress_plane(data.data(), plane_length, arch.ifmap_compression);
+        assert(base + compressed.words() <= arch.ifmap_mem_size);
+        int addr = base;
+        for (int word : compressed.metadata)
+        {
+            arch.ifmap_mem.mem.ram.at(addr++).at(0).write(word);
+        }
+        for (int word : compressed.values)
+        {
+            arch.ifmap_mem.mem.ram.at(addr++).at(0).write(word);
+        }
+        arch.ifmap_decompressor.add_plane(compressed, base);
+        base = addr;
+    }
+    arch.ifmap_mem.mem.decompressor = &arch.ifmap_decompressor;
+    arch.ifmap_mem.mem.access_counter += base;
+    arch.ifmap_stored_words += base;
+    arch.ifmap_dense_words += channels * plane_length;
+    return base;
+}
+
+template <typename DataType>
+xt::xarray<int> stage_ifmap(Arch<DataType> &arch, MemoryHierarchy<DataType> &hierarchy, int channel_in, int ifmap_h, int ifmap_w)
+{
+    xt::xarray<int> ifmap = generate_ifmap(channel_in, ifmap_h, ifmap_w);
+    vector<int> words(ifmap.begin(), ifmap.end());
+    assert(words.size() <= (size_t)arch.ifmap_mem_size);
+
+    hierarchy.load(words);
+    arch.dram_access_counter += words.size();
+    for (unsigned int link = 0; link + 1 < hierarchy.configs.size(); link++)
+    {
+        int width = hierarchy.configs[link].width;
+        hierarchy.run_transfer(link, 0, 0, (words.size() + width - 1) / width);
+    }
+    int innermost = hierarchy.configs.size() - 1;
+    for (unsigned int idx = 0; idx < words.size(); idx++)
+    {
+        arch.ifmap_mem.mem.ram.at(idx).at(0).write(hierarchy.word(innermost, idx));
+        arch.ifmap_mem.mem.access_counter++;
+    }
+    sc_start(1, SC_NS);
+    cout << "Staged ifmap through " << hierarchy.configs.size() << " memory levels into ifmap mem" << endl;
+    return ifmap;
+}
+
+template <typename DataType>
+xt::xarray<int> dram_load(Arch<DataType> &arch, int channel_in, int ifmap_h, int ifmap_w)
+{
+    assert(arch.ifmap_layout.size(channel_in, ifmap_h * ifmap_w) <= arch.ifmap_mem_size);
+
+    xt::xarray<int> ifmap = generate_ifmap(channel_in, ifmap_h, ifmap_w);
+    if (arch.ifmap_compression != CompressionFormat::NONE)
+    {
+        arch.dram_access_counter += store_compressed_ifmap(arch, ifmap);
+        sc_start(1, SC_NS);
+        cout << "Loaded compressed dram contents into ifmap mem" << endl;
+        return ifmap;
+    }
+
+    // cout << "IFMAP" << endl;
+    // cout << ifmap << endl;
+
+    for (int c = 0; c < channel_in; c++)
+    {
+        for (int i = 0; i < ifmap_h; i++)
+        {
+            for (int j = 0; j < ifmap_w; j++)
+            {
+                auto &mem_ptr = arch.ifmap_mem.mem.ram.at(arch.ifmap_layout.index(c, i * ifmap_w + j, channel_in, ifmap_h * ifmap_w)).at(0);
+                mem_ptr.write(ifmap(c, i, j));
+                arch.dram_access_counter++;
+                arch.ifmap_mem.mem.access_counter++;
+            }
+        }
+    }
+    sc_start(1, SC_NS);
+    cout << "Loaded dram contents into ifmap mem" << endl;
+
+    return ifmap;
+}
+
+template <typename DataType>
+xt::xarray<int> dram_store(Arch<DataType> &arch, int filter_out, int ofmap_h, int ofmap_w, int filter_stride)
+{
+    filter_stride = (filter_stride) ? filter_stride : ofmap_h * ofmap_w;
+    assert(arch.ofmap_layout.size(filter_out, filter_stride) <= arch.psum_mem_size);
+    xt::xarray<int> result = xt::zeros<int>({filter_out, ofmap_h, ofmap_w});
+    bool compressed = arch.ifmap_compression != CompressionFormat::NONE;
+    for (int f = 0; f < filter_out; f++)
+    {
+        for (int i = 0; i < ofmap_h; i++)
+        {
+            for (int j = 0; j < ofmap_w; j++)
+            {
+                auto &mem_ptr = arch.psum_mem.mem.ram.at(arch.ofmap_layout.index(f, i * ofmap_w + j, filter_out, filter_stride)).at(0);
+                result(f, i, j) = mem_ptr.read();
+                arch.dram_access_counter += (compressed) ? 0 : 1;
+                arch.psum_mem.mem.access_counter++;
+            }
+        }
+        // the ofmap leaves for DRAM in the activation format
+        if (compressed)
+        {
+            vector<int> plane(result.begin() + f * ofmap_h * ofmap_w, result.begin() + (f + 1) * ofmap_h * ofmap_w);
+            arch.dram_access_counter += compress_plane(plane.data(), plane.size(), arch.ifmap_compression).words();
+        }
+    }
+    cout << "Loaded dram contents from psum mem" << endl;
+    return result;
+}
+
+template <typename DataType>
+void dram_load_strip(Arch<DataType> &arch, xt::xarray<int> ifmap, int row_start, int row_count)
+{
+    int channel_in = ifmap.shape(0);
+    int ifmap_w = ifmap.shape(2);
+    assert(arch.ifmap_layout.size(channel_in, row_count * ifmap_w) <= arch.ifmap_mem_size);
+
+    if (arch.ifmap_compression != CompressionFormat::NONE)
+    {
+        xt::xarray<int> strip = xt::view(ifmap, xt::all(), xt::range(row_start, row_start + row_count), xt::all());
+        arch.dram_access_counter += store_compressed_ifmap(arch, strip);
+        sc_start(1, SC_NS);
+        return;
+    }
+
+    for (int c = 0; c < channel_in; c++)
+    {
+        for (int i = 0; i < row_count; i++)
+        {
+            for (int j = 0; j < ifmap_w; j++)
+            {
+                auto &mem_ptr = arch.ifmap_mem.mem.ram.at(arch.ifmap_layout.index(c, i * ifmap_w + j, channel_in, row_count * ifmap_w)).at(0);
+                mem_ptr.write(ifmap(c, row_start + i, j));
+                arch.dram_access_counter++;
+                arch.ifmap_mem.mem.access_counter++;
+            }
+        }
+    }
+    sc_start(1, SC_NS);
+}
+
+template <typename DataType>
+void onchip_transfer(Arch<DataType> &arch, int channels, int ofmap_h, int ofmap_w, int filter_stride)
+{
+    assert(arch.ifmap_layout.size(channels, ofmap_h * ofmap_w) <= arch.ifmap_mem_size);
+    assert(arch.ofmap_layout.size(channels, filter_stride) <= arch.psum_mem_size);
+
+    int words = 0;
+    if (arch.ifmap_compression != CompressionFormat::NONE)
+    {
+        // compressed on the way out of psum mem, only the compressed words move
+        xt::xarray<int> planes = xt::zeros<int>({channels, ofmap_h, ofmap_w});
+        for (int c = 0; c < channels; c++)
+        {
+            for (int i = 0; i < ofmap_h; i++)
+            {
+                for (int j = 0; j < ofmap_w; j++)
+                {
+                    planes(c, i, j) = arch.psum_mem.mem.ram.at(arch.ofmap_layout.index(c, i * ofmap_w + j, channels, filter_stride)).at(0).read();
+                    arch.psum_mem.mem.access_counter++;
+                }
+            }
+        }
+        words = store_compressed_ifmap(arch, planes);
+    }
+    else
+    {
+        for (int c = 0; c < channels; c++)
+        {
+            for (int i = 0; i < ofmap_h; i++)
+            {
+                for (int j = 0; j < ofmap_w; j++)
+                {
+                    auto &src_ptr = arch.psum_mem.mem.ram.at(arch.ofmap_layout.index(c, i * ofmap_w + j, channels, filter_stride)).at(0);
+                    auto &dst_ptr = arch.ifmap_mem.mem.ram.at(arch.ifmap_layout.index(c, i * ofmap_w + j, channels, ofmap_h * ofmap_w)).at(0);
+                    dst_ptr.write(src_ptr.read());
+                    arch.psum_mem.mem.access_counter++;
+                    arch.ifmap_mem.mem.access_counter++;
+                    words++;
+                }
+            }
+        }
+    }
+    arch.onchip_transfer_counter += words;
+    int lanes = std::min(arch.filter_count, arch.channel_count);
+    sc_start((words + lanes - 1) / lanes + 1, SC_NS);
+}
+
+int weight_preload_cycles(int preload_tiles, int max_lines)
+{
+    return preload_tiles * max_lines + WEIGHT_PRELOAD_LATENCY;
+}
+
+template <typename DataType>
+void generate_and_load_weight_program(Arch<DataType> &arch, int tile_count, int ifmap_h, int ifmap_w)
+{
+    vector<Descriptor_2D> suspend_program;
+    suspend_program.push_back(Descriptor_2D::suspend_inst());
+
+    bool resident = true;
+    for (auto &pe : arch.pe_array)
+    {
+        resident &= pe.weightsResident(tile_count);
+    }
+    if (resident)
+    {
+        // e.g. a pipeline stage replaying the weights of its previous image
+        arch.weight_preload_cycles = 0;
+        for (auto &gen : arch.weight_mem.generators)
+        {
+            gen.loadProgram(suspend_program);
+        }
+        return;
+    }
+
+    int reg_capacity = arch.weight_config.reg_capacity;
+    int preload_tiles = (reg_capacity) ? std::min(reg_capacity, tile_count) : tile_count;
+    int tile_cycles = ifmap_h * ifmap_w + 1;
+    int max_lines = arch.weight_lines_of_channel(0);
+    // a refill's lead delay and stream, each with its descriptor overhead,
+    // and the read have to fit in the tiles the other registers still hold
+    // once the last column is done with the tile being replaced
+    int refill_cycles = (max_lines - 1) + 2 * DESCRIPTOR_OVERHEAD_CYCLES + WEIGHT_READ_CYCLES;
+    if (preload_tiles < tile_count && refill_cycles + arch.channel_count > (reg_capacity - 1) * tile_cycles)
+    {
+        throw std::invalid_argument("weight SAM can't refill the PE registers within a tile, add weight registers or weight channels");
+    }
+    arch.weight_preload_cycles = weight_preload_cycles(preload_tiles, max_lines);
+
+    for (int channel = 0; channel < arch.weight_channel_count; channel++)
+    {
+        int lines = arch.weight_lines_of_channel(channel);
+        int base = arch.weight_region_base.at(channel);
+        vector<Descriptor_2D> program;
+        program.push_back(Descriptor_2D::stream_inst(base, preload_tiles * lines - 1, 0));
+        // the cycle the channel's next descriptor starts in
+        int cursor = (preload_tiles * lines - 1) + DESCRIPTOR_OVERHEAD_CYCLES;
+        for (int tile = preload_tiles; tile < tile_count; tile++)
+        {
+            // the last column starts channel_count cycles after enable plus
+            // preload, the refill follows the replaced tile out of it by the read
+            int replaced_done = arch.weight_preload_cycles + arch.channel_count + (tile - reg_capacity + 1) * tile_cycles;
+            int start = replaced_done + WEIGHT_READ_CYCLES;
+            if (start - cursor >= DESCRIPTOR_OVERHEAD_CYCLES)
+            {
+                program.push_back(Descriptor_2D::delay_inst(start - cursor - DESCRIPTOR_OVERHEAD_CYCLES));
+                cursor = start;
+            }
+            program.push_back(Descriptor_2D::stream_inst(base + tile * lines, lines - 1, 0));
+            cursor += (lines - 1) + DESCRIPTOR_OVERHEAD_CYCLES;
+        }
+        program.push_back(Descriptor_2D::suspend_inst());
+        Descriptor_2D::make_sequential(program);
+        arch.weight_mem.generators.at(channel).loadProgram(program);
+    }
+}
+
+template <typename DataType>
+void generate_and_load_pe_program(Arch<DataType> &arch, const WeightTiles &tiles, int ifmap_h, int ifmap_w)
+{
+    int tile_count = tiles.tile_count();
+    generate_and_load_weight_program(arch, tile_count, ifmap_h, ifmap_w);
+
+    int stream_size = ifmap_h * ifmap_w;
+    int delay_offset = 1 + arch.weight_preload_cycles;
+    for (int channel_column = 0; channel_column < arch.channel_count; channel_column++)
+    {
+        for (int filter_row = 0; filter_row < arch.filter_count; filter_row++)
+        {
+            PE<DataType> &cur_pe = arch.pe_array[filter_row * arch.channel_count + channel_column];
+            vector<Descriptor_2D> program;
+            program.push_back(Descriptor_2D::delay_inst(channel_column + delay_offset));
+            program.push_back(Descriptor_2D::genhold_inst(0, stream_size, tile_count - 1, 1));
+            program.push_back(Descriptor_2D::suspend_inst());
+            cur_pe.loadProgram(program);
+        }
+    }
+}
+
+template <typename DataType>
+void generate_and_load_psum_program(Arch<DataType> &arch, const WeightTiles &tiles, int ofmap_h, int ofmap_w)
+{
+    int verticle_tile_count = tiles.verticle_tile_count;
+    auto schedule = arch.mapping.tile_schedule(verticle_tile_count, tiles.horizontal_tile_count);
+
+    int stream_size = ofmap_h * ofmap_w;
+    int psum_stride = arch.ofmap_layout.stride(arch.ofmap_channels);
+
+    xt::xarray<int> run_bitmap = xt::zeros<int>({verticle_tile_count, (int)arch.filter_count});
+    for (int v = 0; v < verticle_tile_count; v++)
+    {
+        for (int filter = 0; filter < arch.filter_count; filter++)
+        {
+            run_bitmap(v, filter) = tiles.filter_active(v, filter);
+        }
+    }
+
+    // cout << run_bitmap << endl;
+
+    for (int write_gen_idx = 0; write_gen_idx < arch.filter_count; write_gen_idx++)
+    {
+        vector<Descriptor_2D> program;
+        bool any_active = false;
+        for (int v = 0; v < verticle_tile_count; v++)
+        {
+            any_active |= run_bitmap(v, write_gen_idx);
+        }
+
+        program.push_back(Descriptor_2D::delay_inst(arch.channel_count + 1 + arch.weight_preload_cycles));
+        for (auto &tile : schedule)
+        {
+            if (!any_active)
+            {
+                break;
+            }
+            int v = tile.first;
+            // each filter owns a stream_size element plane of psum mem
+            int filter = v * arch.mapping.filter_tile + write_gen_idx;
+            if (run_bitmap(v, write_gen_idx))
+            {
+                program.push_back(Descriptor_2D::stream_inst(arch.ofmap_layout.base(filter, stream_size), stream_size - 1, 0, psum_stride));
+            }
+            else
+            {
+                program.push_back(Descriptor_2D::delay_inst(stream_size - 1));
+            }
+        }
+
+        program.push_back(Descriptor_2D::suspend_inst());
+        Descriptor_2D::make_sequential(program);
+        arch.psum_mem.generators.at(write_gen_idx).loadProgram(program);
+    }
+
+    for (int read_gen_idx = arch.filter_count; read_gen_idx < arch.filter_count * 2; read_gen_idx++)
+    {
+        vector<Descriptor_2D> program;
+        int filter_row = read_gen_idx - arch.filter_count;
+        bool any_active = false;
+        for (int v = 0; v < verticle_tile_count; v++)
+        {
+            any_active |= run_bitmap(v, filter_row);
+        }
+        program.push_back(Descriptor_2D::delay_inst(3 + arch.weight_preload_cycles));
+
+        bool first_tile = true;
+        for (auto &tile : schedule)
+        {
+            if (!any_active)
+            {
+                break;
+            }
+            int v = tile.first;
+            int h = tile.second;
+            int filter = v * arch.mapping.filter_tile + filter_row;
+            if (run_bitmap(v, filter_row) && h > 0)
+            {
+                program.push_back(Descriptor_2D::stream_inst(arch.ofmap_layout.base(filter, stream_size), stream_size - 1, 0, psum_stride));
+            }
+            else
+            {
+                // first pass of a filter and idle tiles have nothing to accumulate
+                program.push_back(Descriptor_2D::delay_inst(stream_size - 4 * first_tile - 1));
+            }
+            first_tile = false;
+        }
+        program.push_back(Descriptor_2D::suspend_inst());
+        Descriptor_2D::make_sequential(program);
+        arch.psum_mem.generators.at(read_gen_idx).loadProgram(program);
+    }
+}
+
+template <typename DataType>
+void generate_and_load_post_processors(Arch<DataType> &arch, const WeightTiles &tiles, xt::xarray<int> biases, int ofmap_h, int ofmap_w, const PostProcessConfig &config)
+{
+    int verticle_tile_count = tiles.verticle_tile_count;
+    int horizontal_tile_count = tiles.horizontal_tile_count;
+
+    for (int write_gen_idx = 0; write_gen_idx < arch.filter_count; write_gen_idx++)
+    {
+        // mirrors the psum write program, one bias per active verticle tile
+        vector<int> tile_biases;
+        for (int v = 0; v < verticle_tile_count; v++)
+        {
+            if (tiles.filter_active(v, write_gen_idx))
+            {
+                tile_biases.push_back(biases(v * arch.mapping.filter_tile + write_gen_idx));
+            }
+        }
+        bool passes_outer = arch.mapping.loop_order == LoopOrder::CHANNEL_TILES_OUTER;
+        PostProcessor<DataType> &post_processor = arch.psum_post_processors.at(write_gen_idx);
+        post_processor.configure(config, tile_biases, horizontal_tile_count, ofmap_h, ofmap_w, passes_outer, arch.ofmap_layout.stride(arch.ofmap_channels));
+        arch.psum_mem.mem.post_processors.at(write_gen_idx) = (config.enabled()) ? &post_processor : nullptr;
+    }
+}
+
+template <typename DataType>
+void generate_and_load_ifmap_in_program(Arch<DataType> &arch, const WeightTiles &tiles, int ifmap_h, int ifmap_w)
+{
+    int verticle_tile_count = tiles.verticle_tile_count;
+    int horizontal_tile_count = tiles.horizontal_tile_count;
+
+    xt::xarray<int> run_bitmap = xt::zeros<int>({verticle_tile_count, horizontal_tile_count, (int)arch.channel_count});
+    for (int v = 0; v < verticle_tile_count; v++)
+    {
+        for (int h = 0; h < horizontal_tile_count; h++)
+        {
+            for (int channel = 0; channel < arch.channel_count; channel++)
+            {
+                run_bitmap(v, h, channel) = tiles.column_active(h, channel);
+            }
+        }
+    }
+
+    // cout << run_bitmap << endl;
+
+    auto schedule = arch.mapping.tile_schedule(verticle_tile_count, horizontal_tile_count);
+    if (arch.ifmap_ring_length)
+    {
+        arch.ifmap_ring_channels.assign(arch.channel_count, vector<int>());
+    }
+    int ag_idx = 0;
+    for (auto &ag : arch.ifmap_mem.generators)
+    {
+        std::deque<Descriptor_2D> program;
+        auto systolic_delay = Descriptor_2D::delay_inst(ag_idx + arch.weight_preload_cycles);
+        program.push_back(systolic_delay);
+        for (auto &tile : schedule)
+        {
+            int v = tile.first;
+            int h = tile.second;
+            int active = run_bitmap(v, h, ag_idx);
+            int stream_size = ifmap_h * ifmap_w;
+            // column ag_idx of horizontal tile h carries ifmap channel h * channel_tile + ag_idx
+            int stream_start_idx = arch.ifmap_layout.base(h * arch.mapping.channel_tile + ag_idx, stream_size);
+
+            if (active && arch.ifmap_ring_length)
+            {
+                // the stream picks up in the ring where the last one left off
+                auto &ring_channels = arch.ifmap_ring_channels[ag_idx];
+                int ring_base = ag_idx * arch.ifmap_ring_length;
+                int ring_start = ring_base + (ring_channels.size() * stream_size) % arch.ifmap_ring_length;
+                ring_channels.push_back(h * arch.mapping.channel_tile + ag_idx);
+                program.push_back(Descriptor_2D::ring_stream_inst(ring_start, stream_size - 1, ring_base, arch.ifmap_ring_length));
+            }
+            else if (active)
+            {
+                auto stream_inst = Descriptor_2D::stream_inst(stream_start_idx, stream_size - 1, 0, arch.ifmap_layout.stride(arch.ifmap_channels));
+                program.push_back(stream_inst);
+            }
+            else
+            {
+                auto delay_inst = Descriptor_2D::delay_inst(stream_size - 1);
+                program.push_back(delay_inst);
+            }
+        }
+        program.push_back(Descriptor_2D::suspend_inst());
+        vector<Descriptor_2D> prog_vec(program.begin(), program.end());
+        Descriptor_2D::make_sequential(prog_vec);
+        ag.loadProgram(prog_vec);
+        ag_idx++;
+    }
+}
+
+template <typename DataType>
+void load_ifmap_rings(Arch<DataType> &arch, const xt::xarray<int> &ifmap)
+{
+    int ifmap_w = ifmap.shape(2);
+    int plane = ifmap.shape(1) * ifmap_w;
+    arch.ifmap_ring_feed.assign(arch.channel_count, vector<int>());
+    arch.ifmap_ring_reads.assign(arch.channel_count, 0);
+    for (int column = 0; column < arch.channel_count; column++)
+    {
+        auto &feed = arch.ifmap_ring_feed[column];
+        for (int c : arch.ifmap_ring_channels[column])
+        {
+            for (int element = 0; element < plane; element++)
+            {
+                feed.push_back(ifmap(c, element / ifmap_w, element % ifmap_w));
+            }
+        }
+        for (int slot = 0; slot < std::min(arch.ifmap_ring_length, (int)feed.size()); slot++)
+        {
+            arch.ifmap_mem.mem.ram.at(column * arch.ifmap_ring_length + slot).at(0).write(feed[slot]);
+            arch.dram_access_counter++;
+            arch.ifmap_mem.mem.access_counter++;
+        }
+    }
+    sc_start(1, SC_NS);
+    cout << "Preloaded ifmap line buffers" << endl;
+}
+
+template <typename DataType>
+WeightTiles weight_tiles(Arch<DataType> &arch, const xt::xarray<int> &weights)
+{
+    int filter_out_dim = weights.shape(0);
+    int channel_in_dim = weights.shape(1);
+    int kernel_size = weights.shape(2) * weights.shape(3);
+
+    // the array was built with the logical dims of the mapping so both
+    // orientations unroll the same way from here on
+    arch.ifmap_channels = channel_in_dim;
+    arch.ofmap_channels = filter_out_dim;
+    return WeightTiles(filter_out_dim, channel_in_dim * kernel_size, arch.mapping);
+}
+
+template <typename DataType>
+WeightTiles load_weights(Arch<DataType> &arch, xt::xarray<int> weights)
+{
+    WeightTiles tiles = weight_tiles(arch, weights);
+    int filter_out_dim = weights.shape(0);
+    int reduction = weights.size() / filter_out_dim;
+    weights.reshape({filter_out_dim, reduction});
+    const Mapping &mapping = arch.mapping;
+
+    auto packed = pack_weights(weights.data(), filter_out_dim, reduction, mapping, arch.filter_count, arch.channel_count, arch.weight_config.delivery, arch.weight_channel_count);
+    if (packed.words * packed.lanes > arch.weight_mem_size)
+    {
+        throw std::invalid_argument("packed weights don't fit the weight SAM");
+    }
+    arch.weight_region_base = packed.region_base;
+    arch.weight_image = packed;
+    for (int addr = 0; addr < packed.words; addr++)
+    {
+        const int *word = packed.word(addr);
+        auto &row = arch.weight_mem.mem.ram.at(addr);
+        for (int lane = 0; lane < packed.lanes; lane++)
+        {
+            row[lane].write(word[lane]);
+        }
+        arch.dram_access_counter += packed.lanes;
+        arch.weight_dram_access_counter += packed.lanes;
+        arch.weight_mem.mem.access_counter++;
+    }
+
+    // the registers are refilled from the SAM by the weight program
+    for (auto &pe : arch.pe_array)
+    {
+        pe.resetWeights();
+    }
+
+    return tiles;
+}
+
+template <typename DataType>
+tuple<xt::xarray<int>, WeightTiles> generate_and_load_weights(Arch<DataType> &arch, int filter_out_dim, int channel_in_dim, int kernel)
+{
+    xt::xarray<int> weights = generate_weights(filter_out_dim, channel_in_dim, kernel);
+    WeightTiles tiles = load_weights(arch, weights);
+    return std::make_tuple(weights, tiles);
+}
+
+template <typename DataType>
+int count_stream_runs(sc_vector<AddressGenerator<DataType>> &generators)
+{
+    int runs = 0;
+    for (auto &gen : generators)
+    {
+        for (auto &desc : gen.descriptors)
+        {
+            if (desc.state == DescriptorState::GENERATE)
+            {
+                runs += (desc.x_modify == 1) ? desc.y_count + 1 : (desc.x_count + 1) * (desc.y_count + 1);
+            }
+        }
+    }
+    return runs;
+}
+
+template <typename DataType>
+void print_program_optimization(Arch<DataType> &arch)
+{
+    int descriptors = 0;
+    int optimized = 0;
+    long int cycles_saved = 0;
+    for (auto *sam : {&arch.ifmap_mem, &arch.psum_mem, &arch.weight_mem})
+    {
+        for (auto &gen : sam->generators)
+        {
+            auto compiled = optimize_program(gen.descriptors);
+            descriptors += compiled.reports.front().descriptors;
+            optimized += compiled.reports.back().descriptors;
+            cycles_saved = std::max(cycles_saved, compiled.cycles_saved());
+        }
+    }
+    cout << std::left << std::setw(20) << "Descriptors" << descriptors << " -> " << optimized << endl;
+    cout << std::left << std::setw(20) << "Bubbles Removable" << cycles_saved << endl;
+}
+
+template <typename DataType>
+void partition_global_buffer(Arch<DataType> &arch, GlobalBuffer &buffer, int ifmap_words, int psum_words, int weight_words)
+{
+    buffer.allocate(ifmap_words, arch.channel_count, psum_words, arch.filter_count * 2, weight_words, arch.weight_channel_count);
+    for (auto &ag : arch.ifmap_mem.generators)
+    {
+        buffer.verify(BufferRegion::IFMAP, ag.descriptors);
+    }
+    for (auto &ag : arch.psum_mem.generators)
+    {
+        buffer.verify(BufferRegion::PSUM, ag.descriptors);
+    }
+    for (auto &ag : arch.weight_mem.generators)
+    {
+        buffer.verify(BufferRegion::WEIGHT, ag.descriptors, arch.weight_lanes());
+    }
+}
+
+template <typename DataType>
+void print_compression(Arch<DataType> &arch)
+{
+    cout << std::left << std::setw(20) << "Compression" << compression_format_to_string(arch.ifmap_compression) << endl;
+    cout << std::left << std::setw(20) << "Ifmap Words Stored" << arch.ifmap_stored_words << " of " << arch.ifmap_dense_words << endl;
+    cout << std::left << std::setw(20) << "Ifmap Compression" << std::setprecision(2) << (double)arch.ifmap_dense_words / std::max(arch.ifmap_stored_words, 1L) << "x" << endl;
+}
+
+template <typename DataType>
+void print_memory_hierarchy(MemoryHierarchy<DataType> &hierarchy)
+{
+    cout << std::left << std::setw(20) << "Transfer Cycles" << hierarchy.cycle_counter << endl;
+    for (unsigned int level = 0; level < hierarchy.configs.size(); level++)
+    {
+        auto &config = hierarchy.configs[level];
+        std::stringstream label;
+        label << "Level " << level << " Access";
+        cout << std::left << std::setw(20) << label.str() << hierarchy.levels[level].mem.access_counter << " (" << config.length << "x" << config.width << ", latency " << config.latency << ")"
+             << ", lines in " << hierarchy.write_lines[level] << " out " << hierarchy.read_lines[level] << ", util in " << std::setprecision(2) << hierarchy.write_utilization(level) << " out " << hierarchy.read_utilization(level) << endl;
+    }
+}
+
+template <typename DataType>
+void print_reuse(const string &label, SAM<DataType> &sam, const vector<unsigned int> &trace, double hit_rate, int window)
+{
+    vector<vector<unsigned int>> streams;
+    for (auto &gen : sam.generators)
+    {
+        streams.push_back(expand_program(gen.descriptors));
+    }
+    ReuseProfile expanded(interleave_streams(streams), window);
+    ReuseProfile profile(trace, window);
+    long int min_size = profile.min_buffer_size(hit_rate);
+
+    cout << std::left << std::setw(20) << label + " Reuse" << profile.accesses << " accesses (" << expanded.accesses << " expanded), footprint " << profile.footprint << " of " << sam.mem.length << " lines" << endl;
+    cout << std::left << std::setw(20) << "  Max Hit Rate" << std::setprecision(3) << profile.max_hit_rate() << ", at capacity " << profile.hit_rate(sam.mem.length) << endl;
+    cout << std::left << std::setw(20) << "  Min Size" << ((min_size < 0) ? string("unreachable") : std::to_string(min_size)) << " lines for hit rate " << hit_rate << endl;
+    cout << std::left << std::setw(20) << "  Working Set" << "peak " << profile.peak_working_set() << " per " << window << " accesses" << endl;
+    cout << std::left << std::setw(20) << "  Distance Hist";
+    auto histogram = profile.log2_histogram();
+    for (unsigned int bin = 0; bin < histogram.size(); bin++)
+    {
+        cout << ((bin) ? " " : "") << "<" << (1UL << bin) << ":" << histogram[bin];
+    }
+    cout << endl;
+}
+
+void print_global_buffer(const string &label, const GlobalBuffer &buffer)
+{
+    cout << std::left << std::setw(20) << label << buffer.region(BufferRegion::IFMAP).words << " ifmap " << buffer.region(BufferRegion::PSUM).words << " psum " << buffer.region(BufferRegion::WEIGHT).words << " weight of " << buffer.capacity
+         << ", " << buffer.used_channels() << " of " << buffer.channel_pool << " channels, util " << std::setprecision(2) << buffer.utilization() << endl;
+}
+
+template <typename DataType>
+void arm_watchdog(Arch<DataType> &arch, const WatchdogConfig &config, long int estimated_cycles)
+{
+    arch.watchdog.reset();
+    arch.watchdog.cycle_budget = (config.max_cycles) ? config.max_cycles : (config.cycle_margin > 0.0) ? cycle_budget_from_estimate(estimated_cycles, config.cycle_margin) : 0;
+    arch.watchdog.stall_limit = config.stall_cycles;
+}
+
+template <typename DataType>
+bool watchdog_stopped(const Arch<DataType> &arch)
+{
+    if (!arch.hung)
+    {
+        return false;
+    }
+    cout << "error: watchdog stopped the run, " << arch.watchdog.reason() << endl;
+    cout << "FAIL" << endl;
+    return true;
+}
+
+template void set_channel_modes<sc_int<32>>(Arch<sc_int<32>> &arch);
+template int store_compressed_ifmap<sc_int<32>>(Arch<sc_int<32>> &arch, const xt::xarray<int> &planes);
+template xt::xarray<int> stage_ifmap<sc_int<32>>(Arch<sc_int<32>> &arch, MemoryHierarchy<sc_int<32>> &hierarchy, int channel_in, int ifmap_h, int ifmap_w);
+template xt::xarray<int> dram_load<sc_int<32>>(Arch<sc_int<32>> &arch, int channel_in, int ifmap_h, int ifmap_w);
+template xt::xarray<int> dram_store<sc_int<32>>(Arch<sc_int<32>> &arch, int filter_out, int ofmap_h, int ofmap_w, int filter_stride);
+template void dram_load_strip<sc_int<32>>(Arch<sc_int<32>> &arch, xt::xarray<int> ifmap, int row_start, int row_count);
+template void onchip_transfer<sc_int<32>>(Arch<sc_int<32>> &arch, int channels, int ofmap_h, int ofmap_w, int filter_stride);
+template void generate_and_load_weight_program<sc_int<32>>(Arch<sc_int<32>> &arch, int tile_count, int ifmap_h, int ifmap_w);
+template void generate_and_load_pe_program<sc_int<32>>(Arch<sc_int<32>> &arch, const WeightTiles &tiles, int ifmap_h, int ifmap_w);
+template void generate_and_load_psum_program<sc_int<32>>(Arch<sc_int<32>> &arch, const WeightTiles &tiles, int ofmap_h, int ofmap_w);
+template void generate_and_load_post_processors<sc_int<32>>(Arch<sc_int<32>> &arch, const WeightTiles &tiles, xt::xarray<int> biases, int ofmap_h, int ofmap_w, const PostProcessConfig &config);
+template void generate_and_load_ifmap_in_program<sc_int<32>>(Arch<sc_int<32>> &arch, const WeightTiles &tiles, int ifmap_h, int ifmap_w);
+template void load_ifmap_rings<sc_int<32>>(Arch<sc_int<32>> &arch, const xt::xarray<int> &ifmap);
+template WeightTiles weight_tiles<sc_int<32>>(Arch<sc_int<32>> &arch, const xt::xarray<int> &weights);
+template WeightTiles load_weights<sc_int<32>>(Arch<sc_int<32>> &arch, xt::xarray<int> weights);
+template tuple<xt::xarray<int>, WeightTiles> generate_and_load_weights<sc_int<32>>(Arch<sc_int<32>> &arch, int filter_out_dim, int channel_in_dim, int kernel);
+template int count_stream_runs<sc_int<32>>(sc_vector<AddressGenerator<sc_int<32>>> &generators);
+template void print_program_optimization<sc_int<32>>(Arch<sc_int<32>> &arch);
+template void partition_global_buffer<sc_int<32>>(Arch<sc_int<32>> &arch, GlobalBuffer &buffer, int ifmap_words, int psum_words, int weight_words);
+template void print_compression<sc_int<32>>(Arch<sc_int<32>> &arch);
+template void print_memory_hierarchy<sc_int<32>>(MemoryHierarchy<sc_int<32>> &hierarchy);
+template void print_reuse<sc_int<32>>(const string &label, SAM<sc_int<32>> &sam, const vector<unsigned int> &trace, double hit_rate, int window);
+template void arm_watchdog<sc_int<32>>(Arch<sc_int<32>> &arch, const WatchdogConfig &config, long int estimated_cycles);
+template bool watchdog_stopped<sc_int<32>>(const Arch<sc_int<32>> &arch);
@@ -0,0 +1,127 @@
+#include "ArchImage.hh"
+#include <stdexcept>
+
+template <typename DataType>
+ProgramImage capture_program_image(Arch<DataType> &arch, const LayerShape &layer)
+{
+    ProgramImage image;
+    image.filter_count = arch.filter_count;
+    image.channel_count = arch.channel_count;
+    image.weight_channel_count = arch.weight_channel_count;
+    image.weight_lanes = arch.weight_image.lanes;
+    image.layer = layer;
+    image.weight_preload_cycles = arch.weight_preload_cycles;
+    vector<pair<ProgramTarget, SAM<DataType> *>> sams = {{ProgramTarget::IFMAP_GENERATOR, &arch.ifmap_mem}, {ProgramTarget::PSUM_GENERATOR, &arch.psum_mem}, {ProgramTarget::WEIGHT_GENERATOR, &arch.weight_mem}};
+    for (auto &sam : sams)
+    {
+        unsigned int idx = 0;
+        for (auto &gen : sam.second->generators)
+        {
+            image.programs.push_back({sam.first, idx++, gen.descriptors});
+        }
+    }
+    for (unsigned int idx = 0; idx < arch.pe_array.size(); idx++)
+    {
+        image.programs.push_back({ProgramTarget::PE, idx, arch.pe_array[idx].program});
+    }
+    image.weight_region_base.assign(arch.weight_region_base.begin(), arch.weight_region_base.end());
+    image.weight_words = arch.weight_image.words;
+    image.weights = arch.weight_image.data;
+    return image;
+}
+
+template <typename DataType>
+void load_image_program(Arch<DataType> &arch, ProgramTarget target, unsigned int idx, vector<Descriptor_2D> &program)
+{
+    if (target == ProgramTarget::PE)
+    {
+        if (idx >= arch.pe_array.size())
+        {
+            throw std::invalid_argument("program image names PE " + std::to_string(idx) + " of " + std::to_string(arch.pe_array.size()));
+        }
+        arch.pe_array[idx].loadProgram(program);
+        return;
+    }
+    vector<SAM<DataType> *> sams = {&arch.ifmap_mem, &arch.psum_mem, &arch.weight_mem};
+    auto &generators = sams.at((unsigned int)target)->generators;
+    if (idx >= generators.size())
+    {
+        throw std::invalid_argument("program image names generator " + std::to_string(idx) + " of " + std::to_string(generators.size()));
+    }
+    generators[idx].loadProgram(program);
+}
+
+template <typename DataType>
+void apply_program_image(Arch<DataType> &arch, const ProgramImageView &image, const LayerShape &layer)
+{
+    if (image.filter_count != (unsigned int)arch.filter_count || image.channel_count != (unsigned int)arch.channel_count ||
+        image.weight_channel_count != (unsigned int)arch.weight_channel_count || image.weight_lanes != (unsigned int)arch.weight_lanes() ||
+        image.layer.c_in != layer.c_in || image.layer.f_out != layer.f_out || image.layer.k != layer.k || image.layer.ofmap_h != layer.ofmap_h || image.layer.ofmap_w != layer.ofmap_w)
+    {
+        throw std::invalid_argument("program image was built for a different array or layer");
+    }
+    if (image.weight_words > arch.weight_mem.mem.ram.size())
+    {
+        throw std::invalid_argument("program image weights don't fit the weight SAM");
+    }
+
+    for (unsigned int channel = 0; channel < image.weight_channel_count; channel++)
+    {
+        arch.weight_region_base.at(channel) = image.region_base(channel);
+    }
+    for (unsigned int addr = 0; addr < image.weight_words; addr++)
+    {
+        auto &row = arch.weight_mem.mem.ram.at(addr);
+        for (unsigned int lane = 0; lane < image.weight_lanes; lane++)
+        {
+            row[lane].write(image.weight(addr, lane));
+        }
+        arch.dram_access_counter += image.weight_lanes;
+        arch.weight_dram_access_counter += image.weight_lanes;
+        arch.weight_mem.mem.access_counter++;
+    }
+    for (auto &pe : arch.pe_array)
+    {
+        pe.resetWeights();
+    }
+    arch.weight_preload_cycles = image.weight_preload_cycles;
+
+    for (unsigned int entry = 0; entry < image.program_count; entry++)
+    {
+        auto program = image.program(entry);
+        load_image_program(arch, image.target(entry), image.index(entry), program);
+    }
+}
+
+template <typename DataType>
+unsigned long int configure_over_bus(Arch<DataType> &arch, ControlRegisters &csr, DramPort &host, const LayerShape &layer, ConfigPath path)
+{
+    ProgramImage image = capture_program_image(arch, layer);
+    for (auto *sam : {&arch.ifmap_mem, &arch.psum_mem, &arch.weight_mem})
+    {
+        for (auto &gen : sam->generators)
+        {
+            gen.resetProgramMemory();
+        }
+    }
+    csr.load_program = [&arch](ProgramTarget target, unsigned int idx, vector<Descriptor_2D> &program) { load_image_program(arch, target, idx, program); };
+    csr.load_weight_line = [&arch](unsigned int addr, const vector<int> &line) {
+        auto &row = arch.weight_mem.mem.ram.at(addr);
+        for (unsigned int lane = 0; lane < line.size(); lane++)
+        {
+            row[lane].write(line[lane]);
+        }
+    };
+    csr.set_region_base = [&arch](unsigned int channel, unsigned int base) { arch.weight_region_base.at(channel) = base; };
+    csr.set_preload_cycles = [&arch](unsigned int cycles) { arch.weight_preload_cycles = cycles; };
+
+    sc_time start = host.local_time;
+    sc_time done = configure_from_image(host, 0, image, path);
+    sc_start(done - start);
+    return (done - start) / csr.cycle;
+}
+
+template ProgramImage capture_program_image<sc_int<32>>(Arch<sc_int<32>> &arch, const LayerShape &layer);
+template void load_image_program<sc_int<32>>(Arch<sc_int<32>> &arch, ProgramTarget target, unsigned int idx, vector<Descriptor_2D> &program);
+template void apply_program_image<sc_int<32>>(Arch<sc_int<32>> &arch, const ProgramImageView &image, const LayerShape &layer);
+template unsigned long int configure_over_bus<sc_int<32>>(Arch<sc_int<32>> &arch, ControlRegisters &csr, DramPort &host, const LayerShape &layer, ConfigPath path);
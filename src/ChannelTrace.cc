@@ -0,0 +1,234 @@
+#include "ChannelTrace.hh"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+using std::pair;
+
+ChannelTrace::ChannelTrace(unsigned int _channel_count, unsigned int _length, unsigned int _width)
+    : channel_count(_channel_count), length(_length), width(_width)
+{
+}
+
+void ChannelTrace::record(unsigned long int cycle, unsigned int channel, MemoryChannelMode mode, unsigned int addr)
+{
+    assert(channel < channel_count && (accesses.empty() || cycle >= accesses.back().cycle));
+    accesses.push_back({cycle, channel, mode, addr});
+}
+
+static void put_varint(vector<uint8_t>& image, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        image.push_back((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    image.push_back(value);
+}
+
+static uint64_t get_varint(const vector<uint8_t>& image, size_t& pos)
+{
+    uint64_t value = 0;
+    for (unsigned int shift = 0; shift < 64; shift += 7)
+    {
+        if (pos >= image.size())
+        {
+            throw std::runtime_error("channel trace truncated");
+        }
+        uint8_t byte = image[pos++];
+        value |= (uint64_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+        {
+            return value;
+        }
+    }
+    throw std::runtime_error("channel trace varint too long");
+}
+
+vector<uint8_t> ChannelTrace::encode() const
+{
+    vector<uint8_t> image(CHANNEL_TRACE_MAGIC, CHANNEL_TRACE_MAGIC + strlen(CHANNEL_TRACE_MAGIC));
+    image.push_back(CHANNEL_TRACE_VERSION);
+    put_varint(image, channel_count);
+    put_varint(image, length);
+    put_varint(image, width);
+    put_varint(image, accesses.size());
+
+    unsigned long int cycle = (accesses.empty()) ? 0 : accesses.front().cycle;
+    put_varint(image, cycle);
+    vector<long int> last_addr(channel_count, 0);
+    for (auto& access : accesses)
+    {
+        long int delta = (long int)access.addr - last_addr[access.channel];
+        put_varint(image, access.cycle - cycle);
+        put_varint(image, ((uint64_t)access.channel << 1) | ((access.mode == MemoryChannelMode::WRITE) ? 1 : 0));
+        put_varint(image, ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63));
+        cycle = access.cycle;
+        last_addr[access.channel] = access.addr;
+    }
+    return image;
+}
+
+ChannelTrace ChannelTrace::decode(const vector<uint8_t>& image)
+{
+    size_t magic_length = strlen(CHANNEL_TRACE_MAGIC);
+    if (image.size() <= magic_length || memcmp(image.data(), CHANNEL_TRACE_MAGIC, magic_length) != 0 || image[magic_length] != CHANNEL_TRACE_VERSION)
+    {
+        throw std::runtime_error("not a version " + std::to_string(CHANNEL_TRACE_VERSION) + " channel trace");
+    }
+    size_t pos = magic_length + 1;
+    unsigned int channel_count = get_varint(image, pos);
+    unsigned int length = get_varint(image, pos);
+    unsigned int width = get_varint(image, pos);
+    ChannelTrace trace(channel_count, length, width);
+    uint64_t count = get_varint(image, pos);
+    unsigned long int cycle = get_varint(image, pos);
+    vector<long int> last_addr(channel_count, 0);
+    for (uint64_t idx = 0; idx < count; idx++)
+    {
+        cycle += get_varint(image, pos);
+        uint64_t channel_mode = get_varint(image, pos);
+        uint64_t zigzag = get_varint(image, pos);
+        unsigned int channel = channel_mode >> 1;
+        if (channel >= channel_count)
+        {
+            throw std::runtime_error("channel trace record names channel " + std::to_string(channel) + " of " + std::to_string(channel_count));
+        }
+        long int addr = last_addr[channel] + (long int)((zigzag >> 1) ^ (~(zigzag & 1) + 1));
+        trace.record(cycle, channel, (channel_mode & 1) ? MemoryChannelMode::WRITE : MemoryChannelMode::READ, addr);
+        last_addr[channel] = addr;
+    }
+    return trace;
+}
+
+void ChannelTrace::save(const string& path) const
+{
+    auto image = encode();
+    std::ofstream file(path, std::ios::binary);
+    if (!file.write((const char*)image.data(), image.size()))
+    {
+        throw std::runtime_error("could not write channel trace " + path);
+    }
+}
+
+ChannelTrace ChannelTrace::load(const string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        throw std::runtime_error("could not open channel trace " + path);
+    }
+    vector<uint8_t> image((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return decode(image);
+}
+
+string ReplayConfig::to_string() const
+{
+    std::stringstream ss;
+    ss << banks << ":" << latency << ":" << width;
+    return ss.str();
+}
+
+vector<ReplayConfig> replay_configs_from_string(const string& configs)
+{
+    vector<ReplayConfig> parsed;
+    std::stringstream ss(configs);
+    string config;
+    while (std::getline(ss, config, ','))
+    {
+        ReplayConfig variant;
+        char sep_0 = 0, sep_1 = 0;
+        std::stringstream fields(config);
+        if (!(fields >> variant.banks >> sep_0 >> variant.latency >> sep_1 >> variant.width) || sep_0 != ':' || sep_1 != ':' || !fields.eof())
+        {
+            throw std::invalid_argument("replay variants must be comma separated banks:latency:width triples");
+        }
+        if (variant.banks == 0 || variant.width == 0)
+        {
+            throw std::invalid_argument("replay banks and widths must be positive");
+        }
+        parsed.push_back(variant);
+    }
+    if (parsed.empty())
+    {
+        throw std::invalid_argument("no replay variants given");
+    }
+    return parsed;
+}
+
+double ReplayResult::bank_utilization() const
+{
+    return (cycles) ? (double)line_accesses / ((double)cycles * config.banks) : 0.0;
+}
+
+ReplayResult replay_trace(const ChannelTrace& trace, const ReplayConfig& config)
+{
+    ReplayResult result{config, 0, 0, 0, 0, vector<unsigned long int>(config.banks, 0)};
+    if (trace.accesses.empty())
+    {
+        return result;
+    }
+    unsigned long int first_issue = trace.accesses.front().cycle;
+    unsigned long int last_done = first_issue;
+    size_t idx = 0;
+    while (idx < trace.accesses.size())
+    {
+        // every access recorded in one cycle, re-sliced to the variant's lines
+        unsigned long int cycle = trace.accesses[idx].cycle;
+        std::map<pair<unsigned long int, MemoryChannelMode>, unsigned int> lines;
+        for (; idx < trace.accesses.size() && trace.accesses[idx].cycle == cycle; idx++)
+        {
+            auto& access = trace.accesses[idx];
+            unsigned long int first_word = (unsigned long int)access.addr * trace.width;
+            unsigned long int last_word = first_word + trace.width - 1;
+            for (unsigned long int line = first_word / config.width; line <= last_word / config.width; line++)
+            {
+                lines[{line, access.mode}]++;
+            }
+        }
+        vector<unsigned int> bank_load(config.banks, 0);
+        for (auto& line : lines)
+        {
+            bank_load[line.first.first % config.banks]++;
+            result.bank_accesses[line.first.first % config.banks]++;
+        }
+        unsigned int occupancy = *std::max_element(bank_load.begin(), bank_load.end());
+        unsigned long int issue = cycle + result.stall_cycles;
+        result.line_accesses += lines.size();
+        result.conflict_cycles += (occupancy > 1) ? 1 : 0;
+        result.stall_cycles += occupancy - 1;
+        last_done = std::max(last_done, issue + occupancy + config.latency);
+    }
+    result.cycles = last_done - first_issue;
+    return result;
+}
+
+vector<ReplayResult> replay_variants(const ChannelTrace& trace, const vector<ReplayConfig>& configs, unsigned int threads)
+{
+    vector<ReplayResult> results(configs.size());
+    std::atomic<size_t> next_config(0);
+    auto worker = [&]() {
+        for (size_t idx = next_config++; idx < configs.size(); idx = next_config++)
+        {
+            results[idx] = replay_trace(trace, configs[idx]);
+        }
+    };
+    vector<std::thread> workers;
+    for (unsigned int thread = 1; thread < std::max(threads, 1U); thread++)
+    {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : workers)
+    {
+        thread.join();
+    }
+    return results;
+}
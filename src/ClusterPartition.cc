@@ -0,0 +1,44 @@
+#include "ClusterPartition.hh"
+#include <algorithm>
+#include <stdexcept>
+
+ClusterPartition cluster_partition_from_string(const string &partition)
+{
+    if (partition == "filters")
+    {
+        return ClusterPartition::FILTERS;
+    }
+    else if (partition == "rows")
+    {
+        return ClusterPartition::ROWS;
+    }
+    throw std::invalid_argument("partition must be one of filters or rows");
+}
+
+vector<ClusterWork> partition_cluster_work(ClusterPartition partition, int cluster_count, int f_out, int ofmap_h, int row_alignment)
+{
+    vector<ClusterWork> work;
+    int units = (partition == ClusterPartition::FILTERS) ? f_out : ofmap_h / row_alignment;
+    if (units < cluster_count)
+    {
+        throw std::invalid_argument("layer too small to give every cluster work");
+    }
+    int start = 0;
+    for (int cluster = 0; cluster < cluster_count; cluster++)
+    {
+        int share = units / cluster_count + (cluster < units % cluster_count);
+        if (partition == ClusterPartition::FILTERS)
+        {
+            work.push_back({start, share, 0, ofmap_h});
+        }
+        else
+        {
+            // any rows left over by the alignment go to the last band
+            int rows = (cluster == cluster_count - 1) ? ofmap_h - start : share * row_alignment;
+            work.push_back({0, f_out, start, rows});
+            share = rows;
+        }
+        start += share;
+    }
+    return work;
+}
@@ -0,0 +1,216 @@
+#include "ControlRegisters.hh"
+#include <assert.h>
+#include <cstring>
+#include <stdexcept>
+
+ConfigPath config_path_from_string(const string& path)
+{
+    if (path == "direct")
+    {
+        return ConfigPath::DIRECT;
+    }
+    if (path == "registers")
+    {
+        return ConfigPath::REGISTERS;
+    }
+    if (path == "dma")
+    {
+        return ConfigPath::DMA;
+    }
+    throw std::invalid_argument("unknown config path " + path + ", expected direct, registers or dma");
+}
+
+ControlRegisters::ControlRegisters(sc_module_name name, sc_time _cycle, const CsrTiming& _timing)
+    : sc_module(name),
+      socket("socket"),
+      cycle(_cycle),
+      timing(_timing)
+{
+    assert(timing.bytes_per_cycle > 0);
+    socket.register_b_transport(this, &ControlRegisters::b_transport);
+    this->reset();
+}
+
+void ControlRegisters::reset()
+{
+    program_select = 0;
+    weight_lanes = 0;
+    weight_addr = 0;
+    region_select = 0;
+    committed = 0;
+    staged_descriptor_words.clear();
+    staged_weight_line.clear();
+    register_accesses = 0;
+    burst_accesses = 0;
+    byte_counter = 0;
+    busy_time = SC_ZERO_TIME;
+}
+
+void ControlRegisters::b_transport(tlm::tlm_generic_payload& trans, sc_time& delay)
+{
+    sc_dt::uint64 addr = trans.get_address();
+    unsigned int length = trans.get_data_length();
+    if (length == 0 || length % 4 || trans.get_byte_enable_ptr())
+    {
+        trans.set_response_status(tlm::TLM_BURST_ERROR_RESPONSE);
+        return;
+    }
+    if (addr % 4 || addr >= CSR_SIZE)
+    {
+        trans.set_response_status(tlm::TLM_ADDRESS_ERROR_RESPONSE);
+        return;
+    }
+
+    sc_time occupancy = (length == 4) ? cycle * timing.register_cycles : cycle * (timing.burst_setup_cycles + (length + timing.bytes_per_cycle - 1) / timing.bytes_per_cycle);
+    register_accesses += (length == 4);
+    burst_accesses += (length > 4);
+    byte_counter += length;
+    busy_time += occupancy;
+    delay += occupancy;
+
+    // word aligned copies, the data pointer carries no alignment guarantee
+    vector<uint32_t> words(length / 4);
+    if (trans.is_read())
+    {
+        if (length != 4 || (addr != CSR_ID && addr != CSR_STATUS))
+        {
+            trans.set_response_status(tlm::TLM_COMMAND_ERROR_RESPONSE);
+            return;
+        }
+        words[0] = (addr == CSR_ID) ? CSR_ID_VALUE : committed;
+        memcpy(trans.get_data_ptr(), words.data(), length);
+        trans.set_response_status(tlm::TLM_OK_RESPONSE);
+        return;
+    }
+    if (!trans.is_write())
+    {
+        trans.set_response_status(tlm::TLM_COMMAND_ERROR_RESPONSE);
+        return;
+    }
+    memcpy(words.data(), trans.get_data_ptr(), length);
+    trans.set_response_status(this->write(addr, words.data(), words.size()));
+}
+
+tlm::tlm_response_status ControlRegisters::write(sc_dt::uint64 addr, const uint32_t* words, unsigned int count)
+{
+    bool fifo = addr == CSR_DESCRIPTOR_FIFO || addr == CSR_WEIGHT_FIFO;
+    if (count > 1 && !fifo)
+    {
+        return tlm::TLM_BURST_ERROR_RESPONSE;
+    }
+    switch (addr)
+    {
+    case CSR_PROGRAM_SELECT:
+        program_select = words[0];
+        staged_descriptor_words.clear();
+        return tlm::TLM_OK_RESPONSE;
+    case CSR_PROGRAM_COMMIT:
+    {
+        ProgramTarget target = (ProgramTarget)(program_select >> 24);
+        if (staged_descriptor_words.size() % PROGRAM_IMAGE_DESCRIPTOR_WORDS || target > ProgramTarget::PE || !load_program)
+        {
+            return tlm::TLM_GENERIC_ERROR_RESPONSE;
+        }
+        vector<Descriptor_2D> program;
+        for (unsigned int word = 0; word < staged_descriptor_words.size(); word += PROGRAM_IMAGE_DESCRIPTOR_WORDS)
+        {
+            program.push_back(decode_descriptor(&staged_descriptor_words[word]));
+        }
+        load_program(target, program_select & 0xffffff, program);
+        staged_descriptor_words.clear();
+        committed++;
+        return tlm::TLM_OK_RESPONSE;
+    }
+    case CSR_DESCRIPTOR_FIFO:
+        staged_descriptor_words.insert(staged_descriptor_words.end(), words, words + count);
+        return tlm::TLM_OK_RESPONSE;
+    case CSR_WEIGHT_LANES:
+        weight_lanes = words[0];
+        staged_weight_line.clear();
+        return tlm::TLM_OK_RESPONSE;
+    case CSR_WEIGHT_ADDR:
+        weight_addr = words[0];
+        staged_weight_line.clear();
+        return tlm::TLM_OK_RESPONSE;
+    case CSR_WEIGHT_FIFO:
+        if (weight_lanes == 0 || !load_weight_line)
+        {
+            return tlm::TLM_GENERIC_ERROR_RESPONSE;
+        }
+        for (unsigned int word = 0; word < count; word++)
+        {
+            staged_weight_line.push_back((int)words[word]);
+            if (staged_weight_line.size() == weight_lanes)
+            {
+                load_weight_line(weight_addr++, staged_weight_line);
+                staged_weight_line.clear();
+            }
+        }
+        return tlm::TLM_OK_RESPONSE;
+    case CSR_REGION_SELECT:
+        region_select = words[0];
+        return tlm::TLM_OK_RESPONSE;
+    case CSR_REGION_BASE:
+        if (!set_region_base)
+        {
+            return tlm::TLM_GENERIC_ERROR_RESPONSE;
+        }
+        set_region_base(region_select, words[0]);
+        return tlm::TLM_OK_RESPONSE;
+    case CSR_PRELOAD_CYCLES:
+        if (!set_preload_cycles)
+        {
+            return tlm::TLM_GENERIC_ERROR_RESPONSE;
+        }
+        set_preload_cycles(words[0]);
+        return tlm::TLM_OK_RESPONSE;
+    default:
+        // ID and STATUS
+        return tlm::TLM_COMMAND_ERROR_RESPONSE;
+    }
+}
+
+sc_time configure_from_image(DramPort& host, sc_dt::uint64 base, const ProgramImage& image, ConfigPath path)
+{
+    assert(path != ConfigPath::DIRECT);
+    auto write = [&](sc_dt::uint64 offset, vector<uint32_t> words) {
+        if (words.empty())
+        {
+            return;
+        }
+        if (path == ConfigPath::DMA || words.size() == 1)
+        {
+            host.transfer(tlm::TLM_WRITE_COMMAND, base + offset, (unsigned char*)words.data(), words.size() * 4);
+            return;
+        }
+        for (auto& word : words)
+        {
+            host.transfer(tlm::TLM_WRITE_COMMAND, base + offset, (unsigned char*)&word, 4);
+        }
+    };
+
+    write(CSR_WEIGHT_LANES, {image.weight_lanes});
+    write(CSR_PRELOAD_CYCLES, {image.weight_preload_cycles});
+    for (unsigned int channel = 0; channel < image.weight_region_base.size(); channel++)
+    {
+        write(CSR_REGION_SELECT, {channel});
+        write(CSR_REGION_BASE, {(uint32_t)image.weight_region_base[channel]});
+    }
+    for (auto& entry : image.programs)
+    {
+        write(CSR_PROGRAM_SELECT, {((uint32_t)entry.target << 24) | entry.index});
+        vector<uint32_t> words(entry.program.size() * PROGRAM_IMAGE_DESCRIPTOR_WORDS);
+        for (unsigned int idx = 0; idx < entry.program.size(); idx++)
+        {
+            encode_descriptor(entry.program[idx], &words[idx * PROGRAM_IMAGE_DESCRIPTOR_WORDS]);
+        }
+        write(CSR_DESCRIPTOR_FIFO, words);
+        write(CSR_PROGRAM_COMMIT, {1});
+    }
+    if (!image.weights.empty())
+    {
+        write(CSR_WEIGHT_ADDR, {0});
+        write(CSR_WEIGHT_FIFO, vector<uint32_t>(image.weights.begin(), image.weights.end()));
+    }
+    return host.local_time;
+}
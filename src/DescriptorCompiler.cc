@@ -0,0 +1,262 @@
+#include "DescriptorCompiler.hh"
+#include <stdexcept>
+
+AccessPattern AccessPattern::slice(const vector<int>& shape, const vector<int>& offset, const vector<int>& extent)
+{
+    if (shape.empty() || shape.size() != offset.size() || shape.size() != extent.size())
+    {
+        throw std::invalid_argument("slice needs an offset and extent per tensor dim");
+    }
+    AccessPattern pattern{0, vector<AccessLoop>(shape.size()), 0};
+    long int stride = 1;
+    long int base = 0;
+    for (int dim = shape.size() - 1; dim >= 0; dim--)
+    {
+        if (extent[dim] <= 0 || offset[dim] < 0 || offset[dim] + extent[dim] > shape[dim])
+        {
+            throw std::invalid_argument("slice must lie within the tensor");
+        }
+        pattern.loops[dim] = {extent[dim], (int)stride};
+        base += offset[dim] * stride;
+        stride *= shape[dim];
+    }
+    pattern.base = base;
+    return pattern;
+}
+
+AccessPattern AccessPattern::repeated(int count, int stride) const
+{
+    AccessPattern pattern = *this;
+    pattern.loops.insert(pattern.loops.begin(), {count, stride});
+    return pattern;
+}
+
+long int AccessPattern::addresses() const
+{
+    long int count = 1;
+    for (auto& loop : loops)
+    {
+        count *= loop.count;
+    }
+    return count;
+}
+
+long int descriptor_cycles(const Descriptor_2D& desc)
+{
+    switch (desc.state)
+    {
+    case DescriptorState::GENERATE:
+    case DescriptorState::WAIT:
+        return ((long int)desc.x_count + 1) * ((long int)desc.y_count + 1) + 1;
+    case DescriptorState::SUSPENDED:
+        return 0;
+    default:
+        return -1;
+    }
+}
+
+long int program_cycles(const vector<Descriptor_2D>& program)
+{
+    long int cycles = 0;
+    unsigned int idx = 0;
+    for (unsigned int step = 0; step <= program.size(); step++)
+    {
+        auto& desc = program.at(idx);
+        if (desc.state == DescriptorState::SUSPENDED)
+        {
+            return cycles;
+        }
+        long int desc_cycles = descriptor_cycles(desc);
+        if (desc_cycles < 0)
+        {
+            return -1;
+        }
+        cycles += desc_cycles;
+        idx = desc.next;
+    }
+    // the program loops without ever suspending
+    return -1;
+}
+
+vector<Descriptor_2D> lower_access_pattern(const AccessPattern& pattern, bool hoist)
+{
+    if (pattern.loops.empty() || pattern.gap < 0 || pattern.gap == 1)
+    {
+        throw std::invalid_argument("patterns need a loop and gaps of 0 or at least 2 cycles");
+    }
+    for (auto& loop : pattern.loops)
+    {
+        if (loop.count <= 0)
+        {
+            throw std::invalid_argument("loop counts must be positive");
+        }
+    }
+    auto& inner = pattern.loops.back();
+    int outer_loops = pattern.loops.size() - 1;
+    int rows = 1;
+    if (hoist && outer_loops > 0 && pattern.loops[outer_loops - 1].stride == 0 && pattern.gap == 0)
+    {
+        rows = pattern.loops[--outer_loops].count;
+    }
+
+    vector<Descriptor_2D> program;
+    vector<int> idx(outer_loops, 0);
+    while (true)
+    {
+        long int start = pattern.base;
+        for (int loop = 0; loop < outer_loops; loop++)
+        {
+            start += (long int)idx[loop] * pattern.loops[loop].stride;
+        }
+        if (start < 0 || start + (long int)(inner.count - 1) * inner.stride < 0)
+        {
+            throw std::invalid_argument("pattern reaches below address 0");
+        }
+        if (pattern.gap && !program.empty())
+        {
+            program.push_back(Descriptor_2D::delay_inst(pattern.gap - 2));
+        }
+        program.push_back(Descriptor_2D(0, start, DescriptorState::GENERATE, inner.count - 1, inner.stride, rows - 1, -(inner.count - 1) * inner.stride));
+
+        int loop = outer_loops - 1;
+        while (loop >= 0 && ++idx[loop] == pattern.loops[loop].count)
+        {
+            idx[loop--] = 0;
+        }
+        if (loop < 0)
+        {
+            break;
+        }
+    }
+    program.push_back(Descriptor_2D::suspend_inst());
+    Descriptor_2D::make_sequential(program);
+    return program;
+}
+
+static bool sequential(const vector<Descriptor_2D>& program)
+{
+    for (unsigned int idx = 0; idx + 1 < program.size(); idx++)
+    {
+        if (program[idx].next != idx + 1)
+        {
+            return false;
+        }
+    }
+    return !program.empty();
+}
+
+// y_modify that makes b's first row follow a's last one, if a and b agree
+static bool continues(const Descriptor_2D& a, const Descriptor_2D& b, int& y_modify)
+{
+    if (a.state != DescriptorState::GENERATE || b.state != DescriptorState::GENERATE || a.modulo_length || b.modulo_length || a.repeat || b.repeat)
+    {
+        return false;
+    }
+    if (a.x_count != b.x_count || a.x_modify != b.x_modify)
+    {
+        return false;
+    }
+    long int row_span = (long int)a.x_count * a.x_modify;
+    long int a_last = (long int)a.start + (long int)a.y_count * (row_span + a.y_modify) + row_span;
+    long int step = (long int)b.start - a_last;
+    if ((a.y_count && a.y_modify != step) || (b.y_count && b.y_modify != step))
+    {
+        return false;
+    }
+    y_modify = step;
+    return true;
+}
+
+vector<Descriptor_2D> merge_streams(const vector<Descriptor_2D>& program)
+{
+    if (!sequential(program))
+    {
+        return program;
+    }
+    vector<Descriptor_2D> merged;
+    for (auto& desc : program)
+    {
+        int y_modify = 0;
+        if (!merged.empty() && continues(merged.back(), desc, y_modify))
+        {
+            auto& last = merged.back();
+            last.y_count_update(last.y_count + desc.y_count + 1);
+            last.y_modify = y_modify;
+        }
+        else
+        {
+            merged.push_back(desc);
+        }
+    }
+    Descriptor_2D::make_sequential(merged);
+    return merged;
+}
+
+vector<Descriptor_2D> coalesce_delays(const vector<Descriptor_2D>& program)
+{
+    if (!sequential(program))
+    {
+        return program;
+    }
+    vector<Descriptor_2D> coalesced;
+    for (auto& desc : program)
+    {
+        if (!coalesced.empty() && desc.state == DescriptorState::WAIT && coalesced.back().state == DescriptorState::WAIT)
+        {
+            // a delay_inst(d) lasts d + 2 cycles
+            long int cycles = descriptor_cycles(coalesced.back()) + descriptor_cycles(desc);
+            coalesced.back() = Descriptor_2D::delay_inst(cycles - 2);
+        }
+        else
+        {
+            coalesced.push_back(desc);
+        }
+    }
+    Descriptor_2D::make_sequential(coalesced);
+    return coalesced;
+}
+
+int CompiledProgram::descriptors_saved() const
+{
+    return reports.front().descriptors - reports.back().descriptors;
+}
+
+long int CompiledProgram::cycles_saved() const
+{
+    if (reports.front().cycles < 0 || reports.back().cycles < 0)
+    {
+        return 0;
+    }
+    return reports.front().cycles - reports.back().cycles;
+}
+
+static void report(CompiledProgram& compiled, const string& pass)
+{
+    compiled.reports.push_back({pass, (int)compiled.program.size(), program_cycles(compiled.program)});
+}
+
+CompiledProgram compile_access_pattern(const AccessPattern& pattern)
+{
+    CompiledProgram compiled;
+    compiled.program = lower_access_pattern(pattern);
+    report(compiled, "lowered");
+    compiled.program = lower_access_pattern(pattern, true);
+    report(compiled, "hoist");
+    compiled.program = merge_streams(compiled.program);
+    report(compiled, "merge");
+    compiled.program = coalesce_delays(compiled.program);
+    report(compiled, "coalesce");
+    return compiled;
+}
+
+CompiledProgram optimize_program(const vector<Descriptor_2D>& program)
+{
+    CompiledProgram compiled;
+    compiled.program = program;
+    report(compiled, "input");
+    compiled.program = merge_streams(compiled.program);
+    report(compiled, "merge");
+    compiled.program = coalesce_delays(compiled.program);
+    report(compiled, "coalesce");
+    return compiled;
+}
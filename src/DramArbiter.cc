@@ -0,0 +1,102 @@
+#include "DramArbiter.hh"
+#include "tlm-extensions/genattr.h"
+#include <algorithm>
+#include <assert.h>
+#include <stdexcept>
+
+DramArbiter::DramArbiter(sc_module_name name, sc_time _cycle, unsigned int _bytes_per_cycle, unsigned int master_count)
+    : sc_module(name),
+      target_socket("target_socket"),
+      init_socket("init_socket"),
+      cycle(_cycle),
+      bytes_per_cycle(_bytes_per_cycle),
+      transaction_counter(master_count, 0),
+      byte_counter(master_count, 0),
+      stall_time(master_count, SC_ZERO_TIME)
+{
+    assert(bytes_per_cycle > 0);
+    assert(master_count > 0);
+    target_socket.register_b_transport(this, &DramArbiter::b_transport);
+    target_socket.register_transport_dbg(this, &DramArbiter::transport_dbg);
+    this->reset();
+}
+
+void DramArbiter::reset()
+{
+    busy_until = SC_ZERO_TIME;
+    busy_time = SC_ZERO_TIME;
+    std::fill(transaction_counter.begin(), transaction_counter.end(), 0);
+    std::fill(byte_counter.begin(), byte_counter.end(), 0);
+    std::fill(stall_time.begin(), stall_time.end(), SC_ZERO_TIME);
+}
+
+void DramArbiter::b_transport(tlm::tlm_generic_payload& trans, sc_time& delay)
+{
+    genattr_extension* genattr;
+    trans.get_extension(genattr);
+    unsigned int master = (genattr) ? genattr->get_master_id() : 0;
+    assert(master < transaction_counter.size());
+
+    sc_time issue = sc_time_stamp() + delay;
+    sc_time start = (issue < busy_until) ? busy_until : issue;
+    sc_time occupancy = cycle * ((trans.get_data_length() + bytes_per_cycle - 1) / bytes_per_cycle);
+
+    busy_until = start + occupancy;
+    busy_time += occupancy;
+    stall_time[master] += start - issue;
+    transaction_counter[master]++;
+    byte_counter[master] += trans.get_data_length();
+
+    delay += (start - issue) + occupancy;
+    init_socket->b_transport(trans, delay);
+}
+
+// debug accesses bypass the bandwidth model and are not counted
+unsigned int DramArbiter::transport_dbg(tlm::tlm_generic_payload& trans)
+{
+    return init_socket->transport_dbg(trans);
+}
+
+sc_time DramArbiter::total_stall_time() const
+{
+    sc_time total = SC_ZERO_TIME;
+    for (auto& stall : stall_time)
+    {
+        total += stall;
+    }
+    return total;
+}
+
+DramPort::DramPort(sc_module_name name, unsigned int _master_id)
+    : sc_module(name),
+      socket("socket"),
+      master_id(_master_id),
+      local_time(SC_ZERO_TIME)
+{
+}
+
+sc_time DramPort::transfer(tlm::tlm_command cmd, sc_dt::uint64 addr, unsigned char* data, unsigned int length)
+{
+    tlm::tlm_generic_payload trans;
+    genattr_extension* genattr = new genattr_extension();
+
+    trans.set_command(cmd);
+    trans.set_address(addr);
+    trans.set_data_ptr(data);
+    trans.set_data_length(length);
+    trans.set_streaming_width(length);
+    trans.set_dmi_allowed(false);
+    trans.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
+
+    genattr->set_master_id(master_id);
+    trans.set_extension(genattr);
+
+    socket->b_transport(trans, local_time);
+    trans.release_extension(genattr);
+
+    if (trans.get_response_status() != tlm::TLM_OK_RESPONSE)
+    {
+        throw std::runtime_error("DRAM transfer failed");
+    }
+    return local_time;
+}
@@ -0,0 +1,64 @@
+#include "Extrapolation.hh"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <tuple>
+
+vector<TileStratum> stratify_tiles(const Mapping& mapping, const LayerShape& layer)
+{
+    int v_count = mapping.filter_tiles(layer);
+    int h_count = mapping.channel_tiles(layer);
+    int reduction = layer.c_in * layer.k * layer.k;
+    auto schedule = mapping.tile_schedule(v_count, h_count);
+
+    std::map<std::tuple<int, int, bool>, TileStratum> strata;
+    for (unsigned int idx = 0; idx < schedule.size(); idx++)
+    {
+        int filters = std::min(mapping.filter_tile, layer.f_out - schedule[idx].first * mapping.filter_tile);
+        int columns = std::min(mapping.channel_tile, reduction - schedule[idx].second * mapping.channel_tile);
+        bool accumulate = schedule[idx].second != 0;
+        auto& stratum = strata[std::make_tuple(filters, columns, accumulate)];
+        stratum.filters = filters;
+        stratum.columns = columns;
+        stratum.accumulate = accumulate;
+        stratum.tiles.push_back(idx);
+    }
+    vector<TileStratum> result;
+    for (auto& stratum : strata)
+    {
+        result.push_back(stratum.second);
+    }
+    return result;
+}
+
+double RowExtrapolation::low() const
+{
+    return estimate - error;
+}
+
+double RowExtrapolation::high() const
+{
+    return estimate + error;
+}
+
+RowExtrapolation extrapolate_rows(const vector<int>& rows, const vector<double>& costs, int target_rows)
+{
+    assert(rows.size() == costs.size() && !rows.empty());
+    for (unsigned int idx = 1; idx < rows.size(); idx++)
+    {
+        assert(rows[idx - 1] < rows[idx]);
+    }
+    assert(rows.back() <= target_rows);
+    if (rows.back() == target_rows)
+    {
+        return {costs.back(), 0.0};
+    }
+    assert(rows.size() >= 3);
+    // the miss of a chord is a (x - x0)(x - x1) for a cost with curvature 2a
+    double x0 = rows[rows.size() - 3], x1 = rows[rows.size() - 2], x2 = rows.back();
+    double y0 = costs[costs.size() - 3], y1 = costs[costs.size() - 2], y2 = costs.back();
+    double slope = (y2 - y1) / (x2 - x1);
+    double residual = std::fabs(y2 - (y1 + (y1 - y0) / (x1 - x0) * (x2 - x1)));
+    double x = target_rows;
+    return {y2 + slope * (x - x2), residual * (x - x1) * (x - x2) / ((x2 - x0) * (x2 - x1))};
+}
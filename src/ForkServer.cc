@@ -0,0 +1,402 @@
+#include "ForkServer.hh"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <poll.h>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <sys/wait.h>
+#include <unistd.h>
+
+vector<string> split_config_line(const string& line)
+{
+    vector<string> args;
+    string arg;
+    bool in_arg = false;
+    char quote = 0;
+    for (char c : line)
+    {
+        if (quote)
+        {
+            if (c == quote)
+            {
+                quote = 0;
+            }
+            else
+            {
+                arg += c;
+            }
+        }
+        else if (c == '\'' || c == '"')
+        {
+            quote = c;
+            in_arg = true;
+        }
+        else if (c == '#' && !in_arg)
+        {
+            break;
+        }
+        else if (isspace((unsigned char)c))
+        {
+            if (in_arg)
+            {
+                args.push_back(arg);
+                arg.clear();
+                in_arg = false;
+            }
+        }
+        else
+        {
+            arg += c;
+            in_arg = true;
+        }
+    }
+    if (quote)
+    {
+        throw std::invalid_argument("unterminated quote in configuration: " + line);
+    }
+    if (in_arg)
+    {
+        args.push_back(arg);
+    }
+    return args;
+}
+
+string json_escape(const string& text)
+{
+    std::stringstream ss;
+    for (unsigned char c : text)
+    {
+        switch (c)
+        {
+        case '"':
+            ss << "\\\"";
+            break;
+        case '\\':
+            ss << "\\\\";
+            break;
+        case '\n':
+            ss << "\\n";
+            break;
+        case '\t':
+            ss << "\\t";
+            break;
+        default:
+            if (c < 0x20)
+            {
+                char hex[8];
+                snprintf(hex, sizeof(hex), "\\u%04x", c);
+                ss << hex;
+            }
+            else
+            {
+                ss << c;
+            }
+        }
+    }
+    return ss.str();
+}
+
+static string trim(const string& text)
+{
+    auto first = text.find_first_not_of(" \t\r");
+    if (first == string::npos)
+    {
+        return "";
+    }
+    auto last = text.find_last_not_of(" \t\r");
+    return text.substr(first, last - first + 1);
+}
+
+string json_value(const string& value)
+{
+    // -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+    size_t pos = 0;
+    auto digits = [&]() {
+        size_t first = pos;
+        while (pos < value.size() && isdigit((unsigned char)value[pos]))
+        {
+            pos++;
+        }
+        return pos > first;
+    };
+    bool number = true;
+    if (pos < value.size() && value[pos] == '-')
+    {
+        pos++;
+    }
+    if (pos < value.size() && value[pos] == '0')
+    {
+        pos++;
+    }
+    else
+    {
+        number &= digits();
+    }
+    if (number && pos < value.size() && value[pos] == '.')
+    {
+        pos++;
+        number &= digits();
+    }
+    if (number && pos < value.size() && (value[pos] == 'e' || value[pos] == 'E'))
+    {
+        pos++;
+        if (pos < value.size() && (value[pos] == '+' || value[pos] == '-'))
+        {
+            pos++;
+        }
+        number &= digits();
+    }
+    // and readers parse it back to the same finite double
+    number &= pos == value.size() && std::isfinite(strtod(value.c_str(), nullptr));
+    return (number) ? value : "\"" + json_escape(value) + "\"";
+}
+
+// identifiers that may look like numbers, e.g. an abbreviated commit hash
+static const std::set<string> text_metrics = {"Build"};
+
+ConfigResult parse_config_result(int id, const string& config, int exit_code, const string& output)
+{
+    const unsigned int label_width = 20;
+    ConfigResult result{id, config, "CRASH", exit_code, "", {}};
+    bool passed = false;
+    bool failed = false;
+    std::istringstream lines(output);
+    string line;
+    while (std::getline(lines, line))
+    {
+        if (line == "PASS")
+        {
+            passed = true;
+        }
+        else if (line == "FAIL")
+        {
+            failed = true;
+        }
+        else if (line.compare(0, 7, "error: ") == 0)
+        {
+            result.error = trim(line.substr(7));
+        }
+        else if (line.size() > label_width && line[0] != ' ' && line[label_width - 1] == ' ')
+        {
+            string label = trim(line.substr(0, label_width));
+            string value = trim(line.substr(label_width));
+            if (!label.empty() && !value.empty())
+            {
+                result.metrics[label] = value;
+            }
+        }
+    }
+    // a configuration that printed FAIL anywhere failed, even if an earlier part passed
+    result.status = (failed) ? "FAIL" : (passed) ? "PASS" : "CRASH";
+    return result;
+}
+
+string ConfigResult::to_json() const
+{
+    std::stringstream ss;
+    ss << "{\"id\": " << id << ", \"config\": \"" << json_escape(config) << "\", \"status\": \"" << status << "\", \"exit_code\": " << exit_code;
+    if (!error.empty())
+    {
+        ss << ", \"error\": \"" << json_escape(error) << "\"";
+    }
+    ss << ", \"metrics\": {";
+    bool first = true;
+    for (auto& metric : metrics)
+    {
+        ss << ((first) ? "" : ", ") << "\"" << json_escape(metric.first) << "\": " << ((text_metrics.count(metric.first)) ? "\"" + json_escape(metric.second) + "\"" : json_value(metric.second));
+        first = false;
+    }
+    ss << "}}";
+    return ss.str();
+}
+
+ForkServer::ForkServer(int _jobs, const string& _program_name, double _timeout) : jobs(_jobs), program_name(_program_name), timeout(_timeout)
+{
+    if (jobs <= 0)
+    {
+        throw std::invalid_argument("fork server jobs must be positive");
+    }
+    if (timeout < 0.0)
+    {
+        throw std::invalid_argument("fork server timeout must not be negative");
+    }
+}
+
+typedef std::chrono::steady_clock Clock;
+
+struct RunningConfig
+{
+    int id;
+    string config;
+    pid_t pid; // also the child's process group
+    int fd;
+    string output;
+    Clock::time_point deadline;
+    bool timed_out;
+};
+
+int ForkServer::run(std::istream& in, std::ostream& out, const Configuration& configuration)
+{
+    vector<RunningConfig> running;
+    int next_id = 0;
+    bool input_done = false;
+    while (true)
+    {
+        while (!input_done && (int)running.size() < jobs)
+        {
+            string line;
+            if (!std::getline(in, line))
+            {
+                input_done = true;
+                break;
+            }
+            vector<string> args;
+            try
+            {
+                args = split_config_line(line);
+            }
+            catch (std::exception& e)
+            {
+                ConfigResult result{next_id++, line, "FAIL", EXIT_FAILURE, e.what(), {}};
+                out << result.to_json() << std::endl;
+                completed++;
+                failed++;
+                continue;
+            }
+            if (args.empty())
+            {
+                continue;
+            }
+
+            int fds[2];
+            if (pipe(fds) != 0)
+            {
+                throw std::runtime_error("could not open a pipe to a configuration");
+            }
+            // nothing buffered may be written twice by the child
+            out.flush();
+            std::cout.flush();
+            fflush(stdout);
+            pid_t pid = fork();
+            if (pid < 0)
+            {
+                throw std::runtime_error("could not fork a configuration");
+            }
+            if (pid == 0)
+            {
+                // its own group, so a timeout also kills what it forks
+                setpgid(0, 0);
+                close(fds[0]);
+                for (auto& other : running)
+                {
+                    close(other.fd);
+                }
+                if (dup2(fds[1], STDOUT_FILENO) < 0)
+                {
+                    _exit(EXIT_FAILURE);
+                }
+                close(fds[1]);
+                vector<string> argv_strings(1, program_name);
+                argv_strings.insert(argv_strings.end(), args.begin(), args.end());
+                vector<char*> argv;
+                for (auto& arg : argv_strings)
+                {
+                    argv.push_back(&arg[0]);
+                }
+                argv.push_back(nullptr);
+                int status = EXIT_FAILURE;
+                try
+                {
+                    status = configuration(argv_strings.size(), argv.data());
+                }
+                catch (std::exception& e)
+                {
+                    std::cout << "error: " << e.what() << "\n";
+                }
+                std::cout.flush();
+                fflush(stdout);
+                _exit(status);
+            }
+            setpgid(pid, pid);
+            close(fds[1]);
+            auto deadline = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(timeout));
+            running.push_back({next_id++, line, pid, fds[0], "", deadline, false});
+        }
+        if (running.empty())
+        {
+            break;
+        }
+
+        // wait for output or the earliest deadline of a child still to be killed
+        vector<pollfd> polled;
+        int wait_ms = -1;
+        auto now = Clock::now();
+        for (auto& config : running)
+        {
+            polled.push_back({config.fd, POLLIN, 0});
+            if (timeout > 0.0 && !config.timed_out)
+            {
+                if (config.deadline <= now)
+                {
+                    kill(-config.pid, SIGKILL);
+                    config.timed_out = true;
+                    continue;
+                }
+                auto left = std::chrono::duration_cast<std::chrono::milliseconds>(config.deadline - now).count() + 1;
+                wait_ms = (wait_ms < 0) ? left : std::min<int>(wait_ms, left);
+            }
+        }
+        if (poll(polled.data(), polled.size(), wait_ms) < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            throw std::runtime_error("polling configurations failed");
+        }
+        // collect from the back so erasing keeps the remaining indices valid
+        for (int idx = polled.size() - 1; idx >= 0; idx--)
+        {
+            if (!(polled[idx].revents & (POLLIN | POLLHUP | POLLERR)))
+            {
+                continue;
+            }
+            auto& config = running[idx];
+            char buffer[4096];
+            ssize_t count = read(config.fd, buffer, sizeof(buffer));
+            if (count > 0)
+            {
+                config.output.append(buffer, count);
+                continue;
+            }
+            if (count < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            close(config.fd);
+            int status = 0;
+            waitpid(config.pid, &status, 0);
+            int exit_code = (WIFEXITED(status)) ? WEXITSTATUS(status) : -WTERMSIG(status);
+            auto result = parse_config_result(config.id, config.config, exit_code, config.output);
+            if (config.timed_out)
+            {
+                std::stringstream error;
+                error << "timed out after " << timeout << " s";
+                result.status = "FAIL";
+                result.error = error.str();
+            }
+            out << result.to_json() << std::endl;
+            completed++;
+            failed += (result.status != "PASS");
+            running.erase(running.begin() + idx);
+        }
+    }
+    return completed;
+}
@@ -0,0 +1,98 @@
+#include "GlobalBuffer.hh"
+#include <sstream>
+#include <stdexcept>
+
+GlobalBuffer::GlobalBuffer(int _capacity, int _channel_pool)
+{
+    assert(_capacity > 0 && _channel_pool > 0);
+    this->capacity = _capacity;
+    this->channel_pool = _channel_pool;
+    for (auto& allocation : regions)
+    {
+        allocation = {0, 0, 0};
+    }
+}
+
+bool GlobalBuffer::fits(int ifmap_words, int ifmap_channels, int psum_words, int psum_channels, int weight_words, int weight_channels) const
+{
+    return ifmap_words + psum_words + weight_words <= capacity &&
+           ifmap_channels + psum_channels + weight_channels <= channel_pool;
+}
+
+void GlobalBuffer::allocate(int ifmap_words, int ifmap_channels, int psum_words, int psum_channels, int weight_words, int weight_channels)
+{
+    if (!fits(ifmap_words, ifmap_channels, psum_words, psum_channels, weight_words, weight_channels))
+    {
+        std::stringstream ss;
+        ss << "layer needs " << ifmap_words + psum_words + weight_words << " words and "
+           << ifmap_channels + psum_channels + weight_channels << " channels of a "
+           << capacity << " word " << channel_pool << " channel global buffer";
+        throw std::length_error(ss.str());
+    }
+    regions[(int)BufferRegion::IFMAP] = {0, ifmap_words, ifmap_channels};
+    regions[(int)BufferRegion::PSUM] = {ifmap_words, psum_words, psum_channels};
+    regions[(int)BufferRegion::WEIGHT] = {ifmap_words + psum_words, weight_words, weight_channels};
+}
+
+const RegionAllocation& GlobalBuffer::region(BufferRegion region) const
+{
+    return regions[(int)region];
+}
+
+void GlobalBuffer::verify(BufferRegion region, const vector<Descriptor_2D>& program, int word_width) const
+{
+    const RegionAllocation& allocation = this->region(region);
+    for (unsigned int idx = 0; idx < program.size(); idx++)
+    {
+        if (program[idx].state != DescriptorState::GENERATE)
+        {
+            continue;
+        }
+        auto range = program[idx].address_range();
+        if (range.first < 0 || (range.second + 1) * word_width > allocation.words)
+        {
+            std::stringstream ss;
+            ss << region_name(region) << " descriptor " << idx << " reaches [" << range.first << ", "
+               << range.second << "] outside its " << allocation.words << " word region";
+            throw std::out_of_range(ss.str());
+        }
+    }
+}
+
+int GlobalBuffer::used_words() const
+{
+    int words = 0;
+    for (auto& allocation : regions)
+    {
+        words += allocation.words;
+    }
+    return words;
+}
+
+int GlobalBuffer::used_channels() const
+{
+    int channels = 0;
+    for (auto& allocation : regions)
+    {
+        channels += allocation.channels;
+    }
+    return channels;
+}
+
+double GlobalBuffer::utilization() const
+{
+    return (double)used_words() / capacity;
+}
+
+string GlobalBuffer::region_name(BufferRegion region)
+{
+    switch (region)
+    {
+    case BufferRegion::IFMAP:
+        return "ifmap";
+    case BufferRegion::PSUM:
+        return "psum";
+    default:
+        return "weight";
+    }
+}
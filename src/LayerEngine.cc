@@ -0,0 +1,49 @@
+#include "LayerEngine.hh"
+#include <cstdint>
+#include <stdexcept>
+
+MappingCost run_layer_engine(const int* ifmap, const int* weights, int* ofmap, const LayerShape& layer, const Mapping& mapping, const ArrayShape& array)
+{
+    if (layer.c_in <= 0 || layer.f_out <= 0 || layer.k <= 0 || layer.ofmap_h <= 0 || layer.ofmap_w <= 0)
+    {
+        throw std::invalid_argument("all layer dims must be positive");
+    }
+    if (mapping.filter_tile < 1 || mapping.filter_tile > mapping.filter_rows(array) || mapping.channel_tile < 1 || mapping.channel_tile > mapping.channel_cols(array))
+    {
+        throw std::invalid_argument("mapping tiles must fit the array");
+    }
+
+    int ifmap_h = layer.ofmap_h + layer.k - 1;
+    int ifmap_w = layer.ofmap_w + layer.k - 1;
+    long int stream_size = layer.ofmap_size();
+    for (int f = 0; f < layer.f_out; f++)
+    {
+        // unsigned sums wrap mod 2^32 in any order, as the psum chain does
+        vector<uint32_t> acc(stream_size, 0);
+        for (int c = 0; c < layer.c_in; c++)
+        {
+            for (int ky = 0; ky < layer.k; ky++)
+            {
+                for (int kx = 0; kx < layer.k; kx++)
+                {
+                    uint32_t weight = weights[((long int)(f * layer.c_in + c) * layer.k + ky) * layer.k + kx];
+                    const int* plane = ifmap + (long int)c * ifmap_h * ifmap_w;
+                    for (int y = 0; y < layer.ofmap_h; y++)
+                    {
+                        const int* row = plane + (long int)(y + ky) * ifmap_w + kx;
+                        uint32_t* out = acc.data() + (long int)y * layer.ofmap_w;
+                        for (int x = 0; x < layer.ofmap_w; x++)
+                        {
+                            out[x] += weight * (uint32_t)row[x];
+                        }
+                    }
+                }
+            }
+        }
+        for (long int idx = 0; idx < stream_size; idx++)
+        {
+            ofmap[f * stream_size + idx] = (int)acc[idx];
+        }
+    }
+    return estimate_mapping_cost(mapping, layer, array);
+}
@@ -0,0 +1,202 @@
+#include "Mapper.hh"
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+int LayerShape::ifmap_size() const
+{
+    return (ofmap_h + k - 1) * (ofmap_w + k - 1);
+}
+
+int LayerShape::ofmap_size() const
+{
+    return ofmap_h * ofmap_w;
+}
+
+Mapping::Mapping(UnrollOrientation _orientation, LoopOrder _loop_order, int _filter_tile, int _channel_tile)
+{
+    this->orientation = _orientation;
+    this->loop_order = _loop_order;
+    this->filter_tile = _filter_tile;
+    this->channel_tile = _channel_tile;
+}
+
+int Mapping::filter_rows(const ArrayShape& array) const
+{
+    return (orientation == UnrollOrientation::HORIZONTAL) ? array.rows : array.cols;
+}
+
+int Mapping::channel_cols(const ArrayShape& array) const
+{
+    return (orientation == UnrollOrientation::HORIZONTAL) ? array.cols : array.rows;
+}
+
+int Mapping::filter_tiles(const LayerShape& layer) const
+{
+    return (layer.f_out + filter_tile - 1) / filter_tile;
+}
+
+int Mapping::channel_tiles(const LayerShape& layer) const
+{
+    int reduction = layer.c_in * layer.k * layer.k;
+    return (reduction + channel_tile - 1) / channel_tile;
+}
+
+vector<pair<int, int>> Mapping::tile_schedule(int v_count, int h_count) const
+{
+    vector<pair<int, int>> schedule;
+    if (loop_order == LoopOrder::FILTER_TILES_OUTER)
+    {
+        for (int v = 0; v < v_count; v++)
+        {
+            for (int h = 0; h < h_count; h++)
+            {
+                schedule.push_back({v, h});
+            }
+        }
+    }
+    else
+    {
+        for (int h = 0; h < h_count; h++)
+        {
+            for (int v = 0; v < v_count; v++)
+            {
+                schedule.push_back({v, h});
+            }
+        }
+    }
+    return schedule;
+}
+
+bool Mapping::legal(const LayerShape& layer, const ArrayShape& array) const
+{
+    if (filter_tile < 1 || filter_tile > filter_rows(array) || channel_tile < 1 || channel_tile > channel_cols(array))
+    {
+        return false;
+    }
+    // the tile streaming through the array has to be resident
+    return channel_tile * layer.ifmap_size() <= array.ifmap_mem_size && filter_tile * layer.ofmap_size() <= array.psum_mem_size;
+}
+
+string Mapping::to_string() const
+{
+    std::stringstream ss;
+    ss << ((orientation == UnrollOrientation::HORIZONTAL) ? "horizontal" : "verticle") << " ";
+    ss << ((loop_order == LoopOrder::FILTER_TILES_OUTER) ? "filters_outer" : "channels_outer") << " ";
+    ss << filter_tile << "x" << channel_tile;
+    return ss.str();
+}
+
+Mapping Mapping::full_array(const ArrayShape& array)
+{
+    return Mapping(UnrollOrientation::HORIZONTAL, LoopOrder::FILTER_TILES_OUTER, array.rows, array.cols);
+}
+
+UnrollOrientation Mapping::orientation_from_string(const string& orientation)
+{
+    if (orientation == "horizontal")
+    {
+        return UnrollOrientation::HORIZONTAL;
+    }
+    else if (orientation == "verticle")
+    {
+        return UnrollOrientation::VERTICLE;
+    }
+    throw std::invalid_argument("orientation must be one of horizontal or verticle");
+}
+
+LoopOrder Mapping::loop_order_from_string(const string& loop_order)
+{
+    if (loop_order == "filters_outer")
+    {
+        return LoopOrder::FILTER_TILES_OUTER;
+    }
+    else if (loop_order == "channels_outer")
+    {
+        return LoopOrder::CHANNEL_TILES_OUTER;
+    }
+    throw std::invalid_argument("loop order must be one of filters_outer or channels_outer");
+}
+
+// Mirrors the program generators: after a channel_cols + 2 cycle fill every
+// tile streams the ofmap once, one cycle per element plus a bubble. Filter
+// tiles re-stream the ifmap, channel tiles after the first read back and
+// accumulate partial sums.
+MappingCost estimate_mapping_cost(const Mapping& mapping, const LayerShape& layer, const ArrayShape& array)
+{
+    MappingCost cost;
+    long int rows = mapping.filter_rows(array);
+    long int cols = mapping.channel_cols(array);
+    long int v_count = mapping.filter_tiles(layer);
+    long int h_count = mapping.channel_tiles(layer);
+    long int reduction = layer.c_in * layer.k * layer.k;
+    long int stream_size = layer.ofmap_size();
+    long int ifmap_words = (long int)layer.c_in * layer.ifmap_size();
+    long int ofmap_words = (long int)layer.f_out * stream_size;
+
+    cost.fits = mapping.legal(layer, array);
+    cost.cycles = (cols + 2) + v_count * h_count * (stream_size + 1);
+    cost.macs = layer.f_out * reduction * stream_size;
+    cost.ifmap_reads = v_count * reduction * stream_size;
+    cost.psum_writes = layer.f_out * h_count * stream_size;
+    cost.psum_reads = layer.f_out * (h_count - 1) * stream_size;
+    cost.weight_loads = v_count * h_count * rows * cols;
+    cost.pe_utilization = (double)cost.macs / ((double)v_count * h_count * (stream_size + 1) * rows * cols);
+
+    cost.dram_words = (long int)layer.f_out * reduction + ofmap_words;
+    if (mapping.loop_order == LoopOrder::FILTER_TILES_OUTER)
+    {
+        // the ifmap is re-fetched per filter tile unless it stays resident
+        cost.dram_words += (ifmap_words <= array.ifmap_mem_size) ? ifmap_words : v_count * ifmap_words;
+    }
+    else
+    {
+        // every filter's partial sums are live until the last channel tile
+        cost.dram_words += ifmap_words;
+        cost.dram_words += (ofmap_words <= array.psum_mem_size) ? 0 : 2 * (h_count - 1) * ofmap_words;
+    }
+
+    cost.energy = DRAM_ACCESS_ENERGY * cost.dram_words +
+                  SAM_ACCESS_ENERGY * (cost.ifmap_reads + cost.psum_reads + cost.psum_writes) +
+                  PE_ACCESS_ENERGY * (cost.macs + cost.weight_loads);
+    cost.score = cost.energy * cost.cycles;
+    return cost;
+}
+
+// Full array tiles first so the original mapping wins any tie.
+vector<Mapping> enumerate_mappings(const LayerShape& layer, const ArrayShape& array)
+{
+    vector<Mapping> mappings;
+    for (auto orientation : {UnrollOrientation::HORIZONTAL, UnrollOrientation::VERTICLE})
+    {
+        for (auto loop_order : {LoopOrder::FILTER_TILES_OUTER, LoopOrder::CHANNEL_TILES_OUTER})
+        {
+            Mapping probe(orientation, loop_order, 1, 1);
+            for (int filter_tile = probe.filter_rows(array); filter_tile > 0; filter_tile--)
+            {
+                for (int channel_tile = probe.channel_cols(array); channel_tile > 0; channel_tile--)
+                {
+                    Mapping mapping(orientation, loop_order, filter_tile, channel_tile);
+                    if (mapping.legal(layer, array))
+                    {
+                        mappings.push_back(mapping);
+                    }
+                }
+            }
+        }
+    }
+    return mappings;
+}
+
+vector<pair<Mapping, MappingCost>> search_mappings(const LayerShape& layer, const ArrayShape& array)
+{
+    vector<pair<Mapping, MappingCost>> ranked;
+    for (auto& mapping : enumerate_mappings(layer, array))
+    {
+        ranked.push_back({mapping, estimate_mapping_cost(mapping, layer, array)});
+    }
+    std::stable_sort(ranked.begin(), ranked.end(), [](const pair<Mapping, MappingCost>& a, const pair<Mapping, MappingCost>& b) {
+        return a.second.score < b.second.score;
+    });
+    return ranked;
+}
@@ -15,6 +15,17 @@ void Memory<DataType>::update()
     if (control->reset())
     {
         access_counter = 0;
+        for (auto& post_processor : post_processors)
+        {
+            if (post_processor)
+            {
+                post_processor->reset();
+            }
+        }
+        if (decompressor)
+        {
+            decompressor->reset();
+        }
         for (auto& row : ram)
         {
             for (auto& col : row)
@@ -33,10 +44,30 @@ void Memory<DataType>::update()
         {
             if (channels[channel_idx]->enabled())
             {
+                if (address_trace)
+                {
+                    address_trace->push_back(channels[channel_idx]->addr());
+                }
+                if (channel_trace)
+                {
+                    channel_trace->record(sc_time_stamp() / control->clk().period(), channel_idx, channels[channel_idx]->mode(), channels[channel_idx]->addr());
+                }
                 switch (channels[channel_idx]->mode())
                 {
                 case MemoryChannelMode::WRITE:
                     assert(channels[channel_idx]->get_width() == width);
+                    if (post_processors.at(channel_idx))
+                    {
+                        assert(width == 1);
+                        unsigned int addr = channels[channel_idx]->addr();
+                        DataType data = channels[channel_idx]->mem_read_data().at(0);
+                        if (post_processors[channel_idx]->process(addr, data))
+                        {
+                            access_counter++;
+                            ram.at(addr).at(0) = data;
+                        }
+                        break;
+                    }
                     for (unsigned int i = 0; i < width; i++)
                     {
                         access_counter++;
@@ -45,6 +76,12 @@ void Memory<DataType>::update()
                     break;
                 case MemoryChannelMode::READ:
                     assert(channels[channel_idx]->get_width() == width);
+                    if (decompressor)
+                    {
+                        // counts its own metadata and value word accesses
+                        channels[channel_idx]->mem_write_data((int)decompressor->read(channel_idx, channels[channel_idx]->addr(), ram, access_counter));
+                        break;
+                    }
                     access_counter++;
                     channels[channel_idx]->mem_write_data(ram.at(channels[channel_idx]->addr()));
                     break;
@@ -87,7 +124,11 @@ Memory<DataType>::Memory(
                             width(_width),
                             length(_length),
                             channel_count(_channel_count),
-                            access_counter(0)
+                            access_counter(0),
+                            post_processors(_channel_count, nullptr),
+                            decompressor(nullptr),
+                            address_trace(nullptr),
+                            channel_trace(nullptr)
                             
 {
 #ifdef MEM_WAVE_TRACE
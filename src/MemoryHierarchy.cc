@@ -0,0 +1,276 @@
+#include "MemoryHierarchy.hh"
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+vector<MemoryLevelConfig> memory_levels_from_string(const string& levels)
+{
+    vector<MemoryLevelConfig> configs;
+    std::stringstream ss(levels);
+    string level;
+    while (std::getline(ss, level, ','))
+    {
+        MemoryLevelConfig config;
+        char sep_0 = 0, sep_1 = 0;
+        std::stringstream fields(level);
+        if (!(fields >> config.length >> sep_0 >> config.width >> sep_1 >> config.latency) || sep_0 != ':' || sep_1 != ':' || !fields.eof())
+        {
+            throw std::invalid_argument("memory levels must be comma separated length:width:latency triples");
+        }
+        if (config.length <= 0 || config.width <= 0 || config.latency < 0)
+        {
+            throw std::invalid_argument("memory level lengths and widths must be positive, latencies not negative");
+        }
+        if (!configs.empty() && configs.back().width % config.width != 0)
+        {
+            throw std::invalid_argument("memory level widths must divide the width of the level above");
+        }
+        configs.push_back(config);
+    }
+    if (configs.empty())
+    {
+        throw std::invalid_argument("memory hierarchy needs at least one level");
+    }
+    return configs;
+}
+
+template <typename DataType>
+MemoryLevelCreator<DataType>::MemoryLevelCreator(GlobalControlChannel& _control, const vector<MemoryLevelConfig>& _configs, sc_trace_file* _tf)
+    : control(_control), configs(_configs), tf(_tf)
+{
+}
+
+template <typename DataType>
+SAM<DataType>* MemoryLevelCreator<DataType>::operator()(const char* name, size_t level)
+{
+    return new SAM<DataType>(name, control, 2, configs.at(level).length, configs.at(level).width, tf);
+}
+
+template <typename DataType>
+LevelSignalCreator<DataType>::LevelSignalCreator(const vector<MemoryLevelConfig>& _configs) : configs(_configs)
+{
+}
+
+template <typename DataType>
+sc_vector<sc_signal<DataType>>* LevelSignalCreator<DataType>::operator()(const char* name, size_t idx)
+{
+    return new sc_vector<sc_signal<DataType>>(name, configs.at(idx / 2).width);
+}
+
+template <typename DataType>
+void MemoryHierarchy<DataType>::update()
+{
+    if (control->reset())
+    {
+        for (unsigned int link = 0; link < link_lines.size(); link++)
+        {
+            link_lines[link].clear();
+            link_pending[link] = false;
+            link_presented[link] = false;
+        }
+        std::fill(read_lines.begin(), read_lines.end(), 0);
+        std::fill(write_lines.begin(), write_lines.end(), 0);
+        cycle_counter = 0;
+        transfer_active = false;
+        return;
+    }
+    if (!control->enable())
+    {
+        return;
+    }
+    cycle_counter++;
+    for (unsigned int link = 0; link < link_lines.size(); link++)
+    {
+        SAM<DataType>& upper = levels[link];
+        SAM<DataType>& lower = levels[link + 1];
+        unsigned int lower_width = configs[link + 1].width;
+
+        // the fill channel wrote the presented line this cycle
+        if (lower.channels[LEVEL_FILL_CHANNEL].enabled())
+        {
+            if (!link_presented[link])
+            {
+                cout << "ERROR: " << this->name() << " link " << link << " underrun" << endl;
+                exit(EXIT_FAILURE);
+            }
+            link_presented[link] = false;
+            write_lines[link + 1]++;
+        }
+
+        // a line read in the previous cycle is on the read bus now
+        if (link_pending[link])
+        {
+            auto& bus = read_data[link * 2 + LEVEL_DRAIN_CHANNEL];
+            for (unsigned int part = 0; part < configs[link].width / lower_width; part++)
+            {
+                vector<DataType> line(lower_width);
+                for (unsigned int lane = 0; lane < lower_width; lane++)
+                {
+                    line[lane] = bus[part * lower_width + lane].read();
+                }
+                link_lines[link].push_back({cycle_counter + configs[link].latency, line});
+            }
+        }
+        link_pending[link] = upper.channels[LEVEL_DRAIN_CHANNEL].enabled();
+        read_lines[link] += (link_pending[link]) ? 1 : 0;
+
+        if (!link_presented[link] && !link_lines[link].empty() && link_lines[link].front().first <= cycle_counter)
+        {
+            auto& bus = write_data[(link + 1) * 2 + LEVEL_FILL_CHANNEL];
+            for (unsigned int lane = 0; lane < lower_width; lane++)
+            {
+                bus[lane] = link_lines[link].front().second[lane];
+            }
+            link_lines[link].pop_front();
+            link_presented[link] = true;
+        }
+    }
+    if (transfer_active && transfer_done())
+    {
+        transfer_active = false;
+        sc_pause();
+    }
+}
+
+template <typename DataType>
+bool MemoryHierarchy<DataType>::transfer_done()
+{
+    for (auto& level : levels)
+    {
+        for (auto& gen : level.generators)
+        {
+            if (gen.currentDescriptor().state != DescriptorState::SUSPENDED)
+            {
+                return false;
+            }
+        }
+    }
+    for (unsigned int link = 0; link < link_lines.size(); link++)
+    {
+        if (!link_lines[link].empty() || link_pending[link] || link_presented[link])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename DataType>
+void MemoryHierarchy<DataType>::load(const vector<int>& words)
+{
+    unsigned int width = configs[0].width;
+    assert(words.size() <= (size_t)configs[0].length * width);
+    for (unsigned int idx = 0; idx < words.size(); idx++)
+    {
+        levels[0].mem.ram.at(idx / width).at(idx % width).write(words[idx]);
+    }
+    levels[0].mem.access_counter += words.size();
+}
+
+template <typename DataType>
+DataType MemoryHierarchy<DataType>::word(int level, int addr)
+{
+    unsigned int width = configs.at(level).width;
+    levels[level].mem.access_counter++;
+    return levels[level].mem.ram.at(addr / width).at(addr % width).read();
+}
+
+// The fill side starts latency + 4 cycles behind the drain side, enough
+// for the first line to cross the link. After that the drain side hands
+// over width(link) / width(link + 1) lines per cycle against the one the
+// fill side takes, so the link never runs dry.
+template <typename DataType>
+void MemoryHierarchy<DataType>::run_transfer(int link, int src_line, int dst_line, int upper_lines)
+{
+    assert(link >= 0 && link + 1 < (int)levels.size() && upper_lines > 0);
+    int lower_lines = upper_lines * (configs[link].width / configs[link + 1].width);
+    assert(src_line + upper_lines <= configs[link].length && dst_line + lower_lines <= configs[link + 1].length);
+
+    vector<Descriptor_2D> suspend_program;
+    suspend_program.push_back(Descriptor_2D::suspend_inst());
+    for (auto& level : levels)
+    {
+        for (auto& gen : level.generators)
+        {
+            gen.loadProgram(suspend_program);
+        }
+    }
+
+    vector<Descriptor_2D> drain_program = {Descriptor_2D::stream_inst(src_line, upper_lines - 1, 0), Descriptor_2D::suspend_inst()};
+    Descriptor_2D::make_sequential(drain_program);
+    levels[link].generators[LEVEL_DRAIN_CHANNEL].loadProgram(drain_program);
+    levels[link].channels[LEVEL_DRAIN_CHANNEL].set_mode(MemoryChannelMode::READ);
+
+    vector<Descriptor_2D> fill_program = {Descriptor_2D::delay_inst(configs[link].latency + 4), Descriptor_2D::stream_inst(dst_line, lower_lines - 1, 0), Descriptor_2D::suspend_inst()};
+    Descriptor_2D::make_sequential(fill_program);
+    levels[link + 1].generators[LEVEL_FILL_CHANNEL].loadProgram(fill_program);
+    levels[link + 1].channels[LEVEL_FILL_CHANNEL].set_mode(MemoryChannelMode::WRITE);
+
+    transfer_active = true;
+    control->set_program(true);
+    sc_start(1, SC_NS);
+    control->set_enable(true);
+    control->set_program(false);
+    sc_start();
+    control->set_enable(false);
+}
+
+template <typename DataType>
+double MemoryHierarchy<DataType>::read_utilization(int level) const
+{
+    return (cycle_counter) ? (double)read_lines.at(level) / cycle_counter : 0.0;
+}
+
+template <typename DataType>
+double MemoryHierarchy<DataType>::write_utilization(int level) const
+{
+    return (cycle_counter) ? (double)write_lines.at(level) / cycle_counter : 0.0;
+}
+
+template <typename DataType>
+MemoryHierarchy<DataType>::MemoryHierarchy(sc_module_name name, GlobalControlChannel& _control, const vector<MemoryLevelConfig>& _configs, sc_trace_file* tf)
+    : sc_module(name),
+      configs(_configs),
+      levels("level", _configs.size(), MemoryLevelCreator<DataType>(_control, _configs, tf)),
+      read_data("read_data", _configs.size() * 2, LevelSignalCreator<DataType>(_configs)),
+      write_data("write_data", _configs.size() * 2, LevelSignalCreator<DataType>(_configs)),
+      link_lines(_configs.size() - 1),
+      link_pending(_configs.size() - 1, false),
+      link_presented(_configs.size() - 1, false),
+      read_lines(_configs.size(), 0),
+      write_lines(_configs.size(), 0),
+      cycle_counter(0),
+      transfer_active(false)
+{
+    assert(!configs.empty());
+    for (unsigned int level = 1; level < configs.size(); level++)
+    {
+        assert(configs[level - 1].width % configs[level].width == 0);
+    }
+    control(_control);
+    _clk(control->clk());
+
+    for (unsigned int level = 0; level < configs.size(); level++)
+    {
+        for (unsigned int channel = 0; channel < 2; channel++)
+        {
+            for (int lane = 0; lane < configs[level].width; lane++)
+            {
+                levels[level].read_channel_data[channel][lane](read_data[level * 2 + channel][lane]);
+                levels[level].write_channel_data[channel][lane](write_data[level * 2 + channel][lane]);
+            }
+        }
+        levels[level].channels[LEVEL_FILL_CHANNEL].set_mode(MemoryChannelMode::WRITE);
+        levels[level].channels[LEVEL_DRAIN_CHANNEL].set_mode(MemoryChannelMode::READ);
+    }
+
+    SC_METHOD(update);
+    sensitive << _clk.pos();
+    sensitive << control->reset();
+
+    cout << "MEMORY HIERARCHY MODULE: " << name << " has been instantiated with " << configs.size() << " levels" << endl;
+}
+
+template struct MemoryLevelCreator<sc_int<32>>;
+template struct LevelSignalCreator<sc_int<32>>;
+template struct MemoryHierarchy<sc_int<32>>;
@@ -0,0 +1,155 @@
+#include "PostProcessor.hh"
+#include <algorithm>
+#include <stdexcept>
+
+PostProcessConfig::PostProcessConfig()
+{
+    this->bias = false;
+    this->relu = false;
+    this->clamp = false;
+    this->clamp_min = 0;
+    this->clamp_max = 0;
+    this->pool = PoolMode::NONE;
+}
+
+bool PostProcessConfig::enabled() const
+{
+    return bias || relu || clamp || pool != PoolMode::NONE;
+}
+
+PoolMode PostProcessConfig::pool_mode_from_string(const string& mode)
+{
+    if (mode == "none")
+    {
+        return PoolMode::NONE;
+    }
+    else if (mode == "max")
+    {
+        return PoolMode::MAX;
+    }
+    else if (mode == "avg")
+    {
+        return PoolMode::AVG;
+    }
+    throw std::invalid_argument("pool mode must be one of none, max or avg");
+}
+
+template <typename DataType>
+PostProcessor<DataType>::PostProcessor()
+{
+    this->ofmap_h = 0;
+    this->ofmap_w = 0;
+    this->pass_count = 1;
+    this->passes_outer = false;
+    this->element_stride = 1;
+    this->reset();
+}
+
+template <typename DataType>
+void PostProcessor<DataType>::configure(const PostProcessConfig& _config, const vector<int>& _tile_biases,
+                                        unsigned int _pass_count, unsigned int _ofmap_h, unsigned int _ofmap_w,
+                                        bool _passes_outer, unsigned int _element_stride)
+{
+    assert(_pass_count > 0);
+    this->config = _config;
+    this->tile_biases = _tile_biases;
+    this->pass_count = _pass_count;
+    this->ofmap_h = _ofmap_h;
+    this->ofmap_w = _ofmap_w;
+    this->passes_outer = _passes_outer;
+    this->element_stride = _element_stride;
+    this->reset();
+}
+
+template <typename DataType>
+void PostProcessor<DataType>::reset()
+{
+    this->write_counter = 0;
+    this->processed_counter = 0;
+    this->suppressed_write_counter = 0;
+    this->line_buffer.assign(ofmap_w / 2, 0);
+}
+
+template <typename DataType>
+long int PostProcessor<DataType>::activate(long int value, unsigned int tile)
+{
+    if (config.bias)
+    {
+        value += tile_biases.at(tile);
+    }
+    if (config.relu)
+    {
+        value = std::max(value, 0L);
+    }
+    if (config.clamp)
+    {
+        value = std::min(std::max(value, (long int)config.clamp_min), (long int)config.clamp_max);
+    }
+    return value;
+}
+
+template <typename DataType>
+bool PostProcessor<DataType>::process(unsigned int& addr, DataType& data)
+{
+    unsigned int stream_size = ofmap_h * ofmap_w;
+    unsigned int element = write_counter % stream_size;
+    unsigned int tile = write_counter / stream_size;
+    write_counter++;
+
+    unsigned int active_tiles = std::max((unsigned int)tile_biases.size(), 1u);
+    unsigned int pass = (passes_outer) ? tile / active_tiles : tile % pass_count;
+    unsigned int filter_tile = (passes_outer) ? tile % active_tiles : tile / pass_count;
+
+    // partial sums of earlier passes are written back untouched
+    if (pass != pass_count - 1)
+    {
+        return true;
+    }
+
+    processed_counter++;
+    long int value = activate((long int)data, filter_tile);
+
+    if (config.pool == PoolMode::NONE)
+    {
+        data = value;
+        return true;
+    }
+
+    unsigned int i = element / ofmap_w;
+    unsigned int j = element % ofmap_w;
+    unsigned int pooled_h = ofmap_h / 2;
+    unsigned int pooled_w = ofmap_w / 2;
+
+    // trailing odd row/col fall outside any 2x2 window
+    if (i >= pooled_h * 2 || j >= pooled_w * 2)
+    {
+        suppressed_write_counter++;
+        return false;
+    }
+
+    long int& window = line_buffer.at(j / 2);
+    if (i % 2 == 0 && j % 2 == 0)
+    {
+        window = value;
+    }
+    else if (config.pool == PoolMode::MAX)
+    {
+        window = std::max(window, value);
+    }
+    else
+    {
+        window += value;
+    }
+
+    if (i % 2 == 1 && j % 2 == 1)
+    {
+        data = (config.pool == PoolMode::AVG) ? window / 4 : window;
+        addr = addr - element * element_stride + ((i / 2) * pooled_w + (j / 2)) * element_stride;
+        return true;
+    }
+
+    suppressed_write_counter++;
+    return false;
+}
+
+template struct PostProcessor<sc_int<32>>;
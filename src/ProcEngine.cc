@@ -1,8 +1,11 @@
 #include "ProcEngine.hh"
+#include <algorithm>
+#include <stdexcept>
 
 template <typename DataType>
 PE<DataType>::PE(sc_module_name name, sc_trace_file* _tf) : sc_module(name), tf(_tf), psum_in("psum_in"), current_weight("weight")
 {
+    this->weight_reg_capacity = 0;
     this->resetWeightIdx();
     this->resetWeights();
     this->programmed = false;
@@ -42,13 +45,55 @@ template <typename DataType>
 void PE<DataType>::resetWeights()
 {
     this->weights.clear();
+    this->weight_fill = 0;
 }
 
+// Block counterpart of count pushWeight calls. Weight n still lands in slot
+// n % weight_reg_capacity, so with more weights than registers the last lap
+// is copied as one rotated block.
 template <typename DataType>
-void PE<DataType>::loadWeights(vector<int> &weights)
+void PE<DataType>::loadWeights(const int *weights, int count)
 {
-    this->weights = weights;
-    weight_access_counter += weights.size();
+    this->resetWeights();
+    if (weight_reg_capacity && count - weight_idx > weight_reg_capacity)
+    {
+        throw std::runtime_error(string(this->name()) + " weight registers overrun");
+    }
+    int held = (weight_reg_capacity) ? std::min(count, weight_reg_capacity) : count;
+    int first = count - held;
+    int first_slot = (held) ? first % held : 0;
+    this->weights.resize(held);
+    std::rotate_copy(weights + first, weights + count - first_slot, weights + count, this->weights.begin());
+    weight_fill = count;
+    weight_access_counter += count;
+}
+
+template <typename DataType>
+void PE<DataType>::pushWeight(int weight)
+{
+    if (weight_reg_capacity && weight_fill - weight_idx >= weight_reg_capacity)
+    {
+        throw std::runtime_error(string(this->name()) + " weight registers overrun");
+    }
+    unsigned int slot = (weight_reg_capacity) ? weight_fill % weight_reg_capacity : weight_fill;
+    if (slot == this->weights.size())
+    {
+        this->weights.push_back(weight);
+    }
+    else
+    {
+        this->weights[slot] = weight;
+    }
+    weight_fill++;
+    weight_access_counter += 1;
+}
+
+// true when all weight_count weights are still held so the program can be
+// replayed from weight 0 without refetching
+template <typename DataType>
+bool PE<DataType>::weightsResident(int weight_count)
+{
+    return weight_fill == weight_count && (weight_reg_capacity == 0 || weight_reg_capacity >= weight_count);
 }
 
 template <typename DataType>
@@ -73,7 +118,11 @@ void PE<DataType>::updateState()
         
         if (current_desc.state == DescriptorState::GENHOLD)
         {
-            this->current_weight = this->weights[weight_idx];
+            if (weight_idx >= weight_fill)
+            {
+                throw std::runtime_error(string(this->name()) + " weight registers underrun");
+            }
+            this->current_weight = this->weights[(weight_reg_capacity) ? weight_idx % weight_reg_capacity : weight_idx];
             current_desc.x_counter--;
             if (current_desc.x_counter < 0)
             {
@@ -101,14 +150,12 @@ void PE<DataType>::updateState()
         }
         else
         {
-            cout << "ERROR: Invalid Descriptor in pe program" << endl;
-            exit(EXIT_FAILURE);
+            throw std::runtime_error(string(this->name()) + " has an invalid descriptor in its program");
         }
     }
     else
     {
-        cout << "ERROR: Attempted to update pe state without it being programmed" << endl;
-        exit(EXIT_FAILURE);
+        throw std::runtime_error(string(this->name()) + " updated without a program");
     }
 }
 
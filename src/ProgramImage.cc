@@ -0,0 +1,256 @@
+#include "ProgramImage.hh"
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static void put_word(vector<uint8_t>& image, uint32_t word)
+{
+    for (int byte = 0; byte < 4; byte++)
+    {
+        image.push_back((word >> (8 * byte)) & 0xff);
+    }
+}
+
+static uint32_t get_word(const uint8_t* data, size_t word)
+{
+    const uint8_t* bytes = data + 4 * word;
+    return (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) | ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+}
+
+void encode_descriptor(const Descriptor_2D& desc, uint32_t* words)
+{
+    words[0] = desc.next;
+    words[1] = desc.start;
+    words[2] = (uint32_t)desc.state;
+    words[3] = desc.repeat;
+    words[4] = desc.x_count;
+    words[5] = desc.x_modify;
+    words[6] = desc.y_count;
+    words[7] = desc.y_modify;
+    words[8] = desc.x_counter;
+    words[9] = desc.y_counter;
+    words[10] = desc.modulo_base;
+    words[11] = desc.modulo_length;
+}
+
+Descriptor_2D decode_descriptor(const uint32_t* words)
+{
+    Descriptor_2D desc(words[0], words[1], (DescriptorState)words[2], words[4], (int)words[5], words[6], (int)words[7]);
+    desc.repeat = words[3];
+    desc.x_counter = (int)words[8];
+    desc.y_counter = (int)words[9];
+    desc.modulo_base = words[10];
+    desc.modulo_length = words[11];
+    return desc;
+}
+
+vector<uint8_t> ProgramImage::encode() const
+{
+    assert(weight_region_base.size() == weight_channel_count);
+    assert(weights.size() == (size_t)weight_words * weight_lanes);
+    unsigned int descriptor_count = 0;
+    for (auto& entry : programs)
+    {
+        descriptor_count += entry.program.size();
+    }
+
+    vector<uint8_t> image(PROGRAM_IMAGE_MAGIC, PROGRAM_IMAGE_MAGIC + strlen(PROGRAM_IMAGE_MAGIC));
+    put_word(image, PROGRAM_IMAGE_VERSION);
+    for (uint32_t word : {filter_count, channel_count, weight_channel_count, weight_lanes})
+    {
+        put_word(image, word);
+    }
+    for (int dim : {layer.c_in, layer.f_out, layer.k, layer.ofmap_h, layer.ofmap_w})
+    {
+        put_word(image, dim);
+    }
+    put_word(image, weight_preload_cycles);
+    put_word(image, programs.size());
+    put_word(image, descriptor_count);
+    put_word(image, weight_words);
+    put_word(image, 0); // reserved
+
+    unsigned int first = 0;
+    for (auto& entry : programs)
+    {
+        put_word(image, (uint32_t)entry.target);
+        put_word(image, entry.index);
+        put_word(image, first);
+        put_word(image, entry.program.size());
+        first += entry.program.size();
+    }
+    for (int base : weight_region_base)
+    {
+        put_word(image, base);
+    }
+    for (auto& entry : programs)
+    {
+        for (auto& desc : entry.program)
+        {
+            uint32_t words[PROGRAM_IMAGE_DESCRIPTOR_WORDS];
+            encode_descriptor(desc, words);
+            for (uint32_t word : words)
+            {
+                put_word(image, word);
+            }
+        }
+    }
+    for (int weight : weights)
+    {
+        put_word(image, weight);
+    }
+    return image;
+}
+
+void ProgramImage::save(const string& path) const
+{
+    auto image = encode();
+    std::ofstream file(path, std::ios::binary);
+    if (!file.write((const char*)image.data(), image.size()))
+    {
+        throw std::runtime_error("could not write program image " + path);
+    }
+}
+
+ProgramImageView::ProgramImageView(const uint8_t* _data, size_t _size)
+    : data(_data), size(_size)
+{
+    size_t magic_length = strlen(PROGRAM_IMAGE_MAGIC);
+    if (size < 4 * PROGRAM_IMAGE_HEADER_WORDS || memcmp(data, PROGRAM_IMAGE_MAGIC, magic_length) != 0 || get_word(data, 1) != PROGRAM_IMAGE_VERSION)
+    {
+        throw std::runtime_error("not a version " + std::to_string(PROGRAM_IMAGE_VERSION) + " program image");
+    }
+    filter_count = get_word(data, 2);
+    channel_count = get_word(data, 3);
+    weight_channel_count = get_word(data, 4);
+    weight_lanes = get_word(data, 5);
+    layer = {(int)get_word(data, 6), (int)get_word(data, 7), (int)get_word(data, 8), (int)get_word(data, 9), (int)get_word(data, 10)};
+    weight_preload_cycles = get_word(data, 11);
+    program_count = get_word(data, 12);
+    descriptor_count = get_word(data, 13);
+    weight_words = get_word(data, 14);
+
+    // in 64 bits so corrupt counts can't wrap past the check
+    uint64_t words = PROGRAM_IMAGE_HEADER_WORDS + (uint64_t)program_count * PROGRAM_IMAGE_ENTRY_WORDS + weight_channel_count +
+                     (uint64_t)descriptor_count * PROGRAM_IMAGE_DESCRIPTOR_WORDS + (uint64_t)weight_words * weight_lanes;
+    if (4 * words != size)
+    {
+        throw std::runtime_error("program image is " + std::to_string(size) + " bytes, its header describes " + std::to_string(4 * words));
+    }
+    for (unsigned int entry = 0; entry < program_count; entry++)
+    {
+        size_t offset = entries_offset() + entry * PROGRAM_IMAGE_ENTRY_WORDS;
+        uint64_t end = (uint64_t)get_word(data, offset + 2) + get_word(data, offset + 3);
+        if (get_word(data, offset) > (uint32_t)ProgramTarget::PE || end > descriptor_count)
+        {
+            throw std::runtime_error("program image entry " + std::to_string(entry) + " is out of range");
+        }
+    }
+}
+
+size_t ProgramImageView::entries_offset() const
+{
+    return PROGRAM_IMAGE_HEADER_WORDS;
+}
+
+size_t ProgramImageView::region_base_offset() const
+{
+    return entries_offset() + (size_t)program_count * PROGRAM_IMAGE_ENTRY_WORDS;
+}
+
+size_t ProgramImageView::descriptors_offset() const
+{
+    return region_base_offset() + weight_channel_count;
+}
+
+size_t ProgramImageView::weights_offset() const
+{
+    return descriptors_offset() + (size_t)descriptor_count * PROGRAM_IMAGE_DESCRIPTOR_WORDS;
+}
+
+ProgramTarget ProgramImageView::target(unsigned int program) const
+{
+    assert(program < program_count);
+    return (ProgramTarget)get_word(data, entries_offset() + program * PROGRAM_IMAGE_ENTRY_WORDS);
+}
+
+unsigned int ProgramImageView::index(unsigned int program) const
+{
+    assert(program < program_count);
+    return get_word(data, entries_offset() + program * PROGRAM_IMAGE_ENTRY_WORDS + 1);
+}
+
+vector<Descriptor_2D> ProgramImageView::program(unsigned int program) const
+{
+    assert(program < program_count);
+    size_t entry = entries_offset() + program * PROGRAM_IMAGE_ENTRY_WORDS;
+    unsigned int first = get_word(data, entry + 2);
+    unsigned int length = get_word(data, entry + 3);
+
+    vector<Descriptor_2D> decoded;
+    for (unsigned int idx = 0; idx < length; idx++)
+    {
+        size_t offset = descriptors_offset() + (size_t)(first + idx) * PROGRAM_IMAGE_DESCRIPTOR_WORDS;
+        uint32_t words[PROGRAM_IMAGE_DESCRIPTOR_WORDS];
+        for (int word = 0; word < PROGRAM_IMAGE_DESCRIPTOR_WORDS; word++)
+        {
+            words[word] = get_word(data, offset + word);
+        }
+        if (words[0] >= length || words[2] > (uint32_t)DescriptorState::RGENWAIT)
+        {
+            throw std::runtime_error("program " + std::to_string(program) + " descriptor " + std::to_string(idx) + " is malformed");
+        }
+        decoded.push_back(decode_descriptor(words));
+    }
+    return decoded;
+}
+
+int ProgramImageView::region_base(unsigned int channel) const
+{
+    assert(channel < weight_channel_count);
+    return (int)get_word(data, region_base_offset() + channel);
+}
+
+int ProgramImageView::weight(unsigned int addr, unsigned int lane) const
+{
+    assert(addr < weight_words && lane < weight_lanes);
+    return (int)get_word(data, weights_offset() + (size_t)addr * weight_lanes + lane);
+}
+
+MappedProgramImage::MappedProgramImage(const string& path)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        throw std::runtime_error("could not open program image " + path);
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 || file_stat.st_size == 0)
+    {
+        close(fd);
+        throw std::runtime_error("program image " + path + " is empty");
+    }
+    size = file_stat.st_size;
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // the mapping keeps the file referenced on its own
+    close(fd);
+    if (mapped == MAP_FAILED)
+    {
+        throw std::runtime_error("could not map program image " + path);
+    }
+    data = (const uint8_t*)mapped;
+}
+
+MappedProgramImage::~MappedProgramImage()
+{
+    munmap((void*)data, size);
+}
+
+ProgramImageView MappedProgramImage::view() const
+{
+    return ProgramImageView(data, size);
+}
@@ -0,0 +1,149 @@
+#include "ReferenceModel.hh"
+#include <iostream>
+#include <xtensor/xio.hpp>
+#include <xtensor/xview.hpp>
+#include <xtensor-blas/xlinalg.hpp>
+
+xt::xarray<int> generate_ifmap(int channel_in, int ifmap_h, int ifmap_w)
+{
+    xt::xarray<int> ifmap = xt::arange((int)1, channel_in * ifmap_h * ifmap_w + 1);
+    ifmap.reshape({channel_in, ifmap_h, ifmap_w});
+    return ifmap;
+}
+
+xt::xarray<int> generate_weights(int filter_out_dim, int channel_in_dim, int kernel)
+{
+    xt::xarray<int> weights = xt::arange(1, channel_in_dim * filter_out_dim * kernel * kernel + 1);
+    weights.reshape({filter_out_dim, channel_in_dim, kernel, kernel});
+    return weights;
+}
+
+xt::xarray<int> generate_expected_output(xt::xarray<int> ifmap, xt::xarray<int> weights)
+{
+    // weights.shape() = F*C*K*K
+    assert(weights.shape().size() == 4);
+    // cout << xt::adapt(weights.shape()) << endl;
+    // ifmap.shape() = C*H*W
+    assert(ifmap.shape().size() == 3);
+    // cout << xt::adapt(ifmap.shape()) << endl;
+    // cout << ifmap << endl;
+    // symmetric kernel
+    assert(weights.shape(3) == weights.shape(2));
+
+    // ifmap channel = weights channel in
+    assert(ifmap.shape(0) == weights.shape(1));
+    int ifmap_w = ifmap.shape(2);
+    int ifmap_h = ifmap.shape(1);
+
+    int kernel = weights.shape(3);
+    assert(ifmap_w >= kernel);
+    assert(ifmap_h >= kernel);
+
+    int ofmap_w = ifmap_w - (kernel - 1);
+    int ofmap_h = ifmap_h - (kernel - 1);
+    int ofmap_c = weights.shape(0);
+
+    xt::xarray<int> ofmap = xt::arange(ofmap_c * ofmap_w * ofmap_h).reshape({ofmap_c, ofmap_h, ofmap_w});
+
+    // conv2d stride 1
+    for (auto f = 0; f < ofmap_c; f++)
+    {
+        auto weight_tensor_view = xt::view(weights, f, xt::all(), xt::all(), xt::all());
+        xt::xarray<int> flatten_weight(xt::flatten(weight_tensor_view));
+        for (auto h = 0; h < ofmap_h; h++)
+        {
+            for (auto w = 0; w < ofmap_w; w++)
+            {
+                auto ifmap_tensor_view = xt::view(ifmap, xt::all(), xt::range(h, h + kernel), xt::range(w, w + kernel));
+                xt::xarray<int> flattened_ifmap(xt::flatten(ifmap_tensor_view));
+                auto val = xt::linalg::dot(flattened_ifmap, flatten_weight);
+                ofmap(f, h, w) = val(0);
+            }
+        }
+    }
+
+    return ofmap;
+}
+
+xt::xarray<int> generate_biases(xt::xarray<int> ofmap)
+{
+    int ofmap_c = ofmap.shape(0);
+    int stream_size = ofmap.shape(1) * ofmap.shape(2);
+    xt::xarray<int> biases = xt::zeros<int>({ofmap_c});
+    for (int f = 0; f < ofmap_c; f++)
+    {
+        long int sum = 0;
+        for (int h = 0; h < (int)ofmap.shape(1); h++)
+        {
+            for (int w = 0; w < (int)ofmap.shape(2); w++)
+            {
+                sum += ofmap(f, h, w);
+            }
+        }
+        biases(f) = -(sum / stream_size);
+    }
+    return biases;
+}
+
+xt::xarray<int> generate_expected_post_processed_output(xt::xarray<int> ofmap, xt::xarray<int> biases, const PostProcessConfig &config)
+{
+    int ofmap_c = ofmap.shape(0);
+    int ofmap_h = ofmap.shape(1);
+    int ofmap_w = ofmap.shape(2);
+
+    xt::xarray<int> activated = xt::zeros<int>({ofmap_c, ofmap_h, ofmap_w});
+    for (int f = 0; f < ofmap_c; f++)
+    {
+        for (int h = 0; h < ofmap_h; h++)
+        {
+            for (int w = 0; w < ofmap_w; w++)
+            {
+                long int value = ofmap(f, h, w);
+                value += (config.bias) ? biases(f) : 0;
+                value = (config.relu) ? std::max(value, 0L) : value;
+                value = (config.clamp) ? std::min(std::max(value, (long int)config.clamp_min), (long int)config.clamp_max) : value;
+                activated(f, h, w) = value;
+            }
+        }
+    }
+
+    if (config.pool == PoolMode::NONE)
+    {
+        return activated;
+    }
+
+    int pooled_h = ofmap_h / 2;
+    int pooled_w = ofmap_w / 2;
+    xt::xarray<int> pooled = xt::zeros<int>({ofmap_c, pooled_h, pooled_w});
+    for (int f = 0; f < ofmap_c; f++)
+    {
+        for (int h = 0; h < pooled_h; h++)
+        {
+            for (int w = 0; w < pooled_w; w++)
+            {
+                auto window = xt::view(activated, f, xt::range(2 * h, 2 * h + 2), xt::range(2 * w, 2 * w + 2));
+                long int max = window(0, 0);
+                long int sum = 0;
+                for (int i = 0; i < 2; i++)
+                {
+                    for (int j = 0; j < 2; j++)
+                    {
+                        max = std::max(max, (long int)window(i, j));
+                        sum += window(i, j);
+                    }
+                }
+                pooled(f, h, w) = (config.pool == PoolMode::MAX) ? max : sum / 4;
+            }
+        }
+    }
+    return pooled;
+}
+
+bool validate_expected_output(xt::xarray<int> expected, xt::xarray<int> result)
+{
+    // cout << "EXPECTED RESULT" << endl;
+    // cout << expected << endl;
+    // cout << "ACTUAL RESULT" << endl;
+    // cout << result << endl;
+    return expected == result;
+}
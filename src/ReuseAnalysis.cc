@@ -0,0 +1,174 @@
+#include "ReuseAnalysis.hh"
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+vector<unsigned int> expand_program(const vector<Descriptor_2D>& program, unsigned long int max_addresses)
+{
+    vector<unsigned int> stream;
+    unsigned int execute_index = 0;
+    unsigned long int visited = 0;
+    while (execute_index < program.size() && stream.size() < max_addresses)
+    {
+        const Descriptor_2D& desc = program[execute_index];
+        if (desc.state == DescriptorState::SUSPENDED)
+        {
+            break;
+        }
+        if (desc.state == DescriptorState::GENERATE)
+        {
+            long int index = desc.start;
+            for (unsigned int row = 0; row <= desc.y_count && stream.size() < max_addresses; row++)
+            {
+                for (unsigned int column = 0; column <= desc.x_count && stream.size() < max_addresses; column++)
+                {
+                    stream.push_back(index);
+                    if (column != desc.x_count)
+                    {
+                        index = desc.wrap(index + desc.x_modify);
+                    }
+                }
+                index = desc.wrap(index + desc.y_modify);
+            }
+        }
+        else if (desc.state != DescriptorState::WAIT)
+        {
+            // the generator itself rejects GENHOLD and RGENWAIT
+            break;
+        }
+        // a loop of WAITs never adds addresses
+        if (++visited > max_addresses)
+        {
+            break;
+        }
+        execute_index = desc.next;
+    }
+    return stream;
+}
+
+vector<unsigned int> interleave_streams(const vector<vector<unsigned int>>& streams)
+{
+    vector<unsigned int> interleaved;
+    size_t longest = 0;
+    for (auto& stream : streams)
+    {
+        longest = std::max(longest, stream.size());
+    }
+    for (size_t idx = 0; idx < longest; idx++)
+    {
+        for (auto& stream : streams)
+        {
+            if (idx < stream.size())
+            {
+                interleaved.push_back(stream[idx]);
+            }
+        }
+    }
+    return interleaved;
+}
+
+// Stack distances in O(n log n): a Fenwick tree over access times marks the
+// latest access of every address, the distance of an access is the number
+// of marks after its address's previous access.
+ReuseProfile::ReuseProfile(const vector<unsigned int>& stream, unsigned long int _window)
+    : accesses(stream.size()), footprint(0), window(_window)
+{
+    assert(window > 0);
+    vector<long int> marks(stream.size() + 1, 0);
+    auto add = [&](size_t pos, long int delta) {
+        for (pos++; pos < marks.size(); pos += pos & (~pos + 1))
+        {
+            marks[pos] += delta;
+        }
+    };
+    auto prefix = [&](size_t pos) {
+        long int sum = 0;
+        for (pos++; pos > 0; pos -= pos & (~pos + 1))
+        {
+            sum += marks[pos];
+        }
+        return sum;
+    };
+
+    std::unordered_map<unsigned int, size_t> last_access;
+    std::unordered_set<unsigned int> window_addresses;
+    for (size_t time = 0; time < stream.size(); time++)
+    {
+        auto last = last_access.find(stream[time]);
+        if (last == last_access.end())
+        {
+            footprint++;
+        }
+        else
+        {
+            reuse[prefix(time) - prefix(last->second)]++;
+            add(last->second, -1);
+        }
+        add(time, 1);
+        last_access[stream[time]] = time;
+
+        window_addresses.insert(stream[time]);
+        if ((time + 1) % window == 0 || time + 1 == stream.size())
+        {
+            working_set.push_back(window_addresses.size());
+            window_addresses.clear();
+        }
+    }
+}
+
+double ReuseProfile::hit_rate(unsigned long int capacity) const
+{
+    unsigned long int hits = 0;
+    for (auto it = reuse.begin(); it != reuse.end() && it->first < capacity; it++)
+    {
+        hits += it->second;
+    }
+    return (accesses) ? (double)hits / accesses : 0.0;
+}
+
+double ReuseProfile::max_hit_rate() const
+{
+    return (accesses) ? (double)(accesses - footprint) / accesses : 0.0;
+}
+
+long int ReuseProfile::min_buffer_size(double target) const
+{
+    if (target <= 0.0)
+    {
+        return 0;
+    }
+    unsigned long int hits = 0;
+    for (auto& bucket : reuse)
+    {
+        hits += bucket.second;
+        if ((double)hits / accesses >= target)
+        {
+            return bucket.first + 1;
+        }
+    }
+    return -1;
+}
+
+unsigned long int ReuseProfile::peak_working_set() const
+{
+    return (working_set.empty()) ? 0 : *std::max_element(working_set.begin(), working_set.end());
+}
+
+vector<unsigned long int> ReuseProfile::log2_histogram() const
+{
+    vector<unsigned long int> histogram;
+    for (auto& bucket : reuse)
+    {
+        size_t bin = 0;
+        for (unsigned long int distance = bucket.first; distance > 0; distance >>= 1)
+        {
+            bin++;
+        }
+        if (histogram.size() <= bin)
+        {
+            histogram.resize(bin + 1, 0);
+        }
+        histogram[bin] += bucket.second;
+    }
+    return histogram;
+}
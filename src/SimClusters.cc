@@ -0,0 +1,302 @@
+#include "SimClusters.hh"
+#include "DramArbiter.hh"
+#include "ReferenceModel.hh"
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <iomanip>
+#include <memory>
+#include <xtensor/xview.hpp>
+#include "iconnect.h"
+#include "memory.h"
+
+using std::deque;
+using std::chrono::duration_cast;
+using std::chrono::high_resolution_clock;
+using std::chrono::milliseconds;
+
+struct DramBurst
+{
+    tlm::tlm_command cmd;
+    sc_dt::uint64 addr;
+    vector<int> data;
+    std::function<void(const vector<int> &)> on_read; // consumes the data of a completed read
+};
+
+// Issues the queued bursts of every port, always serving the port that is
+// furthest behind on its own timeline so clusters interleave at the shared
+// DRAM the way concurrent masters would. Returns the length of the phase.
+static sc_time dispatch_bursts(vector<std::unique_ptr<DramPort>> &ports, vector<deque<DramBurst>> &queues)
+{
+    while (1)
+    {
+        int next = -1;
+        for (unsigned int port = 0; port < queues.size(); port++)
+        {
+            if (!queues[port].empty() && (next == -1 || ports[port]->local_time < ports[next]->local_time))
+            {
+                next = port;
+            }
+        }
+        if (next == -1)
+        {
+            break;
+        }
+        DramBurst &burst = queues[next].front();
+        ports[next]->transfer(burst.cmd, burst.addr, (unsigned char *)burst.data.data(), burst.data.size() * sizeof(int));
+        if (burst.on_read)
+        {
+            burst.on_read(burst.data);
+        }
+        queues[next].pop_front();
+    }
+
+    sc_time phase = SC_ZERO_TIME;
+    for (unsigned int port = 0; port < queues.size(); port++)
+    {
+        phase = (ports[port]->local_time > phase) ? ports[port]->local_time : phase;
+    }
+    return phase;
+}
+
+static void dram_backdoor(memory &dram, tlm::tlm_command cmd, sc_dt::uint64 addr, vector<int> &data)
+{
+    tlm::tlm_generic_payload trans;
+    trans.set_command(cmd);
+    trans.set_address(addr);
+    trans.set_data_ptr((unsigned char *)data.data());
+    trans.set_data_length(data.size() * sizeof(int));
+    dram.transport_dbg(trans);
+}
+
+template <typename DataType>
+void sim_clusters_and_get_results(const RunOptions &options)
+{
+    auto t1 = high_resolution_clock::now();
+
+    bool pooled = options.post_process_config.pool != PoolMode::NONE;
+    int ofmap_h = (options.ifmap_h - options.k + 1);
+    int ofmap_w = (options.ifmap_w - options.k + 1);
+    int out_h = (pooled) ? ofmap_h / 2 : ofmap_h;
+    int out_w = (pooled) ? ofmap_w / 2 : ofmap_w;
+    auto work = partition_cluster_work(options.partition, options.cluster_count, options.f_out, ofmap_h, (pooled) ? 2 : 1);
+
+    xt::print_options::set_threshold(10000);
+    xt::print_options::set_line_width(100);
+
+    // golden model and the DRAM image: ifmap, then weights, then the ofmap
+    xt::xarray<int> ifmap = xt::arange((int)1, options.c_in * options.ifmap_h * options.ifmap_w + 1);
+    ifmap.reshape({options.c_in, options.ifmap_h, options.ifmap_w});
+    xt::xarray<int> weights = generate_weights(options.f_out, options.c_in, options.k);
+    xt::xarray<int> expected_ofmap = generate_expected_output(ifmap, weights);
+    xt::xarray<int> biases = generate_biases(expected_ofmap);
+    if (options.post_process_config.enabled())
+    {
+        expected_ofmap = generate_expected_post_processed_output(expected_ofmap, biases, options.post_process_config);
+    }
+
+    int filter_size = options.c_in * options.k * options.k;
+    sc_dt::uint64 weight_base = ifmap.size() * sizeof(int);
+    sc_dt::uint64 ofmap_base = weight_base + weights.size() * sizeof(int);
+    sc_dt::uint64 dram_size = ofmap_base + expected_ofmap.size() * sizeof(int);
+
+    sc_trace_file *tf = sc_create_vcd_trace_file("Arch1x1");
+    tf->set_time_unit(100, SC_PS);
+
+    sc_time cycle(1, SC_NS);
+    GlobalControlChannel control("global_control_channel", cycle, tf);
+    iconnect<MAX_CLUSTERS, 1> bus("bus");
+    DramArbiter arbiter("dram_arbiter", cycle, options.dram_words_per_cycle * sizeof(int), MAX_CLUSTERS);
+    memory dram("dram", cycle * options.dram_latency, dram_size);
+    bus.memmap(0, dram_size, ADDRMODE_RELATIVE, -1, arbiter.target_socket);
+    arbiter.init_socket.bind(dram.socket);
+
+    vector<std::unique_ptr<Arch<DataType>>> clusters;
+    vector<Arch<DataType> *> cluster_ptrs;
+    vector<std::unique_ptr<DramPort>> ports;
+    Mapping full_array = Mapping::full_array(ArrayShape{options.filter_count, options.channel_count, 0, 0});
+    for (int cluster = 0; cluster < options.cluster_count; cluster++)
+    {
+        int in_rows = work[cluster].row_count + options.k - 1;
+        int ifmap_mem_size = options.c_in * in_rows * options.ifmap_w;
+        int psum_mem_size = work[cluster].filter_out * work[cluster].row_count * ofmap_w;
+        string name = "cluster_" + std::to_string(cluster);
+        int weight_mem_size = padded_weight_size(full_array, options.filter_count, options.channel_count, work[cluster].filter_out, options.c_in, options.k);
+        clusters.emplace_back(new Arch<DataType>(name.c_str(), control, options.filter_count, options.channel_count, psum_mem_size, ifmap_mem_size, weight_mem_size, tf));
+        cluster_ptrs.push_back(clusters.back().get());
+    }
+    // every interconnect target socket needs a master bound, spare ports stay idle
+    for (int port = 0; port < MAX_CLUSTERS; port++)
+    {
+        string name = "dram_port_" + std::to_string(port);
+        ports.emplace_back(new DramPort(name.c_str(), port));
+        ports.back()->socket.bind(*bus.t_sk[port]);
+        bus.set_target_offset(port, 0);
+    }
+    ClusterMonitor<DataType> monitor("cluster_monitor", control, cluster_ptrs);
+
+    unsigned long int start_cycle_time = sc_time_stamp().value();
+    control.set_reset(true);
+    sc_start(10, SC_NS);
+    control.set_reset(false);
+    sc_start(1, SC_NS);
+
+    vector<int> image(ifmap.begin(), ifmap.end());
+    dram_backdoor(dram, tlm::TLM_WRITE_COMMAND, 0, image);
+    image.assign(weights.begin(), weights.end());
+    dram_backdoor(dram, tlm::TLM_WRITE_COMMAND, weight_base, image);
+
+    // load phase, each cluster fetches its ifmap rows and filters
+    sc_time run_start = sc_time_stamp();
+    vector<xt::xarray<int>> cluster_weights(options.cluster_count);
+    vector<deque<DramBurst>> queues(MAX_CLUSTERS);
+    for (int cluster = 0; cluster < options.cluster_count; cluster++)
+    {
+        auto &arch = *clusters[cluster];
+        int in_rows = work[cluster].row_count + options.k - 1;
+        cluster_weights[cluster] = xt::zeros<int>({work[cluster].filter_out, options.c_in, options.k, options.k});
+        for (int c = 0; c < options.c_in; c++)
+        {
+            for (int i = 0; i < in_rows; i++)
+            {
+                sc_dt::uint64 addr = (c * options.ifmap_h * options.ifmap_w + (work[cluster].row_start + i) * options.ifmap_w) * sizeof(int);
+                queues[cluster].push_back({tlm::TLM_READ_COMMAND, addr, vector<int>(options.ifmap_w), [&arch, &options, c, i, in_rows](const vector<int> &row) {
+                                               for (int j = 0; j < options.ifmap_w; j++)
+                                               {
+                                                   arch.ifmap_mem.mem.ram.at(c * (in_rows * options.ifmap_w) + i * options.ifmap_w + j).at(0).write(row[j]);
+                                                   arch.ifmap_mem.mem.access_counter++;
+                                                   arch.dram_access_counter++;
+                                               }
+                                           }});
+            }
+        }
+        for (int f = 0; f < work[cluster].filter_out; f++)
+        {
+            sc_dt::uint64 addr = weight_base + (work[cluster].filter_start + f) * filter_size * sizeof(int);
+            xt::xarray<int> &filters = cluster_weights[cluster];
+            queues[cluster].push_back({tlm::TLM_READ_COMMAND, addr, vector<int>(filter_size), [&filters, f, filter_size](const vector<int> &filter) {
+                                           std::copy(filter.begin(), filter.end(), filters.data() + f * filter_size);
+                                       }});
+        }
+    }
+    vector<sc_time> load_time(options.cluster_count);
+    sc_time load_phase = dispatch_bursts(ports, queues);
+    for (int cluster = 0; cluster < options.cluster_count; cluster++)
+    {
+        load_time[cluster] = ports[cluster]->local_time;
+        ports[cluster]->local_time = SC_ZERO_TIME;
+    }
+    sc_start(load_phase + cycle);
+
+    // compute phase, the clusters share the global control and run in lock step
+    for (int cluster = 0; cluster < options.cluster_count; cluster++)
+    {
+        auto &arch = *clusters[cluster];
+        int in_rows = work[cluster].row_count + options.k - 1;
+        set_channel_modes(arch);
+        WeightTiles tiles = load_weights(arch, cluster_weights[cluster]);
+        generate_and_load_pe_program(arch, tiles, in_rows, options.ifmap_w);
+        generate_and_load_ifmap_in_program(arch, tiles, in_rows, options.ifmap_w);
+        generate_and_load_psum_program(arch, tiles, work[cluster].row_count, ofmap_w);
+        xt::xarray<int> cluster_biases = xt::view(biases, xt::range(work[cluster].filter_start, work[cluster].filter_start + work[cluster].filter_out));
+        generate_and_load_post_processors(arch, tiles, cluster_biases, work[cluster].row_count, ofmap_w, options.post_process_config);
+        ArrayShape array{options.filter_count, options.channel_count, 0, 0};
+        arm_watchdog(arch, options.watchdog_config, estimate_mapping_cost(full_array, {options.c_in, work[cluster].filter_out, options.k, work[cluster].row_count, ofmap_w}, array).cycles);
+    }
+
+    control.set_program(true);
+    sc_start(1, SC_NS);
+    sc_time compute_start = sc_time_stamp();
+    control.set_enable(true);
+    control.set_program(false);
+    sc_start();
+    control.set_enable(false);
+    for (auto &cluster : clusters)
+    {
+        if (watchdog_stopped(*cluster))
+        {
+            return;
+        }
+    }
+
+    // store phase, each cluster writes back its slice of the ofmap
+    for (int cluster = 0; cluster < options.cluster_count; cluster++)
+    {
+        auto &arch = *clusters[cluster];
+        int stream_size = work[cluster].row_count * ofmap_w;
+        int rows = (pooled) ? work[cluster].row_count / 2 : work[cluster].row_count;
+        int row_start = (pooled) ? work[cluster].row_start / 2 : work[cluster].row_start;
+        for (int f = 0; f < work[cluster].filter_out; f++)
+        {
+            for (int i = 0; i < rows; i++)
+            {
+                vector<int> row(out_w);
+                for (int j = 0; j < out_w; j++)
+                {
+                    row[j] = arch.psum_mem.mem.ram.at(f * stream_size + i * out_w + j).at(0).read();
+                    arch.psum_mem.mem.access_counter++;
+                    arch.dram_access_counter++;
+                }
+                sc_dt::uint64 addr = ofmap_base + ((work[cluster].filter_start + f) * out_h * out_w + (row_start + i) * out_w) * sizeof(int);
+                queues[cluster].push_back({tlm::TLM_WRITE_COMMAND, addr, row, nullptr});
+            }
+        }
+    }
+    vector<sc_time> store_time(options.cluster_count);
+    sc_time store_phase = dispatch_bursts(ports, queues);
+    for (int cluster = 0; cluster < options.cluster_count; cluster++)
+    {
+        store_time[cluster] = ports[cluster]->local_time;
+    }
+    sc_start(store_phase + cycle);
+
+    image.assign(expected_ofmap.size(), 0);
+    dram_backdoor(dram, tlm::TLM_READ_COMMAND, ofmap_base, image);
+    xt::xarray<int> res = xt::adapt(image, expected_ofmap.shape());
+
+    auto valid = validate_expected_output(expected_ofmap, res);
+    unsigned long int end_cycle_time = sc_time_stamp().value();
+
+    auto t2 = high_resolution_clock::now();
+    auto sim_time = duration_cast<milliseconds>(t2 - t1);
+
+    if (valid)
+    {
+        cout << "PASS" << endl;
+        unsigned long int dram_access = 0;
+        unsigned long int total_macs = 0;
+        int psum_access = 0;
+        int ifmap_access = 0;
+        for (int cluster = 0; cluster < options.cluster_count; cluster++)
+        {
+            auto &arch = *clusters[cluster];
+            unsigned long int macs = (unsigned long int)work[cluster].filter_out * filter_size * work[cluster].row_count * ofmap_w;
+            sc_time latency = load_time[cluster] + (arch.suspend_time - compute_start) + store_time[cluster];
+            string label = "Cluster " + std::to_string(cluster) + " ";
+            cout << std::left << std::setw(20) << label + "DRAM" << arbiter.byte_counter[cluster] / sizeof(int) << endl;
+            cout << std::left << std::setw(20) << label + "Stall" << arbiter.stall_time[cluster] / cycle << endl;
+            cout << std::left << std::setw(20) << label + "Latency" << latency / cycle << endl;
+            cout << std::left << std::setw(20) << label + "MAC/cycle" << std::setprecision(4) << macs / (latency / cycle) << endl;
+            dram_access += arbiter.byte_counter[cluster] / sizeof(int);
+            total_macs += macs;
+            psum_access += arch.psum_mem.mem.access_counter;
+            ifmap_access += arch.ifmap_mem.mem.access_counter;
+        }
+        sc_time busy_window = sc_time_stamp() - run_start;
+        cout << std::left << std::setw(20) << "DRAM Access" << dram_access << endl;
+        cout << std::left << std::setw(20) << "DRAM Stall Cycles" << arbiter.total_stall_time() / cycle << endl;
+        cout << std::left << std::setw(20) << "DRAM Utilization" << std::setprecision(2) << arbiter.busy_time / busy_window << endl;
+        cout << std::left << std::setw(20) << "Throughput" << std::setprecision(4) << total_macs / (busy_window / cycle) << endl;
+        cout << std::left << std::setw(20) << "Psum Access" << psum_access << endl;
+        cout << std::left << std::setw(20) << "Ifmap Access" << ifmap_access << endl;
+        cout << std::left << std::setw(20) << "Latency in cycles" << end_cycle_time - start_cycle_time << endl;
+        cout << std::left << std::setw(20) << "Simulated in " << sim_time.count() << "ms\n";
+        exit(EXIT_SUCCESS); // avoids expensive de-alloc
+    }
+    else
+    {
+        cout << "FAIL" << endl;
+    }
+}
+
+template void sim_clusters_and_get_results<sc_int<32>>(const RunOptions &options);
@@ -0,0 +1,277 @@
+#include "SimExtrapolated.hh"
+#include "Arch.hh"
+#include "Extrapolation.hh"
+#include "ReferenceModel.hh"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <stdexcept>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using std::chrono::duration_cast;
+using std::chrono::high_resolution_clock;
+using std::chrono::milliseconds;
+
+struct TileMetrics
+{
+    double cycles;         // enable to done, fill included
+    double fill_cycles;    // enable to the first psum write, measured
+    double preload_cycles; // the weight preload part of the fill, from the weight program
+    int weight_lines;      // weight SAM lines per tile of the slowest weight channel
+    double ifmap_access;
+    double psum_access;
+    double weight_access; // PE weight register reads
+    double weight_sam_access;
+    int valid;
+};
+
+// Detailed run of one tile in isolation over `rows` ofmap rows: a 1x1 layer
+// with the tile's filters and reduction columns as input channels, which
+// streams, fills and loads weights the way the tile does inside the full
+// layer.
+template <typename DataType>
+TileMetrics simulate_tile(int filter_count, int channel_count, const Mapping &mapping, const WeightBufferConfig &weight_config, const WatchdogConfig &watchdog_config, int filters, int c_in, int rows, int ofmap_w)
+{
+    const int k = 1;
+    int ifmap_h = rows;
+    int ifmap_w = ofmap_w;
+    int stream_size = rows * ofmap_w;
+    sc_trace_file *tf = sc_create_vcd_trace_file("ExtrapolatedTile");
+    tf->set_time_unit(100, SC_PS);
+
+    GlobalControlChannel control("global_control_channel", sc_time(1, SC_NS), tf);
+    ArrayShape array{filter_count, channel_count, c_in * ifmap_h * ifmap_w, filters * stream_size};
+    int weight_mem_size = padded_weight_size(mapping, mapping.filter_rows(array), mapping.channel_cols(array), filters, c_in, k);
+    Arch<DataType> arch("arch", control, mapping.filter_rows(array), mapping.channel_cols(array), array.psum_mem_size, array.ifmap_mem_size, weight_mem_size, tf, weight_config);
+    arch.mapping = mapping;
+
+    control.set_reset(true);
+    sc_start(10, SC_NS);
+    control.set_reset(false);
+    sc_start(1, SC_NS);
+
+    xt::xarray<int> weights;
+    WeightTiles tiles;
+    auto ifmap = dram_load(arch, c_in, ifmap_h, ifmap_w);
+    set_channel_modes(arch);
+    std::tie(weights, tiles) = generate_and_load_weights(arch, filters, c_in, k);
+    generate_and_load_pe_program(arch, tiles, ifmap_h, ifmap_w);
+    generate_and_load_ifmap_in_program(arch, tiles, ifmap_h, ifmap_w);
+    generate_and_load_psum_program(arch, tiles, rows, ofmap_w);
+    auto expected_ofmap = generate_expected_output(ifmap, weights);
+    generate_and_load_post_processors(arch, tiles, generate_biases(expected_ofmap), rows, ofmap_w, PostProcessConfig());
+    arm_watchdog(arch, watchdog_config, estimate_mapping_cost(mapping, {c_in, filters, k, rows, ofmap_w}, array).cycles + arch.weight_preload_cycles);
+
+    control.set_program(true);
+    sc_start(1, SC_NS);
+    control.set_enable(true);
+    control.set_program(false);
+    sc_time start = sc_time_stamp();
+    // the fill ends where the first psum write generator leaves its lead
+    // delay, the same tile boundary fast-forward measures at
+    auto &tile_clock = arch.psum_mem.generators.at(0);
+    while (tile_clock.execute_index.read() < 1 && !arch.suspended && !arch.hung)
+    {
+        sc_start(1, SC_NS);
+    }
+    sc_time filled = sc_time_stamp();
+    if (!arch.suspended && !arch.hung)
+    {
+        sc_start();
+    }
+    if (arch.hung)
+    {
+        throw std::runtime_error("watchdog stopped the run, " + arch.watchdog.reason());
+    }
+
+    TileMetrics metrics;
+    metrics.cycles = (sc_time_stamp() - start) / sc_time(1, SC_NS);
+    metrics.fill_cycles = (filled - start) / sc_time(1, SC_NS);
+    metrics.preload_cycles = arch.weight_preload_cycles;
+    metrics.weight_lines = arch.weight_lines_of_channel(0);
+    metrics.ifmap_access = arch.ifmap_mem.mem.access_counter;
+    metrics.psum_access = arch.psum_mem.mem.access_counter;
+    metrics.weight_access = 0;
+    for (auto &pe : arch.pe_array)
+    {
+        metrics.weight_access += pe.weight_access_counter;
+    }
+    metrics.weight_sam_access = arch.weight_mem.mem.access_counter;
+    metrics.valid = validate_expected_output(expected_ofmap, dram_store(arch, filters, rows, ofmap_w));
+    return metrics;
+}
+
+// Runs simulate_tile in a child process so every run gets a fresh
+// SystemC kernel, the child's own output is dropped. A child that fails,
+// the watchdog included, writes no metrics and exits with EXIT_FAILURE.
+template <typename DataType>
+pid_t fork_tile(int fd_out, int filter_count, int channel_count, const Mapping &mapping, const WeightBufferConfig &weight_config, const WatchdogConfig &watchdog_config, int filters, int c_in, int rows, int ofmap_w)
+{
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        if (!freopen("/dev/null", "w", stdout))
+        {
+            _exit(EXIT_FAILURE);
+        }
+        TileMetrics metrics;
+        try
+        {
+            metrics = simulate_tile<DataType>(filter_count, channel_count, mapping, weight_config, watchdog_config, filters, c_in, rows, ofmap_w);
+        }
+        catch (std::exception &e)
+        {
+            _exit(EXIT_FAILURE);
+        }
+        bool written = write(fd_out, &metrics, sizeof(metrics)) == sizeof(metrics);
+        _exit((written) ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+    return pid;
+}
+
+// Weight preload covers every tile the PE registers hold, timed the way
+// generate_and_load_weight_program times it.
+static long int layer_preload_cycles(const TileMetrics &one_tile, int tile_count, int reg_capacity)
+{
+    if (!one_tile.preload_cycles)
+    {
+        return 0;
+    }
+    return weight_preload_cycles((reg_capacity) ? std::min(reg_capacity, tile_count) : tile_count, one_tile.weight_lines);
+}
+
+// Per tile latency, ifmap, psum, PE weight and weight SAM accesses of a
+// stratum from its shape's one tile run. The one cycle bubble between
+// tiles is left out, it does not grow with the stream.
+static vector<double> tile_costs(const TileMetrics &m, const TileStratum &stratum, int stream_size)
+{
+    double accumulate = (stratum.accumulate) ? (double)stratum.filters * stream_size : 0.0;
+    return {m.cycles - m.fill_cycles - 1, m.ifmap_access, m.psum_access + accumulate, m.weight_access, m.weight_sam_access};
+}
+
+template <typename DataType>
+void sim_extrapolated_and_get_results(const RunOptions &options)
+{
+    auto t1 = high_resolution_clock::now();
+
+    LayerShape layer{options.c_in, options.f_out, options.k, options.ifmap_h - options.k + 1, options.ifmap_w - options.k + 1};
+    auto schedule = options.mapping.tile_schedule(options.mapping.filter_tiles(layer), options.mapping.channel_tiles(layer));
+    auto strata = stratify_tiles(options.mapping, layer);
+
+    // up to three row counts, the last one the full ofmap if it is in reach
+    vector<int> row_points;
+    for (int step = 1; step <= 3 && (row_points.empty() || row_points.back() < layer.ofmap_h); step++)
+    {
+        row_points.push_back(std::min(step * options.extrapolation_rows, layer.ofmap_h));
+    }
+    vector<pair<int, int>> shapes;
+    for (auto &stratum : strata)
+    {
+        if (std::find(shapes.begin(), shapes.end(), std::make_pair(stratum.filters, stratum.columns)) == shapes.end())
+        {
+            shapes.push_back({stratum.filters, stratum.columns});
+        }
+    }
+    auto shape_of = [&](const TileStratum &stratum) {
+        return std::find(shapes.begin(), shapes.end(), std::make_pair(stratum.filters, stratum.columns)) - shapes.begin();
+    };
+
+    // one run per shape and row count
+    struct TileRun
+    {
+        int filters, c_in, rows;
+    };
+    vector<TileRun> runs;
+    for (auto &shape : shapes)
+    {
+        for (int rows : row_points)
+        {
+            runs.push_back({shape.first, shape.second, rows});
+        }
+    }
+
+    vector<pid_t> children;
+    vector<int> pipes;
+    for (auto &run : runs)
+    {
+        int fds[2];
+        if (pipe(fds) != 0)
+        {
+            throw std::runtime_error("could not open a pipe to a tile simulation");
+        }
+        cout.flush();
+        children.push_back(fork_tile<DataType>(fds[1], options.filter_count, options.channel_count, options.mapping, options.weight_config, options.watchdog_config, run.filters, run.c_in, run.rows, layer.ofmap_w));
+        close(fds[1]);
+        pipes.push_back(fds[0]);
+    }
+    vector<TileMetrics> run_metrics(runs.size());
+    bool valid = true;
+    for (unsigned int idx = 0; idx < runs.size(); idx++)
+    {
+        int status = 0;
+        bool received = read(pipes[idx], &run_metrics[idx], sizeof(TileMetrics)) == sizeof(TileMetrics);
+        close(pipes[idx]);
+        waitpid(children[idx], &status, 0);
+        if (!received || !WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS)
+        {
+            throw std::runtime_error("tile simulation " + std::to_string(runs[idx].filters) + "x" + std::to_string(runs[idx].c_in) + " over " + std::to_string(runs[idx].rows) + " rows failed");
+        }
+        valid &= run_metrics[idx].valid;
+    }
+    auto metrics_of = [&](const TileStratum &stratum, int point) -> const TileMetrics & {
+        return run_metrics[shape_of(stratum) * row_points.size() + point];
+    };
+
+    // latency, ifmap, psum, PE weight and weight SAM accesses of the layer
+    const vector<string> labels = {"Latency in cycles", "Ifmap Access", "Psum Access", "Weight Access", "Weight SAM Access"};
+    const TileMetrics &first = run_metrics[0];
+    int reg_capacity = options.weight_config.reg_capacity;
+    vector<double> total(labels.size(), 0.0), error(labels.size(), 0.0);
+    total[0] = first.fill_cycles - first.preload_cycles + layer_preload_cycles(first, schedule.size(), reg_capacity);
+    for (auto &stratum : strata)
+    {
+        vector<vector<double>> costs(labels.size());
+        for (unsigned int point = 0; point < row_points.size(); point++)
+        {
+            auto cost = tile_costs(metrics_of(stratum, point), stratum, row_points[point] * layer.ofmap_w);
+            for (unsigned int metric = 0; metric < labels.size(); metric++)
+            {
+                costs[metric].push_back(cost[metric]);
+            }
+        }
+        for (unsigned int metric = 0; metric < labels.size(); metric++)
+        {
+            auto cost = extrapolate_rows(row_points, costs[metric], layer.ofmap_h);
+            double bubble = (metric == 0) ? 1.0 : 0.0;
+            total[metric] += stratum.tiles.size() * (cost.estimate + bubble);
+            error[metric] += stratum.tiles.size() * cost.error;
+        }
+    }
+
+    auto t2 = high_resolution_clock::now();
+    auto sim_time = duration_cast<milliseconds>(t2 - t1);
+
+    if (!valid)
+    {
+        cout << "FAIL" << endl;
+        return;
+    }
+    cout << "PASS" << endl;
+    cout << std::left << std::setw(20) << "Extrapolated" << shapes.size() << " shapes for " << schedule.size() << " tiles in " << strata.size() << " strata, at";
+    for (int rows : row_points)
+    {
+        cout << " " << rows;
+    }
+    cout << " of " << layer.ofmap_h << " rows" << endl;
+    for (unsigned int metric = 0; metric < labels.size(); metric++)
+    {
+        cout << std::left << std::setw(20) << labels[metric] << std::fixed << std::setprecision(0) << total[metric] << " [" << total[metric] - error[metric] << ", " << total[metric] + error[metric] << "]" << endl;
+    }
+    cout.unsetf(std::ios::fixed);
+    ArrayShape array{options.filter_count, options.channel_count, options.c_in * options.ifmap_h * options.ifmap_w, options.f_out * layer.ofmap_size()};
+    cout << std::left << std::setw(20) << "Analytic Latency" << estimate_mapping_cost(options.mapping, layer, array).cycles << endl;
+    cout << std::left << std::setw(20) << "Simulated in " << sim_time.count() << "ms\n";
+}
+
+template void sim_extrapolated_and_get_results<sc_int<32>>(const RunOptions &options);
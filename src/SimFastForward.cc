@@ -0,0 +1,176 @@
+#include "SimFastForward.hh"
+#include "Arch.hh"
+#include "ReferenceModel.hh"
+#include "SteadyState.hh"
+#include <chrono>
+#include <iomanip>
+#include <xtensor/xview.hpp>
+
+using std::chrono::duration_cast;
+using std::chrono::high_resolution_clock;
+using std::chrono::milliseconds;
+
+static int greatest_common_divisor(int a, int b)
+{
+    while (b)
+    {
+        int rest = a % b;
+        a = b;
+        b = rest;
+    }
+    return a;
+}
+
+template <typename DataType>
+void sim_fast_forward_and_get_results(const RunOptions &options)
+{
+    auto t1 = high_resolution_clock::now();
+
+    const int steady_tiles = 3;
+    LayerShape layer{options.c_in, options.f_out, options.k, options.ifmap_h - options.k + 1, options.ifmap_w - options.k + 1};
+    int ofmap_h = layer.ofmap_h;
+    int ofmap_w = layer.ofmap_w;
+    int stream_size = layer.ofmap_size();
+    int v_count = options.mapping.filter_tiles(layer);
+    int h_count = options.mapping.channel_tiles(layer);
+    int edge_filters = options.f_out % options.mapping.filter_tile;
+    int reduced_f_out = steady_tiles * options.mapping.filter_tile + edge_filters;
+    long int skipped_periods = v_count - options.mapping.filter_tiles({options.c_in, reduced_f_out, options.k, ofmap_h, ofmap_w});
+    if (options.mapping.loop_order != LoopOrder::FILTER_TILES_OUTER || skipped_periods <= 0)
+    {
+        throw std::invalid_argument("fast-forward skips filter tiles, it needs filters_outer and more than " + std::to_string(steady_tiles) + " full filter tiles");
+    }
+
+    int ifmap_mem_size = options.c_in * options.ifmap_h * options.ifmap_w;
+    int psum_mem_size = reduced_f_out * stream_size;
+    sc_trace_file *tf = sc_create_vcd_trace_file("FastForward");
+    tf->set_time_unit(100, SC_PS);
+    GlobalControlChannel control("global_control_channel", sc_time(1, SC_NS), tf);
+    ArrayShape array{options.filter_count, options.channel_count, ifmap_mem_size, psum_mem_size};
+    int weight_mem_size = padded_weight_size(options.mapping, options.mapping.filter_rows(array), options.mapping.channel_cols(array), reduced_f_out, options.c_in, options.k);
+    Arch<DataType> arch("arch", control, options.mapping.filter_rows(array), options.mapping.channel_cols(array), psum_mem_size, ifmap_mem_size, weight_mem_size, tf, options.weight_config);
+    arch.mapping = options.mapping;
+
+    unsigned long int start_cycle_time = sc_time_stamp().value();
+    control.set_reset(true);
+    sc_start(10, SC_NS);
+    control.set_reset(false);
+    sc_start(1, SC_NS);
+
+    xt::xarray<int> weights;
+    WeightTiles tiles;
+    auto ifmap = dram_load(arch, options.c_in, options.ifmap_h, options.ifmap_w);
+    set_channel_modes(arch);
+    std::tie(weights, tiles) = generate_and_load_weights(arch, reduced_f_out, options.c_in, options.k);
+    generate_and_load_pe_program(arch, tiles, options.ifmap_h, options.ifmap_w);
+    generate_and_load_ifmap_in_program(arch, tiles, options.ifmap_h, options.ifmap_w);
+    generate_and_load_psum_program(arch, tiles, ofmap_h, ofmap_w);
+    auto expected_reduced = generate_expected_output(ifmap, weights);
+    generate_and_load_post_processors(arch, tiles, generate_biases(expected_reduced), ofmap_h, ofmap_w, PostProcessConfig());
+
+    // every ifmap and psum program has to repeat within a filter tile's worth of tiles
+    int period_tiles = 1;
+    for (auto *generators : {&arch.ifmap_mem.generators, &arch.psum_mem.generators})
+    {
+        for (auto &gen : *generators)
+        {
+            auto period = detect_descriptor_period(gen.descriptors);
+            if (period.repeats > 1)
+            {
+                period_tiles = period_tiles / greatest_common_divisor(period_tiles, period.length) * period.length;
+            }
+        }
+    }
+    if (h_count % period_tiles != 0)
+    {
+        throw std::runtime_error("programs repeat every " + std::to_string(period_tiles) + " tiles, not per filter tile of " + std::to_string(h_count));
+    }
+
+    // ifmap, psum and PE weight accesses and the time. Weight SAM reads are
+    // left out, the first tiles' weights are preloaded so they only repeat
+    // per filter tile once the registers are refilled.
+    auto snapshot = [&]() {
+        long int weight_access = 0;
+        for (auto &pe : arch.pe_array)
+        {
+            weight_access += pe.weight_access_counter;
+        }
+        return vector<long int>{arch.ifmap_mem.mem.access_counter, arch.psum_mem.mem.access_counter, weight_access, (long int)sc_time_stamp().value()};
+    };
+    long int weight_sam_loaded = arch.weight_mem.mem.access_counter;
+    arm_watchdog(arch, options.watchdog_config, estimate_mapping_cost(options.mapping, {options.c_in, reduced_f_out, options.k, ofmap_h, ofmap_w}, array).cycles + arch.weight_preload_cycles);
+
+    control.set_program(true);
+    sc_start(1, SC_NS);
+    control.set_enable(true);
+    control.set_program(false);
+
+    // filter tile v starts when the first psum write generator, which has a
+    // descriptor per tile after its fill delay, enters descriptor 1 + v * h_count
+    auto &tile_clock = arch.psum_mem.generators.at(0);
+    PeriodDetector detector;
+    for (int tile = 0; tile < steady_tiles && !arch.suspended && !arch.hung; tile++)
+    {
+        while (tile_clock.execute_index.read() < (unsigned int)(1 + tile * h_count) && !arch.suspended && !arch.hung)
+        {
+            sc_start(1, SC_NS);
+        }
+        detector.record(snapshot());
+    }
+    if (!arch.suspended && !arch.hung)
+    {
+        sc_start();
+    }
+    if (watchdog_stopped(arch))
+    {
+        return;
+    }
+    auto finished = snapshot();
+    long int weight_sam_reads = arch.weight_mem.mem.access_counter - weight_sam_loaded;
+
+    auto res = dram_store(arch, reduced_f_out, ofmap_h, ofmap_w);
+    bool valid = validate_expected_output(expected_reduced, res);
+    if (!valid || (int)detector.snapshots.size() != steady_tiles || !detector.steady())
+    {
+        cout << ((valid) ? "no steady state within " + std::to_string(steady_tiles) + " filter tiles" : "cut down layer mismatches the golden model") << endl;
+        cout << "FAIL" << endl;
+        return;
+    }
+
+    // preload covers every tile the registers hold, the full layer has more of them
+    int reduced_tiles = options.mapping.filter_tiles({options.c_in, reduced_f_out, options.k, ofmap_h, ofmap_w}) * h_count;
+    int full_tiles = v_count * h_count;
+    int reg_capacity = options.weight_config.reg_capacity;
+    long int extra_preload = 0;
+    if (arch.weight_preload_cycles)
+    {
+        int max_lines = arch.weight_lines_of_channel(0);
+        extra_preload = ((reg_capacity) ? std::min(reg_capacity, full_tiles) - std::min(reg_capacity, reduced_tiles) : full_tiles - reduced_tiles) * max_lines;
+    }
+    auto run = detector.skip(finished, skipped_periods);
+    long int period_cycles = detector.period_delta()[3] / sc_time(1, SC_NS).value();
+    unsigned long int full_time = run[3] - start_cycle_time + extra_preload * sc_time(1, SC_NS).value();
+    // every tile's weights are read from the weight SAM once, preloaded or refilled
+    long int full_weight_sam_reads = weight_sam_reads / reduced_tiles * full_tiles;
+
+    // the full layer's weight image, its ofmap is only counted
+    xt::xarray<int> full_weights = generate_weights(options.f_out, options.c_in, options.k);
+    auto packed = pack_weights(full_weights.data(), options.f_out, options.c_in * options.k * options.k, options.mapping, arch.filter_count, arch.channel_count, options.weight_config.delivery, arch.weight_channel_count);
+    long int ofmap_words = (long int)options.f_out * stream_size;
+
+    auto t2 = high_resolution_clock::now();
+    auto sim_time = duration_cast<milliseconds>(t2 - t1);
+
+    cout << "PASS" << endl;
+    cout << std::left << std::setw(20) << "Fast Forward" << v_count - skipped_periods << " of " << v_count << " filter tiles simulated, " << skipped_periods << " periods of " << period_cycles << " cycles skipped" << endl;
+    cout << std::left << std::setw(20) << "DRAM Access" << (long int)ifmap.size() + (long int)packed.words * packed.lanes + ofmap_words << endl;
+    cout << std::left << std::setw(20) << "Weight Access" << run[2] << endl;
+    cout << std::left << std::setw(20) << "Psum Access" << run[1] + ofmap_words << endl;
+    cout << std::left << std::setw(20) << "Ifmap Access" << run[0] << endl;
+    cout << std::left << std::setw(20) << "Weight SAM Access" << packed.words + full_weight_sam_reads << endl;
+    cout << std::left << std::setw(20) << "Ofmap Words" << ofmap_words << endl;
+    cout << std::left << std::setw(20) << "Latency in cycles" << full_time << endl;
+    cout << std::left << std::setw(20) << "Simulated in " << sim_time.count() << "ms\n";
+}
+
+template void sim_fast_forward_and_get_results<sc_int<32>>(const RunOptions &options);
@@ -0,0 +1,245 @@
+#include "SimFused.hh"
+#include "Arch.hh"
+#include "ReferenceModel.hh"
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <xtensor/xview.hpp>
+
+using std::chrono::duration_cast;
+using std::chrono::high_resolution_clock;
+using std::chrono::milliseconds;
+
+// Returns false when the watchdog stopped the layer, every layer gets its
+// own budget.
+template <typename DataType>
+bool run_fused_layer(Arch<DataType> &arch, GlobalControlChannel &control, int c_in, int f_out, int k, int ifmap_h, int ifmap_w, xt::xarray<int> biases, const PostProcessConfig &post_process_config, const WatchdogConfig &watchdog_config, GlobalBuffer *global_buffer)
+{
+    int ofmap_h = ifmap_h - k + 1;
+    int ofmap_w = ifmap_w - k + 1;
+    xt::xarray<int> weights;
+    WeightTiles tiles;
+
+    // weights of the previous layer must not leak into this one
+    for (auto &pe : arch.pe_array)
+    {
+        pe.reset();
+        pe.current_weight = 0;
+    }
+
+    set_channel_modes(arch);
+    std::tie(weights, tiles) = generate_and_load_weights(arch, f_out, c_in, k);
+    generate_and_load_pe_program(arch, tiles, ifmap_h, ifmap_w);
+    generate_and_load_ifmap_in_program(arch, tiles, ifmap_h, ifmap_w);
+    generate_and_load_psum_program(arch, tiles, ofmap_h, ofmap_w);
+    generate_and_load_post_processors(arch, tiles, biases, ofmap_h, ofmap_w, post_process_config);
+    if (global_buffer)
+    {
+        partition_global_buffer(arch, *global_buffer, c_in * ifmap_h * ifmap_w, f_out * ofmap_h * ofmap_w, arch.weight_image.data.size());
+    }
+    ArrayShape array{arch.filter_count, arch.channel_count, 0, 0};
+    arm_watchdog(arch, watchdog_config, estimate_mapping_cost(Mapping::full_array(array), {c_in, f_out, k, ofmap_h, ofmap_w}, array).cycles);
+
+    control.set_program(true);
+    sc_start(1, SC_NS);
+    control.set_enable(true);
+    control.set_program(false);
+    sc_start();
+    control.set_enable(false);
+    return !arch.hung;
+}
+
+int schedule_fused_strip_rows(const vector<int> &layer_channels, int ifmap_h, int ifmap_w, const PostProcessConfig &config, int ifmap_mem_size, int psum_mem_size, const GlobalBuffer *global_buffer, const vector<int> &layer_weight_words, const vector<int> &layer_region_channels)
+{
+    bool pooled = config.pool != PoolMode::NONE;
+    int alignment = (pooled) ? (1 << (layer_channels.size() - 1)) : 1;
+
+    auto strip_fits = [&](int rows) {
+        int h = rows;
+        int w = ifmap_w;
+        for (unsigned int layer = 0; layer + 1 < layer_channels.size(); layer++)
+        {
+            if (h * w < 11)
+            {
+                return false;
+            }
+            if (global_buffer && !global_buffer->fits(layer_channels[layer] * h * w, layer_region_channels[0], layer_channels[layer + 1] * h * w, layer_region_channels[1], layer_weight_words[layer], layer_region_channels[2]))
+            {
+                return false;
+            }
+            if (!global_buffer && (layer_channels[layer] * h * w > ifmap_mem_size || layer_channels[layer + 1] * h * w > psum_mem_size))
+            {
+                return false;
+            }
+            if (pooled)
+            {
+                if (h < 2 || w < 2)
+                {
+                    return false;
+                }
+                h /= 2;
+                w /= 2;
+            }
+        }
+        return true;
+    };
+
+    for (int rows = ifmap_h; rows > 0; rows--)
+    {
+        if (rows != ifmap_h && rows % alignment != 0)
+        {
+            continue;
+        }
+        int remainder = ifmap_h % rows;
+        if (strip_fits(rows) && (remainder == 0 || strip_fits(remainder)))
+        {
+            return rows;
+        }
+    }
+    return 0;
+}
+
+template <typename DataType>
+void sim_fused_and_get_results(const RunOptions &options)
+{
+    auto t1 = high_resolution_clock::now();
+    bool pooled = options.post_process_config.pool != PoolMode::NONE;
+
+    xt::print_options::set_threshold(10000);
+    xt::print_options::set_line_width(100);
+
+    // golden model runs the whole chain layer by layer, which also fixes the
+    // per layer biases and the DRAM traffic of unfused execution
+    xt::xarray<int> ifmap = xt::arange((int)1, options.c_in * options.ifmap_h * options.ifmap_w + 1);
+    ifmap.reshape({options.c_in, options.ifmap_h, options.ifmap_w});
+    xt::xarray<int> expected_ofmap = ifmap;
+    vector<int> layer_c_in;
+    vector<xt::xarray<int>> layer_biases;
+    long unsigned int unfused_dram_access = 0;
+    long unsigned int layer_weight_words = 0; // one load of every layer's weights
+    int weight_mem_size = 0;
+    int channels = options.c_in;
+    for (auto f_out : options.layer_f_out)
+    {
+        auto weights = generate_weights(f_out, channels, options.k);
+        auto raw_ofmap = generate_expected_output(expected_ofmap, weights);
+        auto biases = generate_biases(raw_ofmap);
+        int padded_filters = ceil((float)f_out / options.filter_count) * options.filter_count;
+        int padded_channels = ceil((float)(channels * options.k * options.k) / options.channel_count) * options.channel_count;
+        unfused_dram_access += expected_ofmap.size() + padded_filters * padded_channels;
+        layer_weight_words += padded_filters * padded_channels;
+        weight_mem_size = std::max(weight_mem_size, padded_filters * padded_channels);
+        expected_ofmap = (options.post_process_config.enabled()) ? generate_expected_post_processed_output(raw_ofmap, biases, options.post_process_config) : raw_ofmap;
+        unfused_dram_access += expected_ofmap.size();
+        layer_c_in.push_back(channels);
+        layer_biases.push_back(biases);
+        channels = f_out;
+    }
+
+    sc_trace_file *tf = sc_create_vcd_trace_file("Arch1x1");
+    tf->set_time_unit(100, SC_PS);
+
+    GlobalControlChannel control("global_control_channel", sc_time(1, SC_NS), tf);
+    Arch<DataType> arch("arch", control, options.filter_count, options.channel_count, options.psum_mem_size, options.ifmap_mem_size, weight_mem_size, tf);
+    arch.pause_on_suspend = true;
+    arch.ifmap_compression = options.compression;
+
+    unsigned long int start_cycle_time = sc_time_stamp().value();
+    control.set_reset(true);
+    sc_start(10, SC_NS);
+    control.set_reset(false);
+    sc_start(1, SC_NS);
+
+    xt::xarray<int> res = xt::zeros<int>(expected_ofmap.shape());
+    vector<GlobalBuffer> layer_buffers; // partition of the tallest strip per layer
+    int strip_count = 0;
+    int out_row = 0;
+    for (int row = 0; row < options.ifmap_h; row += options.strip_rows)
+    {
+        int h = std::min(options.strip_rows, options.ifmap_h - row);
+        int w = options.ifmap_w;
+        dram_load_strip(arch, ifmap, row, h);
+        for (unsigned int layer = 0; layer < options.layer_f_out.size(); layer++)
+        {
+            if (!run_fused_layer(arch, control, layer_c_in[layer], options.layer_f_out[layer], options.k, h, w, layer_biases[layer], options.post_process_config, options.watchdog_config, options.global_buffer.get()))
+            {
+                watchdog_stopped(arch);
+                return;
+            }
+            if (options.global_buffer && strip_count == 0)
+            {
+                layer_buffers.push_back(*options.global_buffer);
+            }
+            int ofmap_h = h - options.k + 1;
+            int ofmap_w = w - options.k + 1;
+            int out_h = (pooled) ? ofmap_h / 2 : ofmap_h;
+            int out_w = (pooled) ? ofmap_w / 2 : ofmap_w;
+            if (layer + 1 < options.layer_f_out.size())
+            {
+                onchip_transfer(arch, options.layer_f_out[layer], out_h, out_w, ofmap_h * ofmap_w);
+            }
+            else
+            {
+                auto strip = dram_store(arch, options.layer_f_out[layer], out_h, out_w, ofmap_h * ofmap_w);
+                xt::view(res, xt::all(), xt::range(out_row, out_row + out_h), xt::all()) = strip;
+                out_row += out_h;
+            }
+            h = out_h;
+            w = out_w;
+        }
+        strip_count++;
+    }
+
+    auto valid = validate_expected_output(expected_ofmap, res);
+    unsigned long int end_cycle_time = sc_time_stamp().value();
+
+    auto t2 = high_resolution_clock::now();
+    auto sim_time = duration_cast<milliseconds>(t2 - t1);
+
+    if (valid)
+    {
+        cout << "PASS" << endl;
+        int weight_access = 0;
+        for (auto &pe : arch.pe_array)
+        {
+            weight_access += pe.weight_access_counter;
+        }
+        // The weight SAM holds one layer, so every strip refetches the weights
+        // of every layer. Unfused execution loads each layer's weights once,
+        // the refetches are reported apart: Activation Saved is what
+        // keeping the intermediate ofmaps on chip saves, DRAM Saved nets the
+        // weight reloads against it and goes negative once they outweigh it.
+        long int weight_reloads = (long int)arch.weight_dram_access_counter - (long int)layer_weight_words;
+        long int activation_access = (long int)arch.dram_access_counter - (long int)arch.weight_dram_access_counter;
+        long int activation_saved = (long int)(unfused_dram_access - layer_weight_words) - activation_access;
+        cout << std::left << std::setw(20) << "DRAM Access" << arch.dram_access_counter << endl;
+        cout << std::left << std::setw(20) << "Weight DRAM Access" << arch.weight_dram_access_counter << endl;
+        cout << std::left << std::setw(20) << "Weight Reloads" << weight_reloads << endl;
+        cout << std::left << std::setw(20) << "Unfused DRAM Access" << unfused_dram_access << endl;
+        cout << std::left << std::setw(20) << "Activation Saved" << activation_saved << endl;
+        cout << std::left << std::setw(20) << "DRAM Saved" << activation_saved - weight_reloads << endl;
+        cout << std::left << std::setw(20) << "Onchip Transfer" << arch.onchip_transfer_counter << endl;
+        cout << std::left << std::setw(20) << "Strip Rows" << options.strip_rows << endl;
+        cout << std::left << std::setw(20) << "Strip Count" << strip_count << endl;
+        for (unsigned int layer = 0; layer < layer_buffers.size(); layer++)
+        {
+            print_global_buffer("Layer " + std::to_string(layer) + " Buffer", layer_buffers[layer]);
+        }
+        cout << std::left << std::setw(20) << "Weight Access" << weight_access << endl;
+        cout << std::left << std::setw(20) << "Psum Access" << arch.psum_mem.mem.access_counter << endl;
+        cout << std::left << std::setw(20) << "Ifmap Access" << arch.ifmap_mem.mem.access_counter << endl;
+        if (options.compression != CompressionFormat::NONE)
+        {
+            print_compression(arch);
+        }
+        cout << std::left << std::setw(20) << "Latency in cycles" << end_cycle_time - start_cycle_time << endl;
+        cout << std::left << std::setw(20) << "Simulated in " << sim_time.count() << "ms\n";
+        exit(EXIT_SUCCESS); // avoids expensive de-alloc
+    }
+    else
+    {
+        cout << "FAIL" << endl;
+    }
+}
+
+template void sim_fused_and_get_results<sc_int<32>>(const RunOptions &options);
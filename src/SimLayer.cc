@@ -0,0 +1,298 @@
+#include "SimLayer.hh"
+#include "Arch.hh"
+#include "ArchImage.hh"
+#include "ChannelTrace.hh"
+#include "DramArbiter.hh"
+#include "ReferenceModel.hh"
+#include <chrono>
+#include <iomanip>
+#include <stdexcept>
+#include <xtensor/xio.hpp>
+#include <xtensor/xview.hpp>
+#include "iconnect.h"
+
+using std::chrono::duration_cast;
+using std::chrono::high_resolution_clock;
+using std::chrono::milliseconds;
+
+template <typename DataType>
+void sim_and_get_results(const RunOptions &options)
+{
+    auto t1 = high_resolution_clock::now();
+
+    int ofmap_h = (options.ifmap_h - options.k + 1);
+    int ofmap_w = (options.ifmap_w - options.k + 1);
+    int ifmap_ring_length = options.ifmap_line_rows * options.ifmap_w;
+    int ifmap_mem_size = (options.ifmap_line_rows) ? options.channel_count * ifmap_ring_length : options.ifmap_layout.size(options.c_in, options.ifmap_h * options.ifmap_w);
+    int psum_mem_size = options.ofmap_layout.size(options.f_out, ofmap_h * ofmap_w);
+
+    xt::xarray<int> weights;
+    WeightTiles tiles;
+
+    xt::print_options::set_threshold(10000);
+    xt::print_options::set_line_width(100);
+
+    sc_trace_file *tf = sc_create_vcd_trace_file("Arch1x1");
+    tf->set_time_unit(100, SC_PS);
+
+    GlobalControlChannel control("global_control_channel", sc_time(1, SC_NS), tf);
+    ArrayShape array{options.filter_count, options.channel_count, ifmap_mem_size, psum_mem_size};
+    int weight_mem_size = padded_weight_size(options.mapping, options.mapping.filter_rows(array), options.mapping.channel_cols(array), options.f_out, options.c_in, options.k);
+    Arch<DataType> arch("arch", control, options.mapping.filter_rows(array), options.mapping.channel_cols(array), psum_mem_size, ifmap_mem_size, weight_mem_size, tf, options.weight_config);
+    arch.mapping = options.mapping;
+    arch.ifmap_layout = options.ifmap_layout;
+    arch.ofmap_layout = options.ofmap_layout;
+    arch.ifmap_ring_length = ifmap_ring_length;
+    arch.ifmap_compression = options.compression;
+    auto t_elaborated = high_resolution_clock::now();
+
+    // the hierarchy has its own control so transfers can run before the
+    // array is programmed
+    std::unique_ptr<GlobalControlChannel> hierarchy_control;
+    std::unique_ptr<MemoryHierarchy<DataType>> hierarchy;
+    if (!options.memory_levels.empty())
+    {
+        hierarchy_control.reset(new GlobalControlChannel("hierarchy_control", sc_time(1, SC_NS), tf));
+        hierarchy.reset(new MemoryHierarchy<DataType>("memory_hierarchy", *hierarchy_control, options.memory_levels, tf));
+        hierarchy_control->set_reset(true);
+    }
+
+    // the host configures the array through its control registers
+    std::unique_ptr<iconnect<1, 1>> csr_bus;
+    std::unique_ptr<ControlRegisters> csr;
+    std::unique_ptr<DramPort> csr_host;
+    if (options.config_path != ConfigPath::DIRECT)
+    {
+        csr_bus.reset(new iconnect<1, 1>("csr_bus"));
+        csr.reset(new ControlRegisters("control_registers", sc_time(1, SC_NS), CsrTiming()));
+        csr_host.reset(new DramPort("csr_host", 0));
+        csr_bus->memmap(0, CSR_SIZE, ADDRMODE_RELATIVE, -1, csr->socket);
+        csr_host->socket.bind(*csr_bus->t_sk[0]);
+        csr_bus->set_target_offset(0, 0);
+    }
+
+    unsigned long int start_cycle_time = sc_time_stamp().value();
+    control.set_reset(true);
+    sc_start(10, SC_NS);
+    control.set_reset(false);
+    if (hierarchy)
+    {
+        hierarchy_control->set_reset(false);
+    }
+    sc_start(1, SC_NS);
+
+    xt::xarray<int> ifmap;
+    if (hierarchy)
+    {
+        ifmap = stage_ifmap(arch, *hierarchy, options.c_in, options.ifmap_h, options.ifmap_w);
+    }
+    else
+    {
+        ifmap = (options.ifmap_line_rows) ? generate_ifmap(options.c_in, options.ifmap_h, options.ifmap_w) : dram_load(arch, options.c_in, options.ifmap_h, options.ifmap_w);
+    }
+    // cout << ifmap << endl;
+
+    set_channel_modes(arch);
+    LayerShape layer{options.c_in, options.f_out, options.k, ofmap_h, ofmap_w};
+    if (!options.load_program.empty())
+    {
+        // the weights are still generated, the expected output needs them
+        weights = generate_weights(options.f_out, options.c_in, options.k);
+        tiles = weight_tiles(arch, weights);
+        try
+        {
+            MappedProgramImage image(options.load_program);
+            apply_program_image(arch, image.view(), layer);
+        }
+        catch (std::exception &e)
+        {
+            cout << "error: " << e.what() << endl;
+            cout << "FAIL" << endl;
+            return;
+        }
+        cout << "Loaded program image " << options.load_program << endl;
+    }
+    else
+    {
+        std::tie(weights, tiles) = generate_and_load_weights(arch, options.f_out, options.c_in, options.k);
+
+        generate_and_load_pe_program(arch, tiles, options.ifmap_h, options.ifmap_w);
+        generate_and_load_ifmap_in_program(arch, tiles, options.ifmap_h, options.ifmap_w);
+        generate_and_load_psum_program(arch, tiles, ofmap_h, ofmap_w);
+    }
+    if (!options.save_program.empty())
+    {
+        capture_program_image(arch, layer).save(options.save_program);
+        cout << "Saved program image " << options.save_program << endl;
+    }
+    unsigned long int config_cycles = 0;
+    if (csr)
+    {
+        config_cycles = configure_over_bus(arch, *csr, *csr_host, layer, options.config_path);
+    }
+    if (options.ifmap_line_rows)
+    {
+        load_ifmap_rings(arch, ifmap);
+    }
+    if (options.global_buffer)
+    {
+        try
+        {
+            partition_global_buffer(arch, *options.global_buffer, ifmap_mem_size, psum_mem_size, arch.weight_mem.mem.ram.size() * arch.weight_lanes());
+        }
+        catch (std::exception &e)
+        {
+            cout << "error: " << e.what() << endl;
+            cout << "FAIL" << endl;
+            return;
+        }
+    }
+
+    auto expected_ofmap = generate_expected_output(ifmap, weights);
+    auto biases = generate_biases(expected_ofmap);
+    generate_and_load_post_processors(arch, tiles, biases, ofmap_h, ofmap_w, options.post_process_config);
+
+    vector<unsigned int> ifmap_trace, psum_trace, weight_trace;
+    if (options.reuse_hit_rate > 0.0)
+    {
+        arch.ifmap_mem.mem.address_trace = &ifmap_trace;
+        arch.psum_mem.mem.address_trace = &psum_trace;
+        arch.weight_mem.mem.address_trace = &weight_trace;
+    }
+    vector<std::unique_ptr<ChannelTrace>> channel_traces;
+    vector<pair<string, Memory<DataType> *>> traced_mems = {{"ifmap", &arch.ifmap_mem.mem}, {"psum", &arch.psum_mem.mem}, {"weight", &arch.weight_mem.mem}};
+    if (!options.trace_prefix.empty())
+    {
+        for (auto &traced : traced_mems)
+        {
+            channel_traces.emplace_back(new ChannelTrace(traced.second->channel_count, traced.second->length, traced.second->width));
+            traced.second->channel_trace = channel_traces.back().get();
+        }
+    }
+
+    // a run that never suspends is stopped instead of tying up the process
+    arm_watchdog(arch, options.watchdog_config, estimate_mapping_cost(options.mapping, layer, array).cycles + arch.weight_preload_cycles);
+
+    auto t_loaded = high_resolution_clock::now();
+    control.set_program(true);
+    sc_start(1, SC_NS);
+    control.set_enable(true);
+    control.set_program(false);
+    sc_start();
+    auto t_ran = high_resolution_clock::now();
+    if (watchdog_stopped(arch))
+    {
+        return;
+    }
+
+    for (unsigned int idx = 0; idx < channel_traces.size(); idx++)
+    {
+        string path = options.trace_prefix + "_" + traced_mems[idx].first + ".trace";
+        traced_mems[idx].second->channel_trace = nullptr;
+        channel_traces[idx]->save(path);
+        cout << "Recorded " << channel_traces[idx]->accesses.size() << " " << traced_mems[idx].first << " accesses to " << path << endl;
+    }
+
+    xt::xarray<int> res;
+    if (options.post_process_config.pool != PoolMode::NONE)
+    {
+        // pooled outputs are packed at the start of each filter's psum region
+        res = dram_store(arch, options.f_out, ofmap_h / 2, ofmap_w / 2, ofmap_h * ofmap_w);
+    }
+    else
+    {
+        res = dram_store(arch, options.f_out, ofmap_h, ofmap_w);
+    }
+    if (options.post_process_config.enabled())
+    {
+        expected_ofmap = generate_expected_post_processed_output(expected_ofmap, biases, options.post_process_config);
+    }
+    auto valid = validate_expected_output(expected_ofmap, res);
+    unsigned long int end_cycle_time = sc_time_stamp().value();
+
+    auto t2 = high_resolution_clock::now();
+    auto sim_time = duration_cast<milliseconds>(t2 - t1);
+
+    if (valid)
+    {
+        cout << "PASS" << endl;
+        int weight_access = 0;
+        xt::xarray<float> pe_utilization = xt::zeros<float>({1, (int)arch.pe_array.size()});
+        int pe_idx = 0;
+        for (auto &pe : arch.pe_array)
+        {
+            weight_access += pe.weight_access_counter;
+            pe_utilization(0, pe_idx++) = (float)pe.active_counter / (float)(pe.active_counter + pe.inactive_counter);
+        }
+        float avg_util = xt::average(pe_utilization)(0);
+        cout << std::left << std::setw(20) << "DRAM Access" << arch.dram_access_counter << endl;
+        cout << std::left << std::setw(20) << "Weight Access" << weight_access << endl;
+        cout << std::left << std::setw(20) << "Psum Access" << arch.psum_mem.mem.access_counter << endl;
+        cout << std::left << std::setw(20) << "Ifmap Access" << arch.ifmap_mem.mem.access_counter << endl;
+        cout << std::left << std::setw(20) << "Weight SAM Access" << arch.weight_mem.mem.access_counter << endl;
+        cout << std::left << std::setw(20) << "Weight Preload" << arch.weight_preload_cycles << endl;
+        cout << std::left << std::setw(20) << "Layouts" << options.ifmap_layout.to_string() << " -> " << options.ofmap_layout.to_string() << endl;
+        cout << std::left << std::setw(20) << "Ifmap Runs" << count_stream_runs(arch.ifmap_mem.generators) << endl;
+        cout << std::left << std::setw(20) << "Psum Runs" << count_stream_runs(arch.psum_mem.generators) << endl;
+        print_program_optimization(arch);
+        if (csr)
+        {
+            cout << std::left << std::setw(20) << "Config Cycles" << config_cycles << endl;
+            cout << std::left << std::setw(20) << "Config Accesses" << csr->register_accesses + csr->burst_accesses << endl;
+            cout << std::left << std::setw(20) << "Config Bytes" << csr->byte_counter << endl;
+        }
+        if (options.ifmap_line_rows)
+        {
+            cout << std::left << std::setw(20) << "Ifmap Capacity" << ifmap_mem_size << " of " << options.c_in * options.ifmap_h * options.ifmap_w << endl;
+            cout << std::left << std::setw(20) << "Capacity Saved" << options.c_in * options.ifmap_h * options.ifmap_w - ifmap_mem_size << endl;
+        }
+        if (options.global_buffer)
+        {
+            print_global_buffer("Global Buffer", *options.global_buffer);
+        }
+        if (options.compression != CompressionFormat::NONE)
+        {
+            print_compression(arch);
+        }
+        if (hierarchy)
+        {
+            print_memory_hierarchy(*hierarchy);
+        }
+        if (options.reuse_hit_rate > 0.0)
+        {
+            print_reuse("Ifmap", arch.ifmap_mem, ifmap_trace, options.reuse_hit_rate, options.reuse_window);
+            print_reuse("Psum", arch.psum_mem, psum_trace, options.reuse_hit_rate, options.reuse_window);
+            print_reuse("Weight", arch.weight_mem, weight_trace, options.reuse_hit_rate, options.reuse_window);
+        }
+        if (options.post_process_config.enabled())
+        {
+            int postproc_outputs = 0;
+            int writes_saved = 0;
+            for (auto &post_processor : arch.psum_post_processors)
+            {
+                postproc_outputs += post_processor.processed_counter;
+                writes_saved += post_processor.suppressed_write_counter;
+            }
+            // a separate pass would read every final output back and write the processed result
+            int pass_access_saved = postproc_outputs + (postproc_outputs - writes_saved);
+            cout << std::left << std::setw(20) << "Postproc Outputs" << postproc_outputs << endl;
+            cout << std::left << std::setw(20) << "Writes Saved" << writes_saved << endl;
+            cout << std::left << std::setw(20) << "Pass Access Saved" << pass_access_saved << endl;
+            cout << std::left << std::setw(20) << "Ofmap Footprint" << res.size() << endl;
+        }
+        cout << std::left << std::setw(20) << "Avg. Pe Util" << std::setprecision(2) << avg_util << endl;
+        cout << std::left << std::setw(20) << "Latency in cycles" << end_cycle_time - start_cycle_time << endl;
+        cout << std::left << std::setw(20) << "Elaborated in " << duration_cast<milliseconds>(t_elaborated - t1).count() << "ms\n";
+        cout << std::left << std::setw(20) << "Loaded in " << duration_cast<milliseconds>(t_loaded - t_elaborated).count() << "ms\n";
+        cout << std::left << std::setw(20) << "Ran in " << duration_cast<milliseconds>(t_ran - t_loaded).count() << "ms\n";
+        cout << std::left << std::setw(20) << "Checked in " << duration_cast<milliseconds>(t2 - t_ran).count() << "ms\n";
+        cout << std::left << std::setw(20) << "Simulated in " << sim_time.count() << "ms\n";
+        exit(EXIT_SUCCESS); // avoids expensive de-alloc
+    }
+    else
+    {
+        cout << "FAIL" << endl;
+    }
+}
+
+template void sim_and_get_results<sc_int<32>>(const RunOptions &options);
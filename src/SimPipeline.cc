@@ -0,0 +1,387 @@
+#include "SimPipeline.hh"
+#include "Arch.hh"
+#include "ReferenceModel.hh"
+#include "SimClusters.hh"
+#include <chrono>
+#include <iomanip>
+#include <xtensor/xview.hpp>
+
+using std::chrono::duration_cast;
+using std::chrono::high_resolution_clock;
+using std::chrono::milliseconds;
+
+// Double buffered hand-off between two pipeline stages. The consuming stage
+// reads one slot while the producing stage fills the other, lanes is the
+// number of SAM channels the two arrays move data over.
+template <typename DataType>
+struct StageBuffer : public sc_module
+{
+    SAM<DataType> sam;
+    sc_vector<sc_vector<sc_signal<DataType>>> read_data;
+    sc_vector<sc_vector<sc_signal<DataType>>> write_data;
+    const unsigned int lanes;
+    const unsigned int slot_size;
+    vector<unsigned int> slot_words; // valid words held in each slot
+    unsigned int peak_occupancy{0};
+    unsigned long int occupancy_sum{0};
+
+    unsigned int occupancy()
+    {
+        return slot_words[0] + slot_words[1];
+    }
+
+    void sample_occupancy()
+    {
+        peak_occupancy = std::max(peak_occupancy, occupancy());
+        occupancy_sum += occupancy();
+    }
+
+    StageBuffer(sc_module_name name, GlobalControlChannel &_control, unsigned int _lanes, unsigned int _slot_size, sc_trace_file *tf) : sc_module(name),
+                                                                                                                                     sam("sam", _control, _lanes, 2 * _slot_size, 1, tf),
+                                                                                                                                     read_data("read_data", _lanes, SignalVectorCreator<DataType>(1, tf)),
+                                                                                                                                     write_data("write_data", _lanes, SignalVectorCreator<DataType>(1, tf)),
+                                                                                                                                     lanes(_lanes),
+                                                                                                                                     slot_size(_slot_size),
+                                                                                                                                     slot_words(2, 0)
+    {
+        for (unsigned int i = 0; i < lanes; i++)
+        {
+            sam.read_channel_data[i][0](read_data[i][0]);
+            sam.write_channel_data[i][0](write_data[i][0]);
+        }
+    }
+};
+
+// Drains a stage's output from psum mem into a stage buffer slot, returns
+// the cycles the move takes over the buffer lanes.
+template <typename DataType>
+int stage_buffer_write(Arch<DataType> &arch, StageBuffer<DataType> &buffer, int slot, int channels, int out_h, int out_w, int filter_stride)
+{
+    unsigned int words = channels * out_h * out_w;
+    assert(words <= buffer.slot_size);
+    for (int c = 0; c < channels; c++)
+    {
+        for (int i = 0; i < out_h; i++)
+        {
+            for (int j = 0; j < out_w; j++)
+            {
+                auto &src_ptr = arch.psum_mem.mem.ram.at(c * filter_stride + i * out_w + j).at(0);
+                auto &dst_ptr = buffer.sam.mem.ram.at(slot * buffer.slot_size + c * (out_h * out_w) + i * out_w + j).at(0);
+                dst_ptr.write(src_ptr.read());
+                arch.psum_mem.mem.access_counter++;
+                buffer.sam.mem.access_counter++;
+            }
+        }
+    }
+    buffer.slot_words[slot] = words;
+    return (words + buffer.lanes - 1) / buffer.lanes + 1;
+}
+
+// Fills a stage's ifmap mem from a stage buffer slot and frees the slot,
+// returns the cycles the move takes over the buffer lanes.
+template <typename DataType>
+int stage_buffer_read(Arch<DataType> &arch, StageBuffer<DataType> &buffer, int slot)
+{
+    unsigned int words = buffer.slot_words[slot];
+    assert((int)words <= arch.ifmap_mem_size);
+    for (unsigned int idx = 0; idx < words; idx++)
+    {
+        auto &src_ptr = buffer.sam.mem.ram.at(slot * buffer.slot_size + idx).at(0);
+        auto &dst_ptr = arch.ifmap_mem.mem.ram.at(idx).at(0);
+        dst_ptr.write(src_ptr.read());
+        buffer.sam.mem.access_counter++;
+        arch.ifmap_mem.mem.access_counter++;
+    }
+    buffer.slot_words[slot] = 0;
+    return (words + buffer.lanes - 1) / buffer.lanes + 1;
+}
+
+// Loads suspend only programs so a stage with no image in flight idles
+// through a pipeline step.
+template <typename DataType>
+void park_cluster(Arch<DataType> &arch)
+{
+    vector<Descriptor_2D> program;
+    program.push_back(Descriptor_2D::suspend_inst());
+    for (auto &pe : arch.pe_array)
+    {
+        pe.loadProgram(program);
+    }
+    for (auto &gen : arch.ifmap_mem.generators)
+    {
+        gen.loadProgram(program);
+    }
+    for (auto &gen : arch.psum_mem.generators)
+    {
+        gen.loadProgram(program);
+    }
+    for (auto &gen : arch.weight_mem.generators)
+    {
+        gen.loadProgram(program);
+    }
+    for (auto &post_processor : arch.psum_mem.mem.post_processors)
+    {
+        post_processor = nullptr;
+    }
+}
+
+template <typename DataType>
+void sim_pipeline_and_get_results(const RunOptions &options)
+{
+    auto t1 = high_resolution_clock::now();
+    bool pooled = options.post_process_config.pool != PoolMode::NONE;
+    int stage_count = options.layer_f_out.size();
+
+    xt::print_options::set_threshold(10000);
+    xt::print_options::set_line_width(100);
+
+    // per layer shapes, biases are fixed from the first image
+    vector<int> layer_c_in, layer_h, layer_w;
+    vector<xt::xarray<int>> layer_weights, layer_biases;
+    xt::xarray<int> first_image = xt::arange((int)1, options.c_in * options.ifmap_h * options.ifmap_w + 1);
+    first_image.reshape({options.c_in, options.ifmap_h, options.ifmap_w});
+    xt::xarray<int> activation = first_image;
+    int channels = options.c_in;
+    for (int stage = 0; stage < stage_count; stage++)
+    {
+        layer_c_in.push_back(channels);
+        layer_h.push_back(activation.shape(1));
+        layer_w.push_back(activation.shape(2));
+        layer_weights.push_back(generate_weights(options.layer_f_out[stage], channels, options.k));
+        auto raw_ofmap = generate_expected_output(activation, layer_weights.back());
+        layer_biases.push_back(generate_biases(raw_ofmap));
+        activation = (options.post_process_config.enabled()) ? generate_expected_post_processed_output(raw_ofmap, layer_biases.back(), options.post_process_config) : raw_ofmap;
+        channels = options.layer_f_out[stage];
+    }
+
+    vector<xt::xarray<int>> images, expected_ofmaps;
+    for (int image = 0; image < options.pipeline_images; image++)
+    {
+        images.push_back(first_image + image);
+        activation = images.back();
+        for (int stage = 0; stage < stage_count; stage++)
+        {
+            auto raw_ofmap = generate_expected_output(activation, layer_weights[stage]);
+            activation = (options.post_process_config.enabled()) ? generate_expected_post_processed_output(raw_ofmap, layer_biases[stage], options.post_process_config) : raw_ofmap;
+        }
+        expected_ofmaps.push_back(activation);
+    }
+
+    sc_trace_file *tf = sc_create_vcd_trace_file("Arch1x1");
+    tf->set_time_unit(100, SC_PS);
+
+    sc_time cycle(1, SC_NS);
+    GlobalControlChannel control("global_control_channel", cycle, tf);
+    vector<std::unique_ptr<Arch<DataType>>> clusters;
+    vector<Arch<DataType> *> cluster_ptrs;
+    vector<std::unique_ptr<StageBuffer<DataType>>> buffers;
+    Mapping full_array = Mapping::full_array(ArrayShape{options.filter_count, options.channel_count, 0, 0});
+    int lanes = std::min(options.filter_count, options.channel_count);
+    for (int stage = 0; stage < stage_count; stage++)
+    {
+        int stream_size = layer_h[stage] * layer_w[stage];
+        string name = "stage_" + std::to_string(stage);
+        int weight_mem_size = padded_weight_size(full_array, options.filter_count, options.channel_count, options.layer_f_out[stage], layer_c_in[stage], options.k);
+        clusters.emplace_back(new Arch<DataType>(name.c_str(), control, options.filter_count, options.channel_count, options.layer_f_out[stage] * stream_size, layer_c_in[stage] * stream_size, weight_mem_size, tf));
+        cluster_ptrs.push_back(clusters.back().get());
+        if (stage + 1 < stage_count)
+        {
+            name = "stage_buffer_" + std::to_string(stage);
+            buffers.emplace_back(new StageBuffer<DataType>(name.c_str(), control, lanes, layer_c_in[stage + 1] * layer_h[stage + 1] * layer_w[stage + 1], tf));
+        }
+    }
+    ClusterMonitor<DataType> monitor("cluster_monitor", control, cluster_ptrs);
+
+    unsigned long int start_cycle_time = sc_time_stamp().value();
+    control.set_reset(true);
+    sc_start(10, SC_NS);
+    control.set_reset(false);
+    sc_start(1, SC_NS);
+
+    // weights are fetched once and stay resident for every image
+    vector<WeightTiles> stage_tiles;
+    for (int stage = 0; stage < stage_count; stage++)
+    {
+        stage_tiles.push_back(load_weights(*clusters[stage], layer_weights[stage]));
+    }
+
+    vector<xt::xarray<int>> results(options.pipeline_images);
+    vector<sc_time> step_time;
+    vector<sc_time> stage_compute_time(stage_count, SC_ZERO_TIME);
+    sc_time run_start = sc_time_stamp();
+    for (int step = 0; step < options.pipeline_images + stage_count - 1; step++)
+    {
+        sc_time step_start = sc_time_stamp();
+
+        // stage inputs, the first stage reads DRAM, the rest their upstream buffer
+        int transfer_cycles = 1;
+        vector<Arch<DataType> *> active;
+        vector<int> active_stages;
+        for (int stage = 0; stage < stage_count; stage++)
+        {
+            auto &arch = *clusters[stage];
+            int image = step - stage;
+            if (image < 0 || image >= options.pipeline_images)
+            {
+                park_cluster(arch);
+                continue;
+            }
+            active.push_back(&arch);
+            active_stages.push_back(stage);
+            if (stage == 0)
+            {
+                dram_load_strip(arch, images[image], 0, options.ifmap_h);
+            }
+            else
+            {
+                transfer_cycles = std::max(transfer_cycles, stage_buffer_read(arch, *buffers[stage - 1], image % 2));
+            }
+        }
+        sc_start(transfer_cycles, SC_NS);
+
+        for (auto stage : active_stages)
+        {
+            auto &arch = *clusters[stage];
+            for (auto &pe : arch.pe_array)
+            {
+                pe.resetWeightIdx();
+                pe.current_weight = 0;
+            }
+            set_channel_modes(arch);
+            generate_and_load_pe_program(arch, stage_tiles[stage], layer_h[stage], layer_w[stage]);
+            generate_and_load_ifmap_in_program(arch, stage_tiles[stage], layer_h[stage], layer_w[stage]);
+            generate_and_load_psum_program(arch, stage_tiles[stage], layer_h[stage], layer_w[stage]);
+            generate_and_load_post_processors(arch, stage_tiles[stage], layer_biases[stage], layer_h[stage], layer_w[stage], options.post_process_config);
+            arch.suspended = false;
+            ArrayShape array{options.filter_count, options.channel_count, 0, 0};
+            arm_watchdog(arch, options.watchdog_config, estimate_mapping_cost(full_array, {layer_c_in[stage], options.layer_f_out[stage], options.k, layer_h[stage], layer_w[stage]}, array).cycles);
+        }
+        monitor.clusters = active;
+
+        control.set_program(true);
+        sc_start(1, SC_NS);
+        sc_time compute_start = sc_time_stamp();
+        control.set_enable(true);
+        control.set_program(false);
+        sc_start();
+        control.set_enable(false);
+        for (auto arch : active)
+        {
+            if (watchdog_stopped(*arch))
+            {
+                return;
+            }
+        }
+
+        // stage outputs, the last stage writes DRAM, the rest their downstream buffer
+        transfer_cycles = 1;
+        for (int stage = 0; stage < stage_count; stage++)
+        {
+            auto &arch = *clusters[stage];
+            int image = step - stage;
+            if (image < 0 || image >= options.pipeline_images)
+            {
+                continue;
+            }
+            stage_compute_time[stage] = arch.suspend_time - compute_start;
+            int ofmap_h = layer_h[stage];
+            int ofmap_w = layer_w[stage];
+            int out_h = (pooled) ? ofmap_h / 2 : ofmap_h;
+            int out_w = (pooled) ? ofmap_w / 2 : ofmap_w;
+            if (stage + 1 < stage_count)
+            {
+                transfer_cycles = std::max(transfer_cycles, stage_buffer_write(arch, *buffers[stage], image % 2, options.layer_f_out[stage], out_h, out_w, ofmap_h * ofmap_w));
+            }
+            else
+            {
+                results[image] = dram_store(arch, options.layer_f_out[stage], out_h, out_w, ofmap_h * ofmap_w);
+            }
+        }
+        sc_start(transfer_cycles, SC_NS);
+        for (auto &buffer : buffers)
+        {
+            buffer->sample_occupancy();
+        }
+        step_time.push_back(sc_time_stamp() - step_start);
+    }
+
+    bool valid = true;
+    for (int image = 0; image < options.pipeline_images; image++)
+    {
+        valid &= validate_expected_output(expected_ofmaps[image], results[image]);
+    }
+    unsigned long int end_cycle_time = sc_time_stamp().value();
+
+    auto t2 = high_resolution_clock::now();
+    auto sim_time = duration_cast<milliseconds>(t2 - t1);
+
+    if (valid)
+    {
+        cout << "PASS" << endl;
+        // fill ends with the first image leaving the last stage, drain starts
+        // once the last image has entered the first stage
+        sc_time fill = SC_ZERO_TIME;
+        sc_time drain = SC_ZERO_TIME;
+        sc_time steady = SC_ZERO_TIME;
+        int steady_steps = 0;
+        for (int step = 0; step < (int)step_time.size(); step++)
+        {
+            if (step < stage_count - 1)
+            {
+                fill += step_time[step];
+            }
+            else if (step >= options.pipeline_images)
+            {
+                drain += step_time[step];
+            }
+            else
+            {
+                steady += step_time[step];
+                steady_steps++;
+            }
+        }
+        sc_time serial = SC_ZERO_TIME;
+        unsigned int dram_access = 0;
+        int psum_access = 0;
+        int ifmap_access = 0;
+        for (int stage = 0; stage < stage_count; stage++)
+        {
+            auto &arch = *clusters[stage];
+            string label = "Stage " + std::to_string(stage) + " ";
+            cout << std::left << std::setw(20) << label + "Cycles" << stage_compute_time[stage] / cycle << endl;
+            if (stage + 1 < stage_count)
+            {
+                auto &buffer = *buffers[stage];
+                cout << std::left << std::setw(20) << label + "Buf Peak" << buffer.peak_occupancy << endl;
+                cout << std::left << std::setw(20) << label + "Buf Avg" << std::setprecision(4) << (double)buffer.occupancy_sum / step_time.size() << endl;
+                cout << std::left << std::setw(20) << label + "Buf Capacity" << 2 * buffer.slot_size << endl;
+            }
+            serial += stage_compute_time[stage];
+            dram_access += arch.dram_access_counter;
+            psum_access += arch.psum_mem.mem.access_counter;
+            ifmap_access += arch.ifmap_mem.mem.access_counter;
+        }
+        cout << std::left << std::setw(20) << "DRAM Access" << dram_access << endl;
+        cout << std::left << std::setw(20) << "Psum Access" << psum_access << endl;
+        cout << std::left << std::setw(20) << "Ifmap Access" << ifmap_access << endl;
+        cout << std::left << std::setw(20) << "Fill Cycles" << fill / cycle << endl;
+        cout << std::left << std::setw(20) << "Drain Cycles" << drain / cycle << endl;
+        if (steady_steps)
+        {
+            cout << std::left << std::setw(20) << "Steady Cycles/Img" << std::setprecision(6) << steady / cycle / steady_steps << endl;
+        }
+        // a single array running the layers back to back pays every stage per image
+        cout << std::left << std::setw(20) << "Serial Cycles/Img" << serial / cycle << endl;
+        cout << std::left << std::setw(20) << "Images" << options.pipeline_images << endl;
+        cout << std::left << std::setw(20) << "Pipeline Cycles" << (sc_time_stamp() - run_start) / cycle << endl;
+        cout << std::left << std::setw(20) << "Latency in cycles" << end_cycle_time - start_cycle_time << endl;
+        cout << std::left << std::setw(20) << "Simulated in " << sim_time.count() << "ms\n";
+        exit(EXIT_SUCCESS); // avoids expensive de-alloc
+    }
+    else
+    {
+        cout << "FAIL" << endl;
+    }
+}
+
+template void sim_pipeline_and_get_results<sc_int<32>>(const RunOptions &options);
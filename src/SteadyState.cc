@@ -0,0 +1,82 @@
+#include "SteadyState.hh"
+
+bool same_control_state(const Descriptor_2D& a, const Descriptor_2D& b)
+{
+    return a.state == b.state && a.x_count == b.x_count && a.y_count == b.y_count && a.repeat == b.repeat &&
+           a.x_modify == b.x_modify && a.y_modify == b.y_modify && a.modulo_length == b.modulo_length;
+}
+
+DescriptorPeriod detect_descriptor_period(const vector<Descriptor_2D>& program, int max_prefix)
+{
+    int size = program.size();
+    DescriptorPeriod best{0, size, 1};
+    int best_covered = 0;
+    for (int length = 1; length <= size / 2; length++)
+    {
+        for (int prefix = 0; prefix <= max_prefix && prefix + 2 * length <= size; prefix++)
+        {
+            int matched = length;
+            while (prefix + matched < size && same_control_state(program[prefix + matched], program[prefix + matched % length]))
+            {
+                matched++;
+            }
+            int repeats = matched / length;
+            if (repeats >= 2 && repeats * length > best_covered)
+            {
+                best = {prefix, length, repeats};
+                best_covered = repeats * length;
+            }
+        }
+    }
+    return best;
+}
+
+void PeriodDetector::record(const vector<long int>& counters)
+{
+    assert(snapshots.empty() || snapshots.back().size() == counters.size());
+    snapshots.push_back(counters);
+}
+
+bool PeriodDetector::steady() const
+{
+    if (snapshots.size() < 3)
+    {
+        return false;
+    }
+    auto& a = snapshots[snapshots.size() - 3];
+    auto& b = snapshots[snapshots.size() - 2];
+    auto& c = snapshots[snapshots.size() - 1];
+    for (unsigned int idx = 0; idx < c.size(); idx++)
+    {
+        if (b[idx] - a[idx] != c[idx] - b[idx])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+vector<long int> PeriodDetector::period_delta() const
+{
+    assert(snapshots.size() >= 2);
+    auto& b = snapshots[snapshots.size() - 2];
+    auto& c = snapshots[snapshots.size() - 1];
+    vector<long int> delta(c.size());
+    for (unsigned int idx = 0; idx < c.size(); idx++)
+    {
+        delta[idx] = c[idx] - b[idx];
+    }
+    return delta;
+}
+
+vector<long int> PeriodDetector::skip(const vector<long int>& counters, long int periods) const
+{
+    auto delta = period_delta();
+    assert(delta.size() == counters.size());
+    vector<long int> skipped(counters);
+    for (unsigned int idx = 0; idx < skipped.size(); idx++)
+    {
+        skipped[idx] += periods * delta[idx];
+    }
+    return skipped;
+}
@@ -0,0 +1,79 @@
+#include "TensorLayout.hh"
+#include <stdexcept>
+
+TensorLayout::TensorLayout(LayoutKind _kind, int _block)
+{
+    assert(_block > 0);
+    this->kind = _kind;
+    this->block = (_kind == LayoutKind::NCHWc) ? _block : 1;
+}
+
+int TensorLayout::base(int c, int plane) const
+{
+    switch (kind)
+    {
+    case LayoutKind::NHWC:
+        return c;
+    case LayoutKind::NCHWc:
+        return (c / block) * plane * block + c % block;
+    default:
+        return c * plane;
+    }
+}
+
+int TensorLayout::stride(int channels) const
+{
+    switch (kind)
+    {
+    case LayoutKind::NHWC:
+        return channels;
+    case LayoutKind::NCHWc:
+        return block;
+    default:
+        return 1;
+    }
+}
+
+int TensorLayout::index(int c, int element, int channels, int plane) const
+{
+    return base(c, plane) + element * stride(channels);
+}
+
+int TensorLayout::size(int channels, int plane) const
+{
+    return ((channels + block - 1) / block) * block * plane;
+}
+
+string TensorLayout::to_string() const
+{
+    switch (kind)
+    {
+    case LayoutKind::NHWC:
+        return "nhwc";
+    case LayoutKind::NCHWc:
+        return "nchw" + std::to_string(block) + "c";
+    default:
+        return "nchw";
+    }
+}
+
+TensorLayout TensorLayout::from_string(const string& layout)
+{
+    if (layout == "nchw")
+    {
+        return TensorLayout(LayoutKind::NCHW);
+    }
+    else if (layout == "nhwc")
+    {
+        return TensorLayout(LayoutKind::NHWC);
+    }
+    else if (layout.size() > 5 && layout.compare(0, 4, "nchw") == 0 && layout.back() == 'c')
+    {
+        string block = layout.substr(4, layout.size() - 5);
+        if (block.find_first_not_of("0123456789") == string::npos && std::stoi(block) > 0)
+        {
+            return TensorLayout(LayoutKind::NCHWc, std::stoi(block));
+        }
+    }
+    throw std::invalid_argument("layout must be one of nchw, nhwc or nchw<block>c");
+}
@@ -0,0 +1,236 @@
+#define SC_INCLUDE_DYNAMIC_PROCESSES
+#include "TrafficGenerator.hh"
+#include <algorithm>
+#include <assert.h>
+#include <stdexcept>
+
+TrafficPattern traffic_pattern_from_string(const string& pattern)
+{
+    if (pattern == "sequential")
+    {
+        return TrafficPattern::SEQUENTIAL;
+    }
+    if (pattern == "strided")
+    {
+        return TrafficPattern::STRIDED;
+    }
+    if (pattern == "random")
+    {
+        return TrafficPattern::RANDOM;
+    }
+    throw std::invalid_argument("unknown traffic pattern " + pattern + ", expected sequential, strided or random");
+}
+
+void TrafficConfig::validate() const
+{
+    if (size == 0 || range < size)
+    {
+        throw std::invalid_argument("traffic needs a transaction size of at least a byte and a range that holds one");
+    }
+    if (pattern == TrafficPattern::STRIDED && (stride == 0 || stride % size))
+    {
+        throw std::invalid_argument("strides must be a positive multiple of the transaction size");
+    }
+    if (read_fraction < 0.0 || read_fraction > 1.0)
+    {
+        throw std::invalid_argument("the read fraction must lie in [0, 1]");
+    }
+    if (max_outstanding == 0)
+    {
+        throw std::invalid_argument("traffic needs at least one outstanding transaction");
+    }
+}
+
+TrafficSequence::TrafficSequence(const TrafficConfig& _config)
+    : config(_config), rng(_config.seed), issued(0)
+{
+    config.validate();
+}
+
+TrafficRequest TrafficSequence::next()
+{
+    sc_dt::uint64 slots = config.range / config.size;
+    sc_dt::uint64 offset = 0;
+    switch (config.pattern)
+    {
+    case TrafficPattern::SEQUENTIAL:
+        offset = (issued % slots) * config.size;
+        break;
+    case TrafficPattern::STRIDED:
+        offset = (issued * (config.stride / config.size) % slots) * config.size;
+        break;
+    case TrafficPattern::RANDOM:
+        offset = std::uniform_int_distribution<sc_dt::uint64>(0, slots - 1)(rng) * config.size;
+        break;
+    }
+    issued++;
+    bool read = std::bernoulli_distribution(config.read_fraction)(rng);
+    return {(read) ? tlm::TLM_READ_COMMAND : tlm::TLM_WRITE_COMMAND, config.base + offset};
+}
+
+TrafficStats::TrafficStats(unsigned long int _window_cycles)
+    : window_cycles(_window_cycles)
+{
+    assert(window_cycles > 0);
+}
+
+void TrafficStats::record(unsigned long int issue_cycle, unsigned long int done_cycle, unsigned int length, bool read, bool ok)
+{
+    assert(done_cycle >= issue_cycle && issue_cycle >= first_issue);
+    if (!ok)
+    {
+        errors++;
+        return;
+    }
+    reads += read;
+    writes += !read;
+    bytes += length;
+    latency[done_cycle - issue_cycle]++;
+    last_done = std::max(last_done, done_cycle);
+    size_t window = (done_cycle - first_issue) / window_cycles;
+    if (window_bytes.size() <= window)
+    {
+        window_bytes.resize(window + 1, 0);
+    }
+    window_bytes[window] += length;
+}
+
+unsigned long int TrafficStats::transactions() const
+{
+    return reads + writes;
+}
+
+double TrafficStats::mean_latency() const
+{
+    double total = 0.0;
+    for (auto& bucket : latency)
+    {
+        total += (double)bucket.first * bucket.second;
+    }
+    return (transactions()) ? total / transactions() : 0.0;
+}
+
+unsigned long int TrafficStats::latency_percentile(double fraction) const
+{
+    unsigned long int seen = 0;
+    for (auto& bucket : latency)
+    {
+        seen += bucket.second;
+        if (seen >= fraction * transactions())
+        {
+            return bucket.first;
+        }
+    }
+    return (latency.empty()) ? 0 : latency.rbegin()->first;
+}
+
+vector<unsigned long int> TrafficStats::log2_histogram() const
+{
+    vector<unsigned long int> histogram;
+    for (auto& bucket : latency)
+    {
+        size_t bin = 0;
+        for (unsigned long int cycles = bucket.first; cycles > 0; cycles >>= 1)
+        {
+            bin++;
+        }
+        if (histogram.size() <= bin)
+        {
+            histogram.resize(bin + 1, 0);
+        }
+        histogram[bin] += bucket.second;
+    }
+    return histogram;
+}
+
+double TrafficStats::bytes_per_cycle() const
+{
+    return (last_done > first_issue) ? (double)bytes / (last_done - first_issue) : 0.0;
+}
+
+double TrafficStats::transactions_per_wall_second() const
+{
+    return (wall_seconds > 0.0) ? transactions() / wall_seconds : 0.0;
+}
+
+template <unsigned int BUSWIDTH>
+TrafficGenerator<BUSWIDTH>::TrafficGenerator(sc_module_name name, const TrafficConfig& _config, sc_time _cycle, unsigned long int window_cycles)
+    : sc_module(name),
+      socket("socket"),
+      config(_config),
+      cycle(_cycle),
+      stats(window_cycles),
+      after(nullptr),
+      sequence(_config),
+      issued(0),
+      completed(0)
+{
+    SC_THREAD(starter);
+    for (unsigned int slot = 0; slot < config.max_outstanding; slot++)
+    {
+        string worker_name = "worker_" + std::to_string(slot);
+        sc_spawn(sc_bind(&TrafficGenerator<BUSWIDTH>::worker, this), worker_name.c_str());
+    }
+}
+
+template <unsigned int BUSWIDTH>
+void TrafficGenerator<BUSWIDTH>::starter()
+{
+    if (after)
+    {
+        wait(*after);
+    }
+    next_issue = sc_time_stamp();
+    stats.first_issue = next_issue / cycle;
+    wall_start = std::chrono::high_resolution_clock::now();
+    start.notify(SC_ZERO_TIME);
+}
+
+template <unsigned int BUSWIDTH>
+void TrafficGenerator<BUSWIDTH>::worker()
+{
+    vector<unsigned char> data(config.size);
+    tlm::tlm_generic_payload trans;
+    wait(start);
+    while (issued < config.transactions)
+    {
+        issued++;
+        TrafficRequest request = sequence.next();
+        // the issue slot is taken now so the rate holds across workers
+        sc_time issue = std::max(sc_time_stamp(), next_issue);
+        next_issue = issue + config.interval;
+        if (issue > sc_time_stamp())
+        {
+            wait(issue - sc_time_stamp());
+        }
+
+        std::fill(data.begin(), data.end(), (unsigned char)issued);
+        trans.set_command(request.cmd);
+        trans.set_address(request.addr);
+        trans.set_data_ptr(data.data());
+        trans.set_data_length(config.size);
+        trans.set_streaming_width(config.size);
+        trans.set_byte_enable_ptr(nullptr);
+        trans.set_dmi_allowed(false);
+        trans.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
+
+        sc_time delay = SC_ZERO_TIME;
+        socket->b_transport(trans, delay);
+        wait(delay);
+
+        stats.record(issue / cycle, sc_time_stamp() / cycle, config.size, request.cmd == tlm::TLM_READ_COMMAND, trans.is_response_ok());
+        if (++completed == config.transactions)
+        {
+            stats.wall_seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - wall_start).count();
+            done.notify(SC_ZERO_TIME);
+        }
+    }
+}
+
+template struct TrafficGenerator<8>;
+template struct TrafficGenerator<32>;
+template struct TrafficGenerator<64>;
+template struct TrafficGenerator<128>;
+template struct TrafficGenerator<256>;
+template struct TrafficGenerator<512>;
+template struct TrafficGenerator<1024>;
@@ -0,0 +1,65 @@
+#include "Watchdog.hh"
+#include <cmath>
+
+void StateHasher::add(uint64_t value)
+{
+    for (int byte = 0; byte < 8; byte++)
+    {
+        hash ^= (value >> (8 * byte)) & 0xff;
+        hash *= 1099511628211ULL;
+    }
+}
+
+WatchdogVerdict ProgressWatchdog::observe(uint64_t state_signature)
+{
+    if (verdict != WatchdogVerdict::RUNNING)
+    {
+        return verdict;
+    }
+    if (cycles == 0 || state_signature != signature)
+    {
+        signature = state_signature;
+        last_change = cycles;
+    }
+    cycles++;
+    if (cycle_budget && cycles > cycle_budget)
+    {
+        verdict = WatchdogVerdict::OVER_BUDGET;
+    }
+    else if (stall_limit && cycles - last_change > stall_limit)
+    {
+        verdict = WatchdogVerdict::STALLED;
+    }
+    return verdict;
+}
+
+bool ProgressWatchdog::tripped() const
+{
+    return verdict != WatchdogVerdict::RUNNING;
+}
+
+string ProgressWatchdog::reason() const
+{
+    switch (verdict)
+    {
+    case WatchdogVerdict::OVER_BUDGET:
+        return "cycle budget of " + std::to_string(cycle_budget) + " exceeded";
+    case WatchdogVerdict::STALLED:
+        return "no generator or PE state changed for " + std::to_string(cycles - last_change) + " cycles since cycle " + std::to_string(last_change);
+    default:
+        return "running";
+    }
+}
+
+void ProgressWatchdog::reset()
+{
+    cycles = 0;
+    last_change = 0;
+    signature = 0;
+    verdict = WatchdogVerdict::RUNNING;
+}
+
+unsigned long int cycle_budget_from_estimate(long int estimated_cycles, double margin, unsigned long int slack)
+{
+    return (unsigned long int)std::ceil(estimated_cycles * margin) + slack;
+}
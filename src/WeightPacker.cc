@@ -0,0 +1,100 @@
+#include "WeightPacker.hh"
+#include <algorithm>
+#include <stdexcept>
+
+WeightDelivery weight_delivery_from_string(const string& delivery)
+{
+    if (delivery == "row")
+    {
+        return WeightDelivery::ROW;
+    }
+    else if (delivery == "column")
+    {
+        return WeightDelivery::COLUMN;
+    }
+    throw std::invalid_argument("weight delivery must be one of row or column");
+}
+
+int weight_channel_lines(int lines, int weight_channel_count, int channel)
+{
+    return (lines - channel + weight_channel_count - 1) / weight_channel_count;
+}
+
+WeightTiles::WeightTiles(int _f_out, int _reduction, const Mapping& mapping)
+    : f_out(_f_out), reduction(_reduction), filter_tile(mapping.filter_tile), channel_tile(mapping.channel_tile)
+{
+    verticle_tile_count = (f_out + filter_tile - 1) / filter_tile;
+    horizontal_tile_count = (reduction + channel_tile - 1) / channel_tile;
+}
+
+int WeightTiles::tile_count() const
+{
+    return verticle_tile_count * horizontal_tile_count;
+}
+
+bool WeightTiles::filter_active(int verticle_tile, int filter_row) const
+{
+    return filter_row < filter_tile && verticle_tile * filter_tile + filter_row < f_out;
+}
+
+bool WeightTiles::column_active(int horizontal_tile, int channel_column) const
+{
+    return channel_column < channel_tile && horizontal_tile * channel_tile + channel_column < reduction;
+}
+
+const int* PackedWeights::word(int addr) const
+{
+    return data.data() + addr * lanes;
+}
+
+PackedWeights pack_weights(const int* weights, int f_out, int reduction, const Mapping& mapping,
+                           int filter_count, int channel_count, WeightDelivery delivery, int weight_channel_count)
+{
+    assert(mapping.filter_tile <= filter_count && mapping.channel_tile <= channel_count);
+    WeightTiles tiles(f_out, reduction, mapping);
+    auto schedule = mapping.tile_schedule(tiles.verticle_tile_count, tiles.horizontal_tile_count);
+    int lines = (delivery == WeightDelivery::ROW) ? filter_count : channel_count;
+
+    PackedWeights packed;
+    packed.lanes = (delivery == WeightDelivery::ROW) ? channel_count : filter_count;
+    packed.tile_count = schedule.size();
+    packed.words = packed.tile_count * lines;
+    packed.data.assign(packed.words * packed.lanes, weight_packer::PAD);
+    unsigned int region_base = 0;
+    for (int channel = 0; channel < weight_channel_count; channel++)
+    {
+        packed.region_base.push_back(region_base);
+        region_base += packed.tile_count * weight_channel_lines(lines, weight_channel_count, channel);
+    }
+
+    for (int step = 0; step < packed.tile_count; step++)
+    {
+        int filter_start = schedule[step].first * mapping.filter_tile;
+        int column_start = schedule[step].second * mapping.channel_tile;
+        int filters = std::min(mapping.filter_tile, f_out - filter_start);
+        int columns = std::min(mapping.channel_tile, reduction - column_start);
+        for (int line = 0; line < lines; line++)
+        {
+            int channel = line % weight_channel_count;
+            int addr = packed.region_base[channel] + step * weight_channel_lines(lines, weight_channel_count, channel) + line / weight_channel_count;
+            int* word = packed.data.data() + addr * packed.lanes;
+            if (delivery == WeightDelivery::ROW)
+            {
+                if (line < filters)
+                {
+                    const int* src = weights + (filter_start + line) * reduction + column_start;
+                    std::copy(src, src + columns, word);
+                }
+            }
+            else if (line < columns)
+            {
+                const int* src = weights + filter_start * reduction + column_start + line;
+                for (int lane = 0; lane < filters; lane++)
+                {
+                    word[lane] = src[lane * reduction];
+                }
+            }
+        }
+    }
+    return packed;
+}
@@ -0,0 +1,234 @@
+#include "ZeroCompression.hh"
+#include <stdexcept>
+
+CompressionFormat compression_format_from_string(const string& format)
+{
+    if (format == "none")
+    {
+        return CompressionFormat::NONE;
+    }
+    else if (format == "bitmask")
+    {
+        return CompressionFormat::BITMASK;
+    }
+    else if (format == "rle")
+    {
+        return CompressionFormat::RLE;
+    }
+    throw std::invalid_argument("compression must be one of none, bitmask or rle");
+}
+
+string compression_format_to_string(CompressionFormat format)
+{
+    switch (format)
+    {
+    case CompressionFormat::BITMASK:
+        return "bitmask";
+    case CompressionFormat::RLE:
+        return "rle";
+    default:
+        return "none";
+    }
+}
+
+int CompressedPlane::words() const
+{
+    return metadata.size() + values.size();
+}
+
+CompressedPlane compress_plane(const int* data, int length, CompressionFormat format)
+{
+    CompressedPlane plane;
+    plane.length = length;
+    switch (format)
+    {
+    case CompressionFormat::BITMASK:
+    {
+        plane.metadata.assign((length + BITMASK_BITS_PER_WORD - 1) / BITMASK_BITS_PER_WORD, 0);
+        for (int element = 0; element < length; element++)
+        {
+            if (data[element] != 0)
+            {
+                plane.metadata[element / BITMASK_BITS_PER_WORD] |= 1u << (element % BITMASK_BITS_PER_WORD);
+                plane.values.push_back(data[element]);
+            }
+        }
+        break;
+    }
+    case CompressionFormat::RLE:
+    {
+        vector<int> runs;
+        int run = 0;
+        for (int element = 0; element < length; element++)
+        {
+            if (data[element] == 0 && run < RLE_MAX_RUN)
+            {
+                run++;
+                continue;
+            }
+            runs.push_back(run);
+            plane.values.push_back(data[element]);
+            run = 0;
+        }
+        // explicit zeros closing the plane only split a trailing run
+        while (!plane.values.empty() && plane.values.back() == 0)
+        {
+            runs.pop_back();
+            plane.values.pop_back();
+        }
+        plane.metadata.assign((runs.size() + RLE_RUNS_PER_WORD - 1) / RLE_RUNS_PER_WORD, 0);
+        for (unsigned int pair = 0; pair < runs.size(); pair++)
+        {
+            plane.metadata[pair / RLE_RUNS_PER_WORD] |= (unsigned int)runs[pair] << ((pair % RLE_RUNS_PER_WORD) * RLE_RUN_BITS);
+        }
+        break;
+    }
+    default:
+        plane.values.assign(data, data + length);
+    }
+    return plane;
+}
+
+vector<int> decompress_plane(const CompressedPlane& plane, CompressionFormat format)
+{
+    vector<int> data(plane.length, 0);
+    switch (format)
+    {
+    case CompressionFormat::BITMASK:
+    {
+        int slot = 0;
+        for (int element = 0; element < plane.length; element++)
+        {
+            if ((plane.metadata[element / BITMASK_BITS_PER_WORD] >> (element % BITMASK_BITS_PER_WORD)) & 1)
+            {
+                data[element] = plane.values[slot++];
+            }
+        }
+        break;
+    }
+    case CompressionFormat::RLE:
+    {
+        int element = 0;
+        for (unsigned int pair = 0; pair < plane.values.size(); pair++)
+        {
+            int run = (plane.metadata[pair / RLE_RUNS_PER_WORD] >> ((pair % RLE_RUNS_PER_WORD) * RLE_RUN_BITS)) & RLE_MAX_RUN;
+            element += run;
+            data[element++] = plane.values[pair];
+        }
+        break;
+    }
+    default:
+        data = plane.values;
+    }
+    return data;
+}
+
+template <typename DataType>
+ZeroDecompressor<DataType>::ZeroDecompressor()
+{
+    clear(1, CompressionFormat::NONE);
+}
+
+template <typename DataType>
+void ZeroDecompressor<DataType>::clear(int _plane_length, CompressionFormat _format)
+{
+    assert(_plane_length > 0);
+    this->plane_length = _plane_length;
+    this->format = _format;
+    plane_base.clear();
+    plane_metadata_words.clear();
+    value_slot.clear();
+    metadata_word.clear();
+    reset();
+}
+
+template <typename DataType>
+void ZeroDecompressor<DataType>::reset()
+{
+    last_metadata.clear();
+}
+
+template <typename DataType>
+void ZeroDecompressor<DataType>::add_plane(const CompressedPlane& plane, int base)
+{
+    assert(plane.length == plane_length);
+    vector<int> slots(plane_length, -1);
+    vector<int> words(plane_length, 0);
+    switch (format)
+    {
+    case CompressionFormat::BITMASK:
+    {
+        int slot = 0;
+        for (int element = 0; element < plane_length; element++)
+        {
+            words[element] = element / BITMASK_BITS_PER_WORD;
+            if ((plane.metadata[words[element]] >> (element % BITMASK_BITS_PER_WORD)) & 1)
+            {
+                slots[element] = slot++;
+            }
+        }
+        break;
+    }
+    case CompressionFormat::RLE:
+    {
+        // zeros of a run are decoded from the run length of the pair ending it
+        int element = 0;
+        for (unsigned int pair = 0; pair < plane.values.size(); pair++)
+        {
+            int run = (plane.metadata[pair / RLE_RUNS_PER_WORD] >> ((pair % RLE_RUNS_PER_WORD) * RLE_RUN_BITS)) & RLE_MAX_RUN;
+            for (int zero = 0; zero < run; zero++)
+            {
+                words[element++] = pair / RLE_RUNS_PER_WORD;
+            }
+            words[element] = pair / RLE_RUNS_PER_WORD;
+            slots[element++] = pair;
+        }
+        // trailing zeros need no metadata
+        for (; element < plane_length; element++)
+        {
+            words[element] = -1;
+        }
+        break;
+    }
+    default:
+        for (int element = 0; element < plane_length; element++)
+        {
+            slots[element] = element;
+            words[element] = -1;
+        }
+    }
+    plane_base.push_back(base);
+    plane_metadata_words.push_back(plane.metadata.size());
+    value_slot.push_back(slots);
+    metadata_word.push_back(words);
+}
+
+template <typename DataType>
+DataType ZeroDecompressor<DataType>::read(unsigned int channel, unsigned int addr, sc_vector<sc_vector<sc_signal<DataType>>>& ram, int& access_counter)
+{
+    unsigned int plane = addr / plane_length;
+    unsigned int element = addr % plane_length;
+    assert(plane < plane_base.size());
+    if (channel >= last_metadata.size())
+    {
+        last_metadata.resize(channel + 1, -1);
+    }
+
+    int word = metadata_word[plane][element];
+    long int tag = (long int)plane * plane_length + word;
+    if (word >= 0 && last_metadata[channel] != tag)
+    {
+        access_counter++;
+        last_metadata[channel] = tag;
+    }
+
+    int slot = value_slot[plane][element];
+    if (slot < 0)
+    {
+        return 0;
+    }
+    access_counter++;
+    return ram.at(plane_base[plane] + plane_metadata_words[plane] + slot).at(0).read();
+}
+
+template struct ZeroDecompressor<sc_int<32>>;
@@ -1,6 +1,28 @@
 #include "sock2sig.hh"
 
 #include <algorithm>
+#include <cstring>
+
+template <unsigned int BUSWIDTH, bool WIDE>
+typename SockBeat<BUSWIDTH, WIDE>::type SockBeat<BUSWIDTH, WIDE>::pack(
+    const uint8_t* bytes, size_t count) {
+  uint64_t value = 0;
+  memcpy(&value, bytes, count);
+  return type(value);
+}
+
+template <unsigned int BUSWIDTH>
+typename SockBeat<BUSWIDTH, true>::type SockBeat<BUSWIDTH, true>::pack(
+    const uint8_t* bytes, size_t count) {
+  // one range assignment per 64 bits rather than per byte
+  type value = 0;
+  for (size_t lo = 0; lo < count; lo += 8) {
+    uint64_t part = 0;
+    memcpy(&part, bytes + lo, std::min<size_t>(8, count - lo));
+    value.range(std::min<size_t>(8 * lo + 63, BUSWIDTH - 1), 8 * lo) = part;
+  }
+  return value;
+}
 
 template <unsigned int BUSWIDTH>
 Sock2Sig<BUSWIDTH>::Sock2Sig(int readyDelay, sc_module_name moduleName)
@@ -57,9 +79,8 @@ void Sock2Sig<BUSWIDTH>::updateOutput() {
         static_cast<size_t>(BUSWIDTH % 8 ? (BUSWIDTH + 8) / 8 : BUSWIDTH / 8),
         currentData->size() - byteOffset);
 
-    uint64_t value = 0;
-
-    memcpy(&value, &(*currentData)[byteOffset], bytesToCopy);
+    auto value = SockBeat<BUSWIDTH>::pack(&(*currentData)[byteOffset],
+                                          bytesToCopy);
 
     // TODO: Non-byte aligned widths, revisit when needed
     // // Trim bits already read
@@ -70,7 +91,7 @@ void Sock2Sig<BUSWIDTH>::updateOutput() {
     // value <<= (64 - BUSWIDTH);
     // bitOffset = (bitOffset + BUSWIDTH) % 8;
 
-    outputSig = sc_int<BUSWIDTH>(value);
+    outputSig = value;
 
     byteOffset += (bitOffset + BUSWIDTH) / 8;
 
@@ -94,4 +115,8 @@ void Sock2Sig<BUSWIDTH>::updateOutput() {
 
 template class Sock2Sig<8>;
 template class Sock2Sig<32>;
-template class Sock2Sig<64>;
\ No newline at end of file
+template class Sock2Sig<64>;
+template class Sock2Sig<128>;
+template class Sock2Sig<256>;
+template class Sock2Sig<512>;
+template class Sock2Sig<1024>;
\ No newline at end of file
@@ -412,6 +412,52 @@ struct AddressGenerator_TB : public sc_module
         return true;
     }
 
+    bool validate_generation_modulo()
+    {
+        cout << "Validating validate_generation_modulo" << endl;
+        control.set_enable(false);
+        control.set_reset(true);
+        sc_start(1, SC_NS);
+        control.set_reset(false);
+        sc_start(1, SC_NS);
+
+        // 8 reads from a 6 entry ring at 8 starting 3 entries in
+        Descriptor_2D ring_descriptor = Descriptor_2D::ring_stream_inst(11, 7, 8, 6);
+        Descriptor_2D suspend_descriptor(1, 0, DescriptorState::SUSPENDED, 0, 0, 0,
+                                         0);
+        vector<Descriptor_2D> temp_program;
+        temp_program.push_back(ring_descriptor);
+        temp_program.push_back(suspend_descriptor);
+
+        dut.loadProgram(temp_program);
+        control.set_program(true);
+        sc_start(1, SC_NS);
+        control.set_program(false);
+        control.set_enable(true);
+        sc_start(1, SC_NS);
+
+        vector<unsigned int> expected = {11, 12, 13, 8, 9, 10, 11, 12};
+        for (unsigned int i = 0; i < expected.size(); i++)
+        {
+            if (i != 0)
+            {
+                sc_start(1, SC_NS);
+            }
+            if (!(mem_channel.addr() == expected[i]))
+            {
+                cout << "mem_channel.addr() == " << expected[i] << " FAILED!" << endl;
+                return false;
+            }
+        }
+        if (!(ring_descriptor.wrap(7) == 13 && ring_descriptor.wrap(20) == 8))
+        {
+            cout << "wrap below and above the ring FAILED!" << endl;
+            return false;
+        }
+        cout << "validate_generation_modulo SUCCESS" << endl;
+        return true;
+    }
+
     int run_tb()
     {
 
@@ -445,6 +491,12 @@ struct AddressGenerator_TB : public sc_module
             return -1;
         }
 
+        if (!(validate_generation_modulo()))
+        {
+            cout << "validate_generation_modulo() FAILED!" << endl;
+            return -1;
+        }
+
         cout << "ALL TESTS PASS" << endl;
 
         return 0;
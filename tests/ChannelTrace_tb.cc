@@ -0,0 +1,145 @@
+#include "ChannelTrace.hh"
+#include <systemc>
+
+// #define DEBUG
+using std::cout;
+using std::endl;
+
+struct ChannelTrace_TB
+{
+    bool same(const ChannelTrace& a, const ChannelTrace& b)
+    {
+        if (a.channel_count != b.channel_count || a.length != b.length || a.width != b.width || a.accesses.size() != b.accesses.size())
+        {
+            return false;
+        }
+        for (unsigned int idx = 0; idx < a.accesses.size(); idx++)
+        {
+            auto& x = a.accesses[idx];
+            auto& y = b.accesses[idx];
+            if (x.cycle != y.cycle || x.channel != y.channel || x.mode != y.mode || x.addr != y.addr)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // two channels streaming neighbouring lines every cycle
+    ChannelTrace streaming_trace()
+    {
+        ChannelTrace trace(2, 64, 1);
+        for (unsigned int cycle = 0; cycle < 4; cycle++)
+        {
+            trace.record(cycle, 0, MemoryChannelMode::READ, 2 * cycle);
+            trace.record(cycle, 1, MemoryChannelMode::READ, 2 * cycle + 1);
+        }
+        return trace;
+    }
+
+    bool validate_encoding()
+    {
+        cout << "Validating validate_encoding" << endl;
+        ChannelTrace trace(3, 1024, 4);
+        trace.record(100, 0, MemoryChannelMode::READ, 10);
+        trace.record(100, 2, MemoryChannelMode::WRITE, 900);
+        trace.record(101, 0, MemoryChannelMode::READ, 11);
+        trace.record(150, 2, MemoryChannelMode::WRITE, 3);
+        trace.record(150, 1, MemoryChannelMode::READ, 0);
+        auto image = trace.encode();
+        if (!same(ChannelTrace::decode(image), trace))
+        {
+            cout << "decode(encode()) FAILED!" << endl;
+            return false;
+        }
+        // sequential streams take 3 bytes a record after the header
+        auto streaming = streaming_trace();
+        if (streaming.encode().size() > 4 + 1 + 5 + 3 * streaming.accesses.size())
+        {
+            cout << "streaming image " << streaming.encode().size() << " bytes FAILED!" << endl;
+            return false;
+        }
+        trace.save("ChannelTrace_tb.trace");
+        if (!same(ChannelTrace::load("ChannelTrace_tb.trace"), trace))
+        {
+            cout << "load(save()) FAILED!" << endl;
+            return false;
+        }
+        image[0] = 'X';
+        try
+        {
+            ChannelTrace::decode(image);
+            cout << "bad magic accepted FAILED!" << endl;
+            return false;
+        }
+        catch (const std::runtime_error&)
+        {
+        }
+        cout << "validate_encoding SUCCESS" << endl;
+        return true;
+    }
+
+    bool validate_replay()
+    {
+        cout << "Validating validate_replay" << endl;
+        auto trace = streaming_trace();
+        auto configs = replay_configs_from_string("1:0:1,2:0:1,1:0:2,2:3:1");
+        auto results = replay_variants(trace, configs, 3);
+
+        // one bank serves the two channels in turn, every cycle stalls one more
+        if (results[0].stall_cycles != 4 || results[0].conflict_cycles != 4 || results[0].cycles != 8)
+        {
+            cout << "single bank cycles " << results[0].cycles << " FAILED!" << endl;
+            return false;
+        }
+        // even and odd lines in their own banks keep the recorded pace
+        if (results[1].stall_cycles != 0 || results[1].cycles != 4 || results[1].bank_accesses[0] != 4 || results[1].bank_utilization() != 1.0)
+        {
+            cout << "two bank cycles " << results[1].cycles << " FAILED!" << endl;
+            return false;
+        }
+        // a double wide line holds both channels' words
+        if (results[2].line_accesses != 4 || results[2].cycles != 4)
+        {
+            cout << "wide line accesses " << results[2].line_accesses << " FAILED!" << endl;
+            return false;
+        }
+        if (results[3].cycles != 7)
+        {
+            cout << "latency cycles " << results[3].cycles << " FAILED!" << endl;
+            return false;
+        }
+        for (unsigned int idx = 0; idx < configs.size(); idx++)
+        {
+            if (replay_trace(trace, configs[idx]).cycles != results[idx].cycles)
+            {
+                cout << "threaded result " << idx << " differs FAILED!" << endl;
+                return false;
+            }
+        }
+        cout << "validate_replay SUCCESS" << endl;
+        return true;
+    }
+
+    int run_tb()
+    {
+        if (!validate_encoding())
+        {
+            cout << "validate_encoding() FAILED!" << endl;
+            return -1;
+        }
+        if (!validate_replay())
+        {
+            cout << "validate_replay() FAILED!" << endl;
+            return -1;
+        }
+        cout << "ALL TESTS PASS" << endl;
+        return 0;
+    }
+};
+
+int sc_main(int argc, char* argv[])
+{
+    ChannelTrace_TB tb;
+    return tb.run_tb();
+}
@@ -0,0 +1,204 @@
+#include <systemc.h>
+#include <map>
+#include <stdexcept>
+#include "ControlRegisters.hh"
+#include "iconnect.h"
+
+// #define DEBUG
+using std::cout;
+using std::endl;
+
+struct ControlRegisters_TB : public sc_module
+{
+    const sc_time cycle = sc_time(1, SC_NS);
+    const sc_dt::uint64 csr_base = 0x1000;
+
+    iconnect<1, 1> bus;
+    ControlRegisters csr;
+    DramPort host;
+
+    ProgramImage image;
+
+    // what the callbacks received
+    std::map<std::pair<ProgramTarget, unsigned int>, vector<Descriptor_2D>> programs;
+    std::map<unsigned int, vector<int>> weight_lines;
+    vector<unsigned int> region_base;
+    unsigned int preload_cycles;
+
+    ControlRegisters_TB(sc_module_name name) : sc_module(name),
+                                               bus("bus"),
+                                               csr("csr", cycle, CsrTiming()),
+                                               host("host", 0)
+    {
+        bus.memmap(csr_base, CSR_SIZE, ADDRMODE_RELATIVE, -1, csr.socket);
+        host.socket.bind(*bus.t_sk[0]);
+        bus.set_target_offset(0, 0);
+
+        csr.load_program = [this](ProgramTarget target, unsigned int idx, vector<Descriptor_2D> &program) { programs[{target, idx}] = program; };
+        csr.load_weight_line = [this](unsigned int addr, const vector<int> &line) { weight_lines[addr] = line; };
+        csr.set_region_base = [this](unsigned int channel, unsigned int base) { region_base.at(channel) = base; };
+        csr.set_preload_cycles = [this](unsigned int cycles) { preload_cycles = cycles; };
+
+        image.filter_count = 2;
+        image.channel_count = 2;
+        image.weight_channel_count = 2;
+        image.weight_lanes = 2;
+        image.layer = {2, 2, 1, 3, 3};
+        image.weight_preload_cycles = 7;
+        vector<Descriptor_2D> stream = {Descriptor_2D::delay_inst(2), Descriptor_2D::stream_inst(9, 8, 0), Descriptor_2D::suspend_inst()};
+        Descriptor_2D::make_sequential(stream);
+        vector<Descriptor_2D> pe = {Descriptor_2D::delay_inst(1), Descriptor_2D::genhold_inst(0, 9, 1, 1), Descriptor_2D::suspend_inst()};
+        image.programs = {{ProgramTarget::PSUM_GENERATOR, 1, stream}, {ProgramTarget::PE, 3, pe}};
+        image.weight_region_base = {0, 3};
+        image.weight_words = 6;
+        image.weights = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12};
+        cout << "Instantiated ControlRegisters TB with name " << this->name() << endl;
+    }
+
+    void reset()
+    {
+        csr.reset();
+        host.local_time = SC_ZERO_TIME;
+        programs.clear();
+        weight_lines.clear();
+        region_base.assign(2, 0);
+        preload_cycles = 0;
+    }
+
+    bool configured()
+    {
+        if (preload_cycles != 7 || region_base[1] != 3 || csr.committed != 2)
+        {
+            cout << "preload/region base/commits FAILED!" << endl;
+            return false;
+        }
+        for (auto &entry : image.programs)
+        {
+            auto &program = programs[{entry.target, entry.index}];
+            if (program.size() != entry.program.size() || program[1].x_count != entry.program[1].x_count || program[1].start != entry.program[1].start || program[1].state != entry.program[1].state)
+            {
+                cout << "program " << entry.index << " FAILED!" << endl;
+                return false;
+            }
+        }
+        if (weight_lines.size() != 6 || weight_lines[5] != vector<int>({11, 12}))
+        {
+            cout << "weight lines FAILED!" << endl;
+            return false;
+        }
+        return true;
+    }
+
+    bool validate_registers()
+    {
+        cout << "Validating validate_registers" << endl;
+        reset();
+        uint32_t id = 0;
+        host.transfer(tlm::TLM_READ_COMMAND, csr_base + CSR_ID, (unsigned char *)&id, 4);
+        if (id != CSR_ID_VALUE)
+        {
+            cout << "CSR_ID " << std::hex << id << std::dec << " FAILED!" << endl;
+            return false;
+        }
+        sc_time done = configure_from_image(host, csr_base, image, ConfigPath::REGISTERS);
+        if (!configured())
+        {
+            return false;
+        }
+        // every word is a register access: id, lanes, preload, 2 x (select, base),
+        // 2 x (select, 3 descriptors, commit), weight addr and 12 weights
+        unsigned long int accesses = 1 + 2 + 4 + 2 * (2 + 3 * PROGRAM_IMAGE_DESCRIPTOR_WORDS) + 1 + 12;
+        if (csr.burst_accesses != 0 || csr.register_accesses != accesses || done != cycle * (accesses * CsrTiming().register_cycles))
+        {
+            cout << csr.register_accesses << " register accesses done at " << done << " FAILED!" << endl;
+            return false;
+        }
+        cout << "validate_registers SUCCESS" << endl;
+        return true;
+    }
+
+    bool validate_dma()
+    {
+        cout << "Validating validate_dma" << endl;
+        reset();
+        sc_time done = configure_from_image(host, csr_base, image, ConfigPath::DMA);
+        if (!configured())
+        {
+            return false;
+        }
+        // descriptors and weights arrive in one burst each
+        CsrTiming timing;
+        unsigned long int registers = 2 + 4 + 2 * 2 + 1;
+        sc_time bursts = cycle * (2 * (timing.burst_setup_cycles + 3 * PROGRAM_IMAGE_DESCRIPTOR_WORDS) + timing.burst_setup_cycles + 12);
+        if (csr.burst_accesses != 3 || csr.register_accesses != registers || done != cycle * (registers * timing.register_cycles) + bursts)
+        {
+            cout << csr.burst_accesses << " bursts done at " << done << " FAILED!" << endl;
+            return false;
+        }
+        cout << "validate_dma SUCCESS" << endl;
+        return true;
+    }
+
+    bool fails(sc_dt::uint64 offset, uint32_t word, tlm::tlm_command cmd = tlm::TLM_WRITE_COMMAND)
+    {
+        try
+        {
+            host.transfer(cmd, csr_base + offset, (unsigned char *)&word, 4);
+        }
+        catch (std::runtime_error &e)
+        {
+            return true;
+        }
+        return false;
+    }
+
+    bool validate_errors()
+    {
+        cout << "Validating validate_errors" << endl;
+        reset();
+        // half a descriptor can't be committed
+        uint32_t words[PROGRAM_IMAGE_DESCRIPTOR_WORDS / 2] = {0};
+        host.transfer(tlm::TLM_WRITE_COMMAND, csr_base + CSR_PROGRAM_SELECT, (unsigned char *)words, 4);
+        host.transfer(tlm::TLM_WRITE_COMMAND, csr_base + CSR_DESCRIPTOR_FIFO, (unsigned char *)words, sizeof(words));
+        if (!fails(CSR_PROGRAM_COMMIT, 1) || csr.committed != 0)
+        {
+            cout << "partial descriptor committed FAILED!" << endl;
+            return false;
+        }
+        if (!fails(CSR_ID, 0) || !fails(CSR_WEIGHT_ADDR, 0, tlm::TLM_READ_COMMAND) || !fails(CSR_SIZE, 0) || !fails(CSR_WEIGHT_FIFO, 1))
+        {
+            cout << "illegal access accepted FAILED!" << endl;
+            return false;
+        }
+        cout << "validate_errors SUCCESS" << endl;
+        return true;
+    }
+
+    int run_tb()
+    {
+        sc_start(SC_ZERO_TIME);
+        if (!validate_registers())
+        {
+            cout << "validate_registers() FAILED!" << endl;
+            return -1;
+        }
+        if (!validate_dma())
+        {
+            cout << "validate_dma() FAILED!" << endl;
+            return -1;
+        }
+        if (!validate_errors())
+        {
+            cout << "validate_errors() FAILED!" << endl;
+            return -1;
+        }
+        cout << "ALL TESTS PASS" << endl;
+        return 0;
+    }
+};
+
+int sc_main(int argc, char *argv[])
+{
+    ControlRegisters_TB tb("ControlRegisters_tb");
+    return tb.run_tb();
+}
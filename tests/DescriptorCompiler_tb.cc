@@ -0,0 +1,147 @@
+#include "DescriptorCompiler.hh"
+#include "ReuseAnalysis.hh"
+#include <systemc>
+
+// #define DEBUG
+using std::cout;
+using std::endl;
+
+struct DescriptorCompiler_TB
+{
+    // rows 1..2, columns 2..4 of a 4x6 tensor
+    const AccessPattern window = AccessPattern::slice({4, 6}, {1, 2}, {2, 3});
+
+    bool validate_lowering()
+    {
+        cout << "Validating validate_lowering" << endl;
+        auto program = lower_access_pattern(window);
+        vector<unsigned int> expected = {8, 9, 10, 14, 15, 16};
+        if (program.size() != 3 || expand_program(program) != expected)
+        {
+            cout << "lowered window FAILED!" << endl;
+            return false;
+        }
+        // two streams of three, each with its switch bubble
+        if (program_cycles(program) != 2 * (3 + 1))
+        {
+            cout << "program_cycles() != 8 FAILED!" << endl;
+            return false;
+        }
+        cout << "validate_lowering SUCCESS" << endl;
+        return true;
+    }
+
+    bool validate_merge()
+    {
+        cout << "Validating validate_merge" << endl;
+        // the window and the one two rows down, plus every row of the whole tensor
+        for (auto pattern : {window.repeated(2, 12), AccessPattern::slice({4, 6}, {0, 0}, {4, 6})})
+        {
+            auto lowered = lower_access_pattern(pattern);
+            auto compiled = compile_access_pattern(pattern);
+            if (expand_program(compiled.program) != expand_program(lowered))
+            {
+                cout << "merged addresses differ FAILED!" << endl;
+                return false;
+            }
+            if (compiled.program.size() != 2 || compiled.descriptors_saved() != (int)lowered.size() - 2 || compiled.cycles_saved() != (long int)lowered.size() - 2)
+            {
+                cout << "merged to " << compiled.program.size() << " descriptors, " << compiled.cycles_saved() << " cycles saved FAILED!" << endl;
+                return false;
+            }
+        }
+        cout << "validate_merge SUCCESS" << endl;
+        return true;
+    }
+
+    bool validate_hoist()
+    {
+        cout << "Validating validate_hoist" << endl;
+        // the same run of four three times, then the next one
+        AccessPattern pattern{5, {{2, 10}, {3, 0}, {4, 1}}, 0};
+        auto lowered = lower_access_pattern(pattern);
+        auto hoisted = lower_access_pattern(pattern, true);
+        if (lowered.size() != 7 || hoisted.size() != 3 || expand_program(hoisted) != expand_program(lowered))
+        {
+            cout << "hoisted " << hoisted.size() << " descriptors FAILED!" << endl;
+            return false;
+        }
+        auto compiled = compile_access_pattern(pattern);
+        if (compiled.reports.size() != 4 || compiled.reports[1].pass != "hoist" || compiled.reports[1].descriptors != 3)
+        {
+            cout << "hoist report FAILED!" << endl;
+            return false;
+        }
+        cout << "validate_hoist SUCCESS" << endl;
+        return true;
+    }
+
+    bool validate_coalesce()
+    {
+        cout << "Validating validate_coalesce" << endl;
+        vector<Descriptor_2D> program = {Descriptor_2D::delay_inst(3), Descriptor_2D::delay_inst(5), Descriptor_2D::stream_inst(0, 4, 0), Descriptor_2D::suspend_inst()};
+        Descriptor_2D::make_sequential(program);
+        auto compiled = optimize_program(program);
+        if (compiled.program.size() != 3 || compiled.program[0].x_count != 3 + 5 + 2)
+        {
+            cout << "coalesced delay FAILED!" << endl;
+            return false;
+        }
+        // delays coalesce cycle exact
+        if (compiled.cycles_saved() != 0 || compiled.descriptors_saved() != 1)
+        {
+            cout << "coalesce changed the cycles FAILED!" << endl;
+            return false;
+        }
+        // gaps between runs keep the streams apart
+        AccessPattern gapped = window;
+        gapped.gap = 4;
+        auto kept = compile_access_pattern(gapped);
+        if (kept.program.size() != 4 || kept.descriptors_saved() != 0)
+        {
+            cout << "gapped streams merged FAILED!" << endl;
+            return false;
+        }
+        // non sequential programs are left alone
+        program[0].next = 2;
+        if (optimize_program(program).program.size() != program.size())
+        {
+            cout << "non sequential program changed FAILED!" << endl;
+            return false;
+        }
+        cout << "validate_coalesce SUCCESS" << endl;
+        return true;
+    }
+
+    int run_tb()
+    {
+        if (!validate_lowering())
+        {
+            cout << "validate_lowering() FAILED!" << endl;
+            return -1;
+        }
+        if (!validate_merge())
+        {
+            cout << "validate_merge() FAILED!" << endl;
+            return -1;
+        }
+        if (!validate_hoist())
+        {
+            cout << "validate_hoist() FAILED!" << endl;
+            return -1;
+        }
+        if (!validate_coalesce())
+        {
+            cout << "validate_coalesce() FAILED!" << endl;
+            return -1;
+        }
+        cout << "ALL TESTS PASS" << endl;
+        return 0;
+    }
+};
+
+int sc_main(int argc, char* argv[])
+{
+    DescriptorCompiler_TB tb;
+    return tb.run_tb();
+}
@@ -0,0 +1,93 @@
+#include "Extrapolation.hh"
+#include <cmath>
+#include <systemc>
+
+// #define DEBUG
+using std::cout;
+using std::endl;
+
+struct Extrapolation_TB
+{
+    // 36 long reduction over 10 wide tiles, 8 filters over 3 high tiles
+    const LayerShape layer{4, 8, 3, 5, 5};
+    const Mapping mapping{UnrollOrientation::HORIZONTAL, LoopOrder::FILTER_TILES_OUTER, 3, 10};
+
+    bool validate_strata()
+    {
+        cout << "Validating validate_strata" << endl;
+        auto strata = stratify_tiles(mapping, layer);
+        // filters, columns, accumulate, tiles
+        vector<vector<int>> expected = {{2, 6, 1, 1}, {2, 10, 0, 1}, {2, 10, 1, 2}, {3, 6, 1, 2}, {3, 10, 0, 2}, {3, 10, 1, 4}};
+        if (strata.size() != expected.size())
+        {
+            cout << "strata.size() != 6 FAILED!" << endl;
+            return false;
+        }
+        for (unsigned int h = 0; h < strata.size(); h++)
+        {
+            if (strata[h].filters != expected[h][0] || strata[h].columns != expected[h][1] || strata[h].accumulate != (bool)expected[h][2] || (int)strata[h].tiles.size() != expected[h][3])
+            {
+                cout << "stratum " << h << " FAILED!" << endl;
+                return false;
+            }
+        }
+        // the last filter tile's last channel tile is the corner
+        if (strata[0].tiles.front() != 11)
+        {
+            cout << "corner tile != 11 FAILED!" << endl;
+            return false;
+        }
+        cout << "validate_strata SUCCESS" << endl;
+        return true;
+    }
+
+    bool validate_extrapolation()
+    {
+        cout << "Validating validate_extrapolation" << endl;
+        // a measurement at the target rows is the cost
+        auto exact = extrapolate_rows({2, 4, 5}, {7, 9, 11}, 5);
+        if (exact.estimate != 11.0 || exact.error != 0.0)
+        {
+            cout << "exact " << exact.estimate << " +- " << exact.error << " FAILED!" << endl;
+            return false;
+        }
+        // an affine cost extrapolates without error
+        auto affine = extrapolate_rows({1, 2, 3}, {5, 7, 9}, 10);
+        if (affine.estimate != 23.0 || affine.error != 0.0)
+        {
+            cout << "affine " << affine.estimate << " +- " << affine.error << " FAILED!" << endl;
+            return false;
+        }
+        // r^2 misses the chord through 2 and 3 by (5 - 2) * (5 - 3) at 5
+        auto curved = extrapolate_rows({1, 2, 3}, {1, 4, 9}, 5);
+        if (std::fabs(curved.estimate - 19.0) > 1e-9 || std::fabs(curved.error - 6.0) > 1e-9 || curved.high() < 25.0 - 1e-9)
+        {
+            cout << "curved " << curved.estimate << " +- " << curved.error << " FAILED!" << endl;
+            return false;
+        }
+        cout << "validate_extrapolation SUCCESS" << endl;
+        return true;
+    }
+
+    int run_tb()
+    {
+        if (!validate_strata())
+        {
+            cout << "validate_strata() FAILED!" << endl;
+            return -1;
+        }
+        if (!validate_extrapolation())
+        {
+            cout << "validate_extrapolation() FAILED!" << endl;
+            return -1;
+        }
+        cout << "ALL TESTS PASS" << endl;
+        return 0;
+    }
+};
+
+int sc_main(int argc, char* argv[])
+{
+    Extrapolation_TB tb;
+    return tb.run_tb();
+}
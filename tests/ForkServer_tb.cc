@@ -0,0 +1,252 @@
+#include "ForkServer.hh"
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <set>
+#include <sstream>
+#include <systemc>
+#include <unistd.h>
+
+// #define DEBUG
+using std::cout;
+using std::endl;
+
+// stands in for the environment, prints like it from its arguments
+int fake_configuration(int argc, char* argv[])
+{
+    string mode = (argc > 1) ? argv[1] : "";
+    if (mode == "--crash")
+    {
+        abort();
+    }
+    if (mode == "--hang")
+    {
+        cout << "Simulating arch with config:" << endl;
+        while (true)
+        {
+            sleep(1);
+        }
+    }
+    if (mode == "--fail")
+    {
+        cout << "error: bad config" << endl;
+        cout << "FAIL" << endl;
+        return 1;
+    }
+    cout << "Simulating arch with config:" << endl;
+    cout << "PASS" << endl;
+    cout << std::left << std::setw(20) << "Latency in cycles" << argc << endl;
+    cout << std::left << std::setw(20) << "Simulated in " << 3 << "ms\n";
+    return 0;
+}
+
+struct ForkServer_TB
+{
+    bool validate_split()
+    {
+        cout << "Validating validate_split" << endl;
+        auto args = split_config_line("  --ifmap_h 10 --pool \"max\" --name 'a b'  # comment");
+        vector<string> expected = {"--ifmap_h", "10", "--pool", "max", "--name", "a b"};
+        if (args != expected)
+        {
+            cout << "split args FAILED!" << endl;
+            return false;
+        }
+        if (!split_config_line("   ").empty() || !split_config_line("# only a comment").empty())
+        {
+            cout << "blank lines not empty FAILED!" << endl;
+            return false;
+        }
+        try
+        {
+            split_config_line("--name 'open");
+            cout << "unterminated quote accepted FAILED!" << endl;
+            return false;
+        }
+        catch (std::invalid_argument&)
+        {
+        }
+        cout << "validate_split SUCCESS" << endl;
+        return true;
+    }
+
+    bool validate_parse()
+    {
+        cout << "Validating validate_parse" << endl;
+        std::stringstream output;
+        output << "PASS" << endl;
+        output << std::left << std::setw(20) << "DRAM Access" << 1234 << endl;
+        output << std::left << std::setw(20) << "Avg. Pe Util" << 0.5 << endl;
+        output << std::left << std::setw(20) << "Mapping" << "horizontal filters_outer 7x9" << endl;
+        output << "Simulating arch with config:" << endl;
+        auto result = parse_config_result(3, "--k 1", 0, output.str());
+        if (result.status != "PASS" || result.metrics.size() != 3 || result.metrics["DRAM Access"] != "1234")
+        {
+            cout << "parsed metrics FAILED!" << endl;
+            return false;
+        }
+        string expected = "{\"id\": 3, \"config\": \"--k 1\", \"status\": \"PASS\", \"exit_code\": 0, \"metrics\": {\"Avg. Pe Util\": 0.5, \"DRAM Access\": 1234, \"Mapping\": \"horizontal filters_outer 7x9\"}}";
+        if (result.to_json() != expected)
+        {
+            cout << result.to_json() << " != " << expected << " FAILED!" << endl;
+            return false;
+        }
+        // only JSON's number grammar goes out bare, and only if it fits a double
+        for (string bare : {"0", "-12", "0.5", "1234", "-1.5e+3", "2E-7"})
+        {
+            if (json_value(bare) != bare)
+            {
+                cout << bare << " not a number FAILED!" << endl;
+                return false;
+            }
+        }
+        for (string text : {"0123456", "12e4567", "1e400", "+1", "1.", ".5", "1e", "-", "inf", "nan", "0x10", ""})
+        {
+            if (json_value(text) != "\"" + text + "\"")
+            {
+                cout << text << " not a string FAILED!" << endl;
+                return false;
+            }
+        }
+        std::stringstream build;
+        build << "PASS" << endl;
+        build << std::left << std::setw(20) << "Build" << "1234567" << endl;
+        if (parse_config_result(0, "", 0, build.str()).to_json().find("\"Build\": \"1234567\"") == string::npos)
+        {
+            cout << "Build not a string FAILED!" << endl;
+            return false;
+        }
+        if (parse_config_result(0, "", 0, "").status != "CRASH" || json_escape("a\"b\\\n") != "a\\\"b\\\\\\n")
+        {
+            cout << "crash status or escaping FAILED!" << endl;
+            return false;
+        }
+        cout << "validate_parse SUCCESS" << endl;
+        return true;
+    }
+
+    bool validate_server()
+    {
+        cout << "Validating validate_server" << endl;
+        std::stringstream in, out;
+        in << "--a 1" << endl;
+        in << endl;
+        in << "--fail" << endl;
+        in << "--crash" << endl;
+        in << "--b 2 --c" << endl;
+        in << "'unterminated" << endl;
+        ForkServer server(2, "fake");
+        if (server.run(in, out, fake_configuration) != 5 || server.failed != 3)
+        {
+            cout << "completed " << server.completed << " failed " << server.failed << " FAILED!" << endl;
+            return false;
+        }
+        std::set<int> ids;
+        string line;
+        while (std::getline(out, line))
+        {
+#ifdef DEBUG
+            cout << line << endl;
+#endif
+            auto id_at = line.find("\"id\": ");
+            int id = atoi(line.c_str() + id_at + 6);
+            ids.insert(id);
+            bool ok = true;
+            if (id == 0 || id == 3)
+            {
+                // argc counts the program name
+                string latency = (id == 0) ? "3" : "4";
+                ok = line.find("\"status\": \"PASS\"") != string::npos && line.find("\"Latency in cycles\": " + latency) != string::npos && line.find("\"Simulated in\": \"3ms\"") != string::npos;
+            }
+            else if (id == 1)
+            {
+                ok = line.find("\"status\": \"FAIL\", \"exit_code\": 1, \"error\": \"bad config\"") != string::npos;
+            }
+            else if (id == 2)
+            {
+                ok = line.find("\"status\": \"CRASH\"") != string::npos && line.find("\"exit_code\": -") != string::npos;
+            }
+            if (!ok)
+            {
+                cout << line << " FAILED!" << endl;
+                return false;
+            }
+        }
+        if (ids != std::set<int>{0, 1, 2, 3, 4})
+        {
+            cout << "result ids != 0..4 FAILED!" << endl;
+            return false;
+        }
+        cout << "validate_server SUCCESS" << endl;
+        return true;
+    }
+
+    bool validate_timeout()
+    {
+        cout << "Validating validate_timeout" << endl;
+        std::stringstream in, out;
+        in << "--hang" << endl;
+        in << "--a 1" << endl;
+        ForkServer server(2, "fake", 0.5);
+        auto start = std::chrono::steady_clock::now();
+        if (server.run(in, out, fake_configuration) != 2 || server.failed != 1)
+        {
+            cout << "completed " << server.completed << " failed " << server.failed << " FAILED!" << endl;
+            return false;
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (seconds > 5.0)
+        {
+            cout << "hung configuration ran for " << seconds << " s FAILED!" << endl;
+            return false;
+        }
+        string line;
+        while (std::getline(out, line))
+        {
+#ifdef DEBUG
+            cout << line << endl;
+#endif
+            bool hung = line.find("\"id\": 0") != string::npos;
+            bool ok = (hung) ? line.find("\"status\": \"FAIL\", \"exit_code\": -9, \"error\": \"timed out after 0.5 s\"") != string::npos : line.find("\"status\": \"PASS\"") != string::npos;
+            if (!ok)
+            {
+                cout << line << " FAILED!" << endl;
+                return false;
+            }
+        }
+        cout << "validate_timeout SUCCESS" << endl;
+        return true;
+    }
+
+    int run_tb()
+    {
+        if (!validate_split())
+        {
+            cout << "validate_split() FAILED!" << endl;
+            return -1;
+        }
+        if (!validate_parse())
+        {
+            cout << "validate_parse() FAILED!" << endl;
+            return -1;
+        }
+        if (!validate_server())
+        {
+            cout << "validate_server() FAILED!" << endl;
+            return -1;
+        }
+        if (!validate_timeout())
+        {
+            cout << "validate_timeout() FAILED!" << endl;
+            return -1;
+        }
+        cout << "ALL TESTS PASS" << endl;
+        return 0;
+    }
+};
+
+int sc_main(int argc, char* argv[])
+{
+    ForkServer_TB tb;
+    return tb.run_tb();
+}
@@ -0,0 +1,133 @@
+#include "GlobalBuffer.hh"
+#include <stdexcept>
+#include <systemc>
+
+// #define DEBUG
+using std::cout;
+using std::endl;
+
+struct GlobalBuffer_TB
+{
+    const int capacity = 1024;
+    const int channel_pool = 24;
+
+    bool validate_allocation()
+    {
+        cout << "Validating validate_allocation" << endl;
+        GlobalBuffer buffer(capacity, channel_pool);
+        buffer.allocate(400, 6, 300, 8, 100, 4);
+        if (buffer.region(BufferRegion::PSUM).base != 400 || buffer.region(BufferRegion::WEIGHT).base != 700)
+        {
+            cout << "regions not back to back FAILED!" << endl;
+            return false;
+        }
+        if (buffer.used_words() != 800 || buffer.used_channels() != 18 || buffer.utilization() != 800.0 / capacity)
+        {
+            cout << "used_words/used_channels/utilization FAILED!" << endl;
+            return false;
+        }
+        // the next layer may split the same buffer the other way round
+        buffer.allocate(100, 6, 800, 8, 100, 4);
+        if (buffer.region(BufferRegion::IFMAP).words != 100 || buffer.region(BufferRegion::PSUM).words != 800)
+        {
+            cout << "reallocation FAILED!" << endl;
+            return false;
+        }
+        cout << "validate_allocation SUCCESS" << endl;
+        return true;
+    }
+
+    bool validate_overcommit()
+    {
+        cout << "Validating validate_overcommit" << endl;
+        GlobalBuffer buffer(capacity, channel_pool);
+        bool thrown = false;
+        try
+        {
+            buffer.allocate(600, 6, 600, 8, 0, 0);
+        }
+        catch (std::length_error &e)
+        {
+            thrown = true;
+        }
+        if (!thrown || buffer.fits(100, 20, 100, 8, 0, 0))
+        {
+            cout << "over capacity/channel pool not rejected FAILED!" << endl;
+            return false;
+        }
+        cout << "validate_overcommit SUCCESS" << endl;
+        return true;
+    }
+
+    bool validate_verify()
+    {
+        cout << "Validating validate_verify" << endl;
+        GlobalBuffer buffer(capacity, channel_pool);
+        buffer.allocate(64, 4, 32, 8, 16, 2);
+
+        vector<Descriptor_2D> in_bounds = {Descriptor_2D::delay_inst(100), Descriptor_2D::stream_inst(32, 31, 0),
+                                           Descriptor_2D::ring_stream_inst(40, 99, 32, 32), Descriptor_2D::suspend_inst()};
+        vector<Descriptor_2D> out_of_bounds = {Descriptor_2D::stream_inst(0, 32, 0)};
+        vector<Descriptor_2D> strided_out_of_bounds = {Descriptor_2D::stream_inst(3, 16, 0, 4)};
+        try
+        {
+            buffer.verify(BufferRegion::IFMAP, in_bounds);
+            buffer.verify(BufferRegion::PSUM, out_of_bounds);
+            cout << "psum stream one past its region accepted FAILED!" << endl;
+            return false;
+        }
+        catch (std::out_of_range &e)
+        {
+        }
+        try
+        {
+            buffer.verify(BufferRegion::IFMAP, strided_out_of_bounds);
+            cout << "strided stream past its region accepted FAILED!" << endl;
+            return false;
+        }
+        catch (std::out_of_range &e)
+        {
+        }
+        // 4 word wide weight words, 4 addresses fill the 16 word region
+        vector<Descriptor_2D> weight_program = {Descriptor_2D::stream_inst(0, 3, 0)};
+        buffer.verify(BufferRegion::WEIGHT, weight_program, 4);
+        cout << "validate_verify SUCCESS" << endl;
+        return true;
+    }
+
+    int run_tb()
+    {
+        if (!validate_allocation())
+        {
+            cout << "validate_allocation() FAILED!" << endl;
+            return -1;
+        }
+        if (!validate_overcommit())
+        {
+            cout << "validate_overcommit() FAILED!" << endl;
+            return -1;
+        }
+        try
+        {
+            if (!validate_verify())
+            {
+                cout << "validate_verify() FAILED!" << endl;
+                return -1;
+            }
+        }
+        catch (std::exception &e)
+        {
+            cout << e.what() << endl;
+            cout << "validate_verify() FAILED!" << endl;
+            return -1;
+        }
+        cout << "ALL TESTS PASS" << endl;
+        return 0;
+    }
+};
+
+int sc_main(int argc, char* argv[])
+{
+    GlobalBuffer_TB tb;
+    return tb.run_tb();
+}
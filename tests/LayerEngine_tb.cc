@@ -0,0 +1,126 @@
+#include "LayerEngine.hh"
+#include <climits>
+#include <stdexcept>
+#include <systemc>
+
+// #define DEBUG
+using std::cout;
+using std::endl;
+
+struct LayerEngine_TB
+{
+    // 3 filters of 3x3x2 over a 6x5 ifmap on a 4x6 array
+    const LayerShape layer{2, 3, 3, 4, 3};
+    const ArrayShape array{4, 6, 2 * 6 * 5, 3 * 4 * 3};
+
+    bool validate_conv()
+    {
+        cout << "Validating validate_conv" << endl;
+        vector<int> ifmap(2 * 6 * 5), weights(3 * 2 * 3 * 3), ofmap(3 * 4 * 3, 0);
+        for (unsigned int i = 0; i < ifmap.size(); i++)
+        {
+            ifmap[i] = (int)(i * 7 % 11) - 5;
+        }
+        for (unsigned int i = 0; i < weights.size(); i++)
+        {
+            weights[i] = (int)(i * 5 % 9) - 4;
+        }
+        run_layer_engine(ifmap.data(), weights.data(), ofmap.data(), layer, Mapping::full_array(array), array);
+        for (int f = 0; f < 3; f++)
+        {
+            for (int y = 0; y < 4; y++)
+            {
+                for (int x = 0; x < 3; x++)
+                {
+                    int expected = 0;
+                    for (int c = 0; c < 2; c++)
+                    {
+                        for (int ky = 0; ky < 3; ky++)
+                        {
+                            for (int kx = 0; kx < 3; kx++)
+                            {
+                                expected += weights[((f * 2 + c) * 3 + ky) * 3 + kx] * ifmap[(c * 6 + y + ky) * 5 + x + kx];
+                            }
+                        }
+                    }
+                    if (ofmap[(f * 4 + y) * 3 + x] != expected)
+                    {
+                        cout << "ofmap[" << f << "][" << y << "][" << x << "] != " << expected << " FAILED!" << endl;
+                        return false;
+                    }
+                }
+            }
+        }
+        cout << "validate_conv SUCCESS" << endl;
+        return true;
+    }
+
+    bool validate_wrap()
+    {
+        cout << "Validating validate_wrap" << endl;
+        // 1x1 with two channels of INT_MAX, the sum wraps like sc_int<32>
+        LayerShape wide{2, 1, 1, 1, 11};
+        vector<int> ifmap(22, INT_MAX), weights = {1, 1}, ofmap(11, 0);
+        run_layer_engine(ifmap.data(), weights.data(), ofmap.data(), wide, Mapping::full_array(array), array);
+        if (ofmap[0] != -2 || ofmap[10] != -2)
+        {
+            cout << "wrapped sum " << ofmap[0] << " != -2 FAILED!" << endl;
+            return false;
+        }
+        cout << "validate_wrap SUCCESS" << endl;
+        return true;
+    }
+
+    bool validate_cost()
+    {
+        cout << "Validating validate_cost" << endl;
+        vector<int> ifmap(2 * 6 * 5, 1), weights(3 * 2 * 3 * 3, 1), ofmap(3 * 4 * 3, 0);
+        Mapping mapping(UnrollOrientation::HORIZONTAL, LoopOrder::CHANNEL_TILES_OUTER, 2, 5);
+        auto cost = run_layer_engine(ifmap.data(), weights.data(), ofmap.data(), layer, mapping, array);
+        auto expected = estimate_mapping_cost(mapping, layer, array);
+        if (cost.cycles != expected.cycles || cost.dram_words != expected.dram_words || cost.score != expected.score)
+        {
+            cout << "cost != estimate_mapping_cost FAILED!" << endl;
+            return false;
+        }
+        try
+        {
+            Mapping too_tall(UnrollOrientation::HORIZONTAL, LoopOrder::FILTER_TILES_OUTER, 5, 5);
+            run_layer_engine(ifmap.data(), weights.data(), ofmap.data(), layer, too_tall, array);
+            cout << "oversized mapping accepted FAILED!" << endl;
+            return false;
+        }
+        catch (std::invalid_argument&)
+        {
+        }
+        cout << "validate_cost SUCCESS" << endl;
+        return true;
+    }
+
+    int run_tb()
+    {
+        if (!validate_conv())
+        {
+            cout << "validate_conv() FAILED!" << endl;
+            return -1;
+        }
+        if (!validate_wrap())
+        {
+            cout << "validate_wrap() FAILED!" << endl;
+            return -1;
+        }
+        if (!validate_cost())
+        {
+            cout << "validate_cost() FAILED!" << endl;
+            return -1;
+        }
+        cout << "ALL TESTS PASS" << endl;
+        return 0;
+    }
+};
+
+int sc_main(int argc, char* argv[])
+{
+    LayerEngine_TB tb;
+    return tb.run_tb();
+}
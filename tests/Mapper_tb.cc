@@ -0,0 +1,181 @@
+#include "Mapper.hh"
+#include <systemc>
+
+// #define DEBUG
+using std::cout;
+using std::endl;
+
+struct Mapper_TB
+{
+    // 8 filters of 3x3x4 on a 4x6 array, 36 long reduction so 6 channel tiles
+    const LayerShape layer{4, 8, 3, 5, 5};
+    const ArrayShape array{4, 6, 4 * 7 * 7, 8 * 5 * 5};
+
+    bool validate_tile_schedule()
+    {
+        cout << "Validating validate_tile_schedule" << endl;
+        Mapping filters_outer(UnrollOrientation::HORIZONTAL, LoopOrder::FILTER_TILES_OUTER, 4, 6);
+        Mapping channels_outer(UnrollOrientation::HORIZONTAL, LoopOrder::CHANNEL_TILES_OUTER, 4, 6);
+        vector<pair<int, int>> expected_filters_outer = {{0, 0}, {0, 1}, {0, 2}, {1, 0}, {1, 1}, {1, 2}};
+        vector<pair<int, int>> expected_channels_outer = {{0, 0}, {1, 0}, {0, 1}, {1, 1}, {0, 2}, {1, 2}};
+        if (filters_outer.tile_schedule(2, 3) != expected_filters_outer)
+        {
+            cout << "filters_outer schedule FAILED!" << endl;
+            return false;
+        }
+        if (channels_outer.tile_schedule(2, 3) != expected_channels_outer)
+        {
+            cout << "channels_outer schedule FAILED!" << endl;
+            return false;
+        }
+        if (filters_outer.filter_tiles(layer) != 2 || filters_outer.channel_tiles(layer) != 6)
+        {
+            cout << "tile counts != 2x6 FAILED!" << endl;
+            return false;
+        }
+        cout << "validate_tile_schedule SUCCESS" << endl;
+        return true;
+    }
+
+    bool validate_orientation()
+    {
+        cout << "Validating validate_orientation" << endl;
+        Mapping verticle(UnrollOrientation::VERTICLE, LoopOrder::FILTER_TILES_OUTER, 6, 4);
+        if (verticle.filter_rows(array) != 6 || verticle.channel_cols(array) != 4)
+        {
+            cout << "verticle logical dims != 6x4 FAILED!" << endl;
+            return false;
+        }
+        // a horizontal mapping can't hold 6 filters on 4 rows
+        Mapping horizontal(UnrollOrientation::HORIZONTAL, LoopOrder::FILTER_TILES_OUTER, 6, 4);
+        if (!verticle.legal(layer, array) || horizontal.legal(layer, array))
+        {
+            cout << "orientation legality FAILED!" << endl;
+            return false;
+        }
+        cout << "validate_orientation SUCCESS" << endl;
+        return true;
+    }
+
+    bool validate_capacity()
+    {
+        cout << "Validating validate_capacity" << endl;
+        // room for two channels of the ifmap and two filters of the ofmap
+        ArrayShape small{array.rows, array.cols, 2 * layer.ifmap_size(), 2 * layer.ofmap_size()};
+        Mapping fits(UnrollOrientation::HORIZONTAL, LoopOrder::FILTER_TILES_OUTER, 2, 2);
+        Mapping too_wide(UnrollOrientation::HORIZONTAL, LoopOrder::FILTER_TILES_OUTER, 2, 3);
+        Mapping too_tall(UnrollOrientation::HORIZONTAL, LoopOrder::FILTER_TILES_OUTER, 3, 2);
+        if (!fits.legal(layer, small) || too_wide.legal(layer, small) || too_tall.legal(layer, small))
+        {
+            cout << "capacity legality FAILED!" << endl;
+            return false;
+        }
+        for (auto& mapping : enumerate_mappings(layer, small))
+        {
+            if (!mapping.legal(layer, small))
+            {
+                cout << mapping.to_string() << " enumerated but not legal FAILED!" << endl;
+                return false;
+            }
+        }
+        cout << "validate_capacity SUCCESS" << endl;
+        return true;
+    }
+
+    bool validate_cost()
+    {
+        cout << "Validating validate_cost" << endl;
+        Mapping mapping = Mapping::full_array(array);
+        auto cost = estimate_mapping_cost(mapping, layer, array);
+        long int stream_size = layer.ofmap_size();
+        if (cost.macs != 8 * 36 * stream_size)
+        {
+            cout << "macs != " << 8 * 36 * stream_size << " FAILED!" << endl;
+            return false;
+        }
+        if (cost.cycles != (6 + 2) + 2 * 6 * (stream_size + 1))
+        {
+            cout << "cycles != " << (6 + 2) + 2 * 6 * (stream_size + 1) << " FAILED!" << endl;
+            return false;
+        }
+        if (cost.psum_writes != 8 * 6 * stream_size || cost.psum_reads != 8 * 5 * stream_size)
+        {
+            cout << "psum accesses FAILED!" << endl;
+            return false;
+        }
+        // ifmap and ofmap both resident, every word crosses DRAM once
+        long int dram_words = 8 * 36 + 4 * layer.ifmap_size() + 8 * stream_size;
+        if (cost.dram_words != dram_words || cost.pe_utilization > 1.0)
+        {
+            cout << "dram_words != " << dram_words << " FAILED!" << endl;
+            return false;
+        }
+        cout << "validate_cost SUCCESS" << endl;
+        return true;
+    }
+
+    bool validate_search()
+    {
+        cout << "Validating validate_search" << endl;
+        auto ranked = search_mappings(layer, array);
+        if (ranked.size() != enumerate_mappings(layer, array).size())
+        {
+            cout << "ranked.size() FAILED!" << endl;
+            return false;
+        }
+        for (unsigned int i = 1; i < ranked.size(); i++)
+        {
+            if (ranked[i].second.score < ranked[i - 1].second.score)
+            {
+                cout << "ranking not sorted at " << i << " FAILED!" << endl;
+                return false;
+            }
+        }
+        // a mapping that fills the array can't lose to a smaller tile of itself
+        auto best = ranked.front().first;
+        if (best.filter_tile != best.filter_rows(array) || best.channel_tile != best.channel_cols(array))
+        {
+            cout << "best " << best.to_string() << " leaves PEs idle FAILED!" << endl;
+            return false;
+        }
+        cout << "validate_search SUCCESS" << endl;
+        return true;
+    }
+
+    int run_tb()
+    {
+        if (!validate_tile_schedule())
+        {
+            cout << "validate_tile_schedule() FAILED!" << endl;
+            return -1;
+        }
+        if (!validate_orientation())
+        {
+            cout << "validate_orientation() FAILED!" << endl;
+            return -1;
+        }
+        if (!validate_capacity())
+        {
+            cout << "validate_capacity() FAILED!" << endl;
+            return -1;
+        }
+        if (!validate_cost())
+        {
+            cout << "validate_cost() FAILED!" << endl;
+            return -1;
+        }
+        if (!validate_search())
+        {
+            cout << "validate_search() FAILED!" << endl;
+            return -1;
+        }
+        cout << "ALL TESTS PASS" << endl;
+        return 0;
+    }
+};
+
+int sc_main(int argc, char* argv[])
+{
+    Mapper_TB tb;
+    return tb.run_tb();
+}
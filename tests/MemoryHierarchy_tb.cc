@@ -0,0 +1,131 @@
+#include "MemoryHierarchy.hh"
+#include <systemc>
+
+// #define DEBUG
+using std::cout;
+using std::endl;
+
+template <typename DataType>
+struct MemoryHierarchy_TB : public sc_module
+{
+    // dram like outer level, 4 word global buffer lines, 1 word local lines
+    const vector<MemoryLevelConfig> configs = {{16, 4, 3}, {32, 2, 1}, {64, 1, 0}};
+    sc_trace_file* tf;
+    GlobalControlChannel control;
+    MemoryHierarchy<DataType> dut;
+
+    MemoryHierarchy_TB(sc_module_name name) : sc_module(name),
+                                              tf(sc_create_vcd_trace_file("MemoryHierarchyTrace")),
+                                              control("global_control_channel", sc_time(1, SC_NS), tf),
+                                              dut("dut", control, configs, tf)
+    {
+        tf->set_time_unit(1, SC_PS);
+        cout << "Instantiated MemoryHierarchy TB with name " << this->name() << endl;
+    }
+
+    void reset()
+    {
+        control.set_reset(true);
+        control.set_program(false);
+        control.set_enable(false);
+        sc_start(1, SC_NS);
+        control.set_reset(false);
+        sc_start(1, SC_NS);
+    }
+
+    bool validate_parse()
+    {
+        cout << "Validating validate_parse" << endl;
+        auto parsed = memory_levels_from_string("16:4:3,32:2:1,64:1:0");
+        if (parsed.size() != 3 || parsed[0].length != 16 || parsed[1].width != 2 || parsed[2].latency != 0)
+        {
+            cout << "parsed levels FAILED!" << endl;
+            return false;
+        }
+        for (auto bad : {"16:4", "16:3:1,8:2:1", "0:1:1", ""})
+        {
+            try
+            {
+                memory_levels_from_string(bad);
+                cout << "\"" << bad << "\" accepted FAILED!" << endl;
+                return false;
+            }
+            catch (const std::invalid_argument&)
+            {
+            }
+        }
+        cout << "validate_parse SUCCESS" << endl;
+        return true;
+    }
+
+    bool validate_transfer()
+    {
+        cout << "Validating validate_transfer" << endl;
+        reset();
+        vector<int> words;
+        for (int idx = 0; idx < 24; idx++)
+        {
+            words.push_back(idx + 1);
+        }
+        dut.load(words);
+
+        // lines 0-5 of the outer level land at line 4 onwards of the middle level,
+        // then all 12 middle lines go to the start of the local level
+        dut.run_transfer(0, 0, 4, 6);
+        dut.run_transfer(1, 4, 0, 12);
+
+        for (int idx = 0; idx < 24; idx++)
+        {
+            if (dut.word(1, 8 + idx) != words[idx])
+            {
+                cout << "level 1 word " << 8 + idx << " != " << words[idx] << " FAILED!" << endl;
+                return false;
+            }
+            if (dut.word(2, idx) != words[idx])
+            {
+                cout << "level 2 word " << idx << " != " << words[idx] << " FAILED!" << endl;
+                return false;
+            }
+        }
+        if (dut.read_lines[0] != 6 || dut.write_lines[1] != 12 || dut.read_lines[1] != 12 || dut.write_lines[2] != 24)
+        {
+            cout << "line counters FAILED!" << endl;
+            return false;
+        }
+        // load, one word per access per transfer, plus the checks above
+        if (dut.levels[0].mem.access_counter != 24 + 24 || dut.levels[2].mem.access_counter != 24 + 24)
+        {
+            cout << "access counters FAILED!" << endl;
+            return false;
+        }
+        if (dut.read_utilization(0) <= 0.0 || dut.write_utilization(2) > 1.0)
+        {
+            cout << "utilization FAILED!" << endl;
+            return false;
+        }
+        cout << "validate_transfer SUCCESS" << endl;
+        return true;
+    }
+
+    int run_tb()
+    {
+        if (!validate_parse())
+        {
+            cout << "validate_parse() FAILED!" << endl;
+            return -1;
+        }
+        if (!validate_transfer())
+        {
+            cout << "validate_transfer() FAILED!" << endl;
+            return -1;
+        }
+        cout << "ALL TESTS PASS" << endl;
+        return 0;
+    }
+};
+
+int sc_main(int argc, char* argv[])
+{
+    MemoryHierarchy_TB<sc_int<32>> tb("MemoryHierarchy_tb");
+    return tb.run_tb();
+}
@@ -0,0 +1,162 @@
+#include "PostProcessor.hh"
+#include <systemc>
+#include <map>
+
+// #define DEBUG
+using std::cout;
+using std::endl;
+using std::map;
+
+template <typename DataType>
+struct PostProcessor_TB : public sc_module
+{
+    const unsigned int ofmap_h = 4;
+    const unsigned int ofmap_w = 5;
+    const unsigned int pass_count = 2;
+    const unsigned int region_base = 40;
+
+    PostProcessor<DataType> dut;
+
+    PostProcessor_TB(sc_module_name name) : sc_module(name)
+    {
+        cout << "Instantiated PostProcessor TB with name " << this->name() << endl;
+    }
+
+    // streams pass_count passes of the ofmap through the dut the same way
+    // a psum write generator would, returns the committed writes
+    map<unsigned int, long int> stream(int final_pass_offset)
+    {
+        map<unsigned int, long int> committed;
+        unsigned int stream_size = ofmap_h * ofmap_w;
+        for (unsigned int pass = 0; pass < pass_count; pass++)
+        {
+            for (unsigned int element = 0; element < stream_size; element++)
+            {
+                unsigned int addr = region_base + element;
+                DataType data = (pass == pass_count - 1) ? (int)element + final_pass_offset : (int)element;
+                if (dut.process(addr, data))
+                {
+                    committed[addr] = (long int)data;
+                }
+            }
+        }
+        return committed;
+    }
+
+    bool validate_passthrough()
+    {
+        cout << "Validating validate_passthrough" << endl;
+        PostProcessConfig config;
+        dut.configure(config, {0}, pass_count, ofmap_h, ofmap_w);
+        auto committed = stream(0);
+        for (unsigned int element = 0; element < ofmap_h * ofmap_w; element++)
+        {
+            if (committed.at(region_base + element) != (long int)element)
+            {
+                cout << "committed[" << region_base + element << "] != " << element << " FAILED!" << endl;
+                return false;
+            }
+        }
+        if (dut.processed_counter != (int)(ofmap_h * ofmap_w) || dut.suppressed_write_counter != 0)
+        {
+            cout << "passthrough counters FAILED!" << endl;
+            return false;
+        }
+        cout << "validate_passthrough SUCCESS" << endl;
+        return true;
+    }
+
+    bool validate_bias_relu_clamp()
+    {
+        cout << "Validating validate_bias_relu_clamp" << endl;
+        PostProcessConfig config;
+        config.bias = true;
+        config.relu = true;
+        config.clamp = true;
+        config.clamp_min = 0;
+        config.clamp_max = 6;
+        dut.configure(config, {-10}, pass_count, ofmap_h, ofmap_w);
+        auto committed = stream(5);
+        for (unsigned int element = 0; element < ofmap_h * ofmap_w; element++)
+        {
+            long int expected = std::min(std::max((long int)element + 5 - 10, 0L), 6L);
+            if (committed.at(region_base + element) != expected)
+            {
+                cout << "committed[" << region_base + element << "] != " << expected << " FAILED!" << endl;
+                return false;
+            }
+        }
+        cout << "validate_bias_relu_clamp SUCCESS" << endl;
+        return true;
+    }
+
+    bool validate_pool(PoolMode mode)
+    {
+        cout << "Validating validate_pool" << endl;
+        PostProcessConfig config;
+        config.pool = mode;
+        dut.configure(config, {0}, pass_count, ofmap_h, ofmap_w);
+        auto committed = stream(0);
+
+        unsigned int pooled_h = ofmap_h / 2;
+        unsigned int pooled_w = ofmap_w / 2;
+        // first pass commits every element, final pass only the pooled ones
+        if (committed.size() != ofmap_h * ofmap_w)
+        {
+            cout << "committed.size() != " << ofmap_h * ofmap_w << " FAILED!" << endl;
+            return false;
+        }
+        for (unsigned int i = 0; i < pooled_h; i++)
+        {
+            for (unsigned int j = 0; j < pooled_w; j++)
+            {
+                long int top_left = 2 * i * ofmap_w + 2 * j;
+                long int expected = (mode == PoolMode::MAX) ? top_left + ofmap_w + 1 : (4 * top_left + 2 * ofmap_w + 2) / 4;
+                if (committed.at(region_base + i * pooled_w + j) != expected)
+                {
+                    cout << "pooled[" << i << "][" << j << "] != " << expected << " FAILED!" << endl;
+                    return false;
+                }
+            }
+        }
+        if (dut.suppressed_write_counter != (int)(ofmap_h * ofmap_w - pooled_h * pooled_w))
+        {
+            cout << "suppressed_write_counter != " << ofmap_h * ofmap_w - pooled_h * pooled_w << " FAILED!" << endl;
+            return false;
+        }
+        cout << "validate_pool SUCCESS" << endl;
+        return true;
+    }
+
+    int run_tb()
+    {
+        if (!validate_passthrough())
+        {
+            cout << "validate_passthrough() FAILED!" << endl;
+            return -1;
+        }
+        if (!validate_bias_relu_clamp())
+        {
+            cout << "validate_bias_relu_clamp() FAILED!" << endl;
+            return -1;
+        }
+        if (!validate_pool(PoolMode::MAX))
+        {
+            cout << "validate_pool(PoolMode::MAX) FAILED!" << endl;
+            return -1;
+        }
+        if (!validate_pool(PoolMode::AVG))
+        {
+            cout << "validate_pool(PoolMode::AVG) FAILED!" << endl;
+            return -1;
+        }
+        cout << "ALL TESTS PASS" << endl;
+        return 0;
+    }
+};
+
+int sc_main(int argc, char* argv[])
+{
+    PostProcessor_TB<sc_int<32>> tb("PostProcessor_tb");
+    return tb.run_tb();
+}
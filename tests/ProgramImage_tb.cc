@@ -0,0 +1,194 @@
+#include "ProgramImage.hh"
+#include <cstdio>
+#include <stdexcept>
+#include <systemc>
+
+// #define DEBUG
+using std::cout;
+using std::endl;
+
+struct ProgramImage_TB
+{
+    ProgramImage image;
+
+    ProgramImage_TB()
+    {
+        image.filter_count = 2;
+        image.channel_count = 3;
+        image.weight_channel_count = 2;
+        image.weight_lanes = 3;
+        image.layer = {3, 2, 1, 4, 4};
+        image.weight_preload_cycles = 9;
+
+        vector<Descriptor_2D> stream = {Descriptor_2D::delay_inst(4), Descriptor_2D::stream_inst(16, 15, 0, 3), Descriptor_2D::suspend_inst()};
+        Descriptor_2D::make_sequential(stream);
+        vector<Descriptor_2D> ring = {Descriptor_2D::ring_stream_inst(5, 15, 4, 8), Descriptor_2D::suspend_inst()};
+        Descriptor_2D::make_sequential(ring);
+        vector<Descriptor_2D> pe = {Descriptor_2D::delay_inst(1), Descriptor_2D::genhold_inst(0, 16, 1, 1), Descriptor_2D::suspend_inst()};
+        image.programs = {{ProgramTarget::IFMAP_GENERATOR, 0, stream}, {ProgramTarget::IFMAP_GENERATOR, 1, ring}, {ProgramTarget::PE, 5, pe}};
+        image.weight_region_base = {0, 2};
+        image.weight_words = 4;
+        for (int weight = 0; weight < 12; weight++)
+        {
+            image.weights.push_back(weight - 6);
+        }
+    }
+
+    static bool same(const vector<Descriptor_2D>& a, const vector<Descriptor_2D>& b)
+    {
+        if (a.size() != b.size())
+        {
+            return false;
+        }
+        for (unsigned int idx = 0; idx < a.size(); idx++)
+        {
+            auto& x = a[idx];
+            auto& y = b[idx];
+            if (x.next != y.next || x.start != y.start || x.state != y.state || x.repeat != y.repeat || x.x_count != y.x_count || x.x_modify != y.x_modify ||
+                x.y_count != y.y_count || x.y_modify != y.y_modify || x.x_counter != y.x_counter || x.y_counter != y.y_counter ||
+                x.modulo_base != y.modulo_base || x.modulo_length != y.modulo_length)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool matches(const ProgramImageView& view)
+    {
+        if (view.filter_count != 2 || view.channel_count != 3 || view.weight_lanes != 3 || view.layer.c_in != 3 || view.layer.ofmap_w != 4 || view.weight_preload_cycles != 9)
+        {
+            cout << "header FAILED!" << endl;
+            return false;
+        }
+        if (view.program_count != image.programs.size() || view.descriptor_count != 8)
+        {
+            cout << view.program_count << " programs of " << view.descriptor_count << " descriptors FAILED!" << endl;
+            return false;
+        }
+        for (unsigned int entry = 0; entry < view.program_count; entry++)
+        {
+            if (view.target(entry) != image.programs[entry].target || view.index(entry) != image.programs[entry].index || !same(view.program(entry), image.programs[entry].program))
+            {
+                cout << "program " << entry << " FAILED!" << endl;
+                return false;
+            }
+        }
+        if (view.region_base(1) != 2 || view.weight(0, 0) != -6 || view.weight(3, 2) != 5)
+        {
+            cout << "weights FAILED!" << endl;
+            return false;
+        }
+        return true;
+    }
+
+    bool validate_round_trip()
+    {
+        cout << "Validating validate_round_trip" << endl;
+        auto encoded = image.encode();
+        // header, 3 entries, 2 region bases, 8 descriptors, 12 weights
+        if (encoded.size() != 4 * (16 + 3 * 4 + 2 + 8 * 12 + 12))
+        {
+            cout << "encoded " << encoded.size() << " bytes FAILED!" << endl;
+            return false;
+        }
+        if (!matches(ProgramImageView(encoded.data(), encoded.size())))
+        {
+            return false;
+        }
+        cout << "validate_round_trip SUCCESS" << endl;
+        return true;
+    }
+
+    bool validate_mapped()
+    {
+        cout << "Validating validate_mapped" << endl;
+        string path = "program_image_tb.img";
+        image.save(path);
+        bool valid;
+        {
+            MappedProgramImage mapped(path);
+            valid = matches(mapped.view());
+        }
+        std::remove(path.c_str());
+        if (!valid)
+        {
+            return false;
+        }
+        cout << "validate_mapped SUCCESS" << endl;
+        return true;
+    }
+
+    static bool rejects(const vector<uint8_t>& encoded)
+    {
+        try
+        {
+            ProgramImageView(encoded.data(), encoded.size());
+        }
+        catch (std::runtime_error& e)
+        {
+            return true;
+        }
+        return false;
+    }
+
+    bool validate_corrupt()
+    {
+        cout << "Validating validate_corrupt" << endl;
+        auto encoded = image.encode();
+        auto truncated = encoded;
+        truncated.pop_back();
+        auto future = encoded;
+        future[4] = PROGRAM_IMAGE_VERSION + 1;
+        // first program claims descriptors past the end
+        auto overrun = encoded;
+        overrun[4 * (16 + 3)] = 200;
+        if (!rejects(truncated) || !rejects(future) || !rejects(overrun))
+        {
+            cout << "corrupt image accepted FAILED!" << endl;
+            return false;
+        }
+        // a next index outside its program is caught when it's decoded
+        auto jump = encoded;
+        jump[4 * (16 + 3 * 4 + 2)] = 7;
+        ProgramImageView view(jump.data(), jump.size());
+        try
+        {
+            view.program(0);
+            cout << "out of program next accepted FAILED!" << endl;
+            return false;
+        }
+        catch (std::runtime_error& e)
+        {
+        }
+        cout << "validate_corrupt SUCCESS" << endl;
+        return true;
+    }
+
+    int run_tb()
+    {
+        if (!validate_round_trip())
+        {
+            cout << "validate_round_trip() FAILED!" << endl;
+            return -1;
+        }
+        if (!validate_mapped())
+        {
+            cout << "validate_mapped() FAILED!" << endl;
+            return -1;
+        }
+        if (!validate_corrupt())
+        {
+            cout << "validate_corrupt() FAILED!" << endl;
+            return -1;
+        }
+        cout << "ALL TESTS PASS" << endl;
+        return 0;
+    }
+};
+
+int sc_main(int argc, char* argv[])
+{
+    ProgramImage_TB tb;
+    return tb.run_tb();
+}
@@ -0,0 +1,103 @@
+#include "ReuseAnalysis.hh"
+#include <systemc>
+
+// #define DEBUG
+using std::cout;
+using std::endl;
+
+struct ReuseAnalysis_TB
+{
+    bool validate_expand()
+    {
+        cout << "Validating validate_expand" << endl;
+        vector<Descriptor_2D> program = {Descriptor_2D::delay_inst(4), Descriptor_2D::stream_inst(2, 3, 1), Descriptor_2D::ring_stream_inst(11, 7, 8, 6), Descriptor_2D::suspend_inst()};
+        Descriptor_2D::make_sequential(program);
+        vector<unsigned int> expected = {2, 3, 4, 5, 2, 3, 4, 5, 11, 12, 13, 8, 9, 10, 11, 12};
+        if (expand_program(program) != expected)
+        {
+            cout << "expand_program FAILED!" << endl;
+            return false;
+        }
+        // a program looping on itself is cut off
+        program = {Descriptor_2D::stream_inst(0, 1, 0)};
+        if (expand_program(program, 5).size() != 5)
+        {
+            cout << "looping program not cut off FAILED!" << endl;
+            return false;
+        }
+        vector<unsigned int> interleaved = {1, 7, 2, 3};
+        if (interleave_streams({{1, 2, 3}, {7}}) != interleaved)
+        {
+            cout << "interleave_streams FAILED!" << endl;
+            return false;
+        }
+        cout << "validate_expand SUCCESS" << endl;
+        return true;
+    }
+
+    bool validate_reuse_distance()
+    {
+        cout << "Validating validate_reuse_distance" << endl;
+        // cyclic sweep, every reuse sees the two other addresses
+        ReuseProfile sweep({0, 1, 2, 0, 1, 2}, 2);
+        if (sweep.accesses != 6 || sweep.footprint != 3 || sweep.reuse.size() != 1 || sweep.reuse.at(2) != 3)
+        {
+            cout << "sweep distances FAILED!" << endl;
+            return false;
+        }
+        if (sweep.hit_rate(2) != 0.0 || sweep.hit_rate(3) != 0.5 || sweep.max_hit_rate() != 0.5)
+        {
+            cout << "sweep hit rates FAILED!" << endl;
+            return false;
+        }
+        if (sweep.min_buffer_size(0.5) != 3 || sweep.min_buffer_size(0.6) != -1 || sweep.min_buffer_size(0.0) != 0)
+        {
+            cout << "sweep min_buffer_size FAILED!" << endl;
+            return false;
+        }
+        vector<unsigned long int> working_set = {2, 2, 2};
+        if (sweep.working_set != working_set || sweep.peak_working_set() != 2)
+        {
+            cout << "sweep working set FAILED!" << endl;
+            return false;
+        }
+
+        // immediate reuse has distance 0, distances repeat addresses only once
+        ReuseProfile local({0, 0, 1, 1, 0}, 5);
+        vector<unsigned long int> histogram = {2, 1};
+        if (local.reuse.at(0) != 2 || local.reuse.at(1) != 1 || local.log2_histogram() != histogram)
+        {
+            cout << "local distances FAILED!" << endl;
+            return false;
+        }
+        if (local.min_buffer_size(0.4) != 1 || local.min_buffer_size(0.6) != 2 || local.peak_working_set() != 2)
+        {
+            cout << "local min_buffer_size FAILED!" << endl;
+            return false;
+        }
+        cout << "validate_reuse_distance SUCCESS" << endl;
+        return true;
+    }
+
+    int run_tb()
+    {
+        if (!validate_expand())
+        {
+            cout << "validate_expand() FAILED!" << endl;
+            return -1;
+        }
+        if (!validate_reuse_distance())
+        {
+            cout << "validate_reuse_distance() FAILED!" << endl;
+            return -1;
+        }
+        cout << "ALL TESTS PASS" << endl;
+        return 0;
+    }
+};
+
+int sc_main(int argc, char* argv[])
+{
+    ReuseAnalysis_TB tb;
+    return tb.run_tb();
+}
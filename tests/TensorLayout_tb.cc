@@ -0,0 +1,117 @@
+#include "TensorLayout.hh"
+#include <systemc>
+#include <stdexcept>
+#include <vector>
+
+// #define DEBUG
+using std::cout;
+using std::endl;
+using std::vector;
+
+struct TensorLayout_TB
+{
+    const int channels = 5;
+    const int plane = 6;
+
+    // every element lands on its own word inside size()
+    bool validate_bijective(const TensorLayout& layout)
+    {
+        cout << "Validating validate_bijective " << layout.to_string() << endl;
+        vector<int> hits(layout.size(channels, plane), 0);
+        for (int c = 0; c < channels; c++)
+        {
+            for (int element = 0; element < plane; element++)
+            {
+                int addr = layout.index(c, element, channels, plane);
+                if (addr < 0 || addr >= (int)hits.size() || hits[addr]++)
+                {
+                    cout << "index(" << c << ", " << element << ") = " << addr << " FAILED!" << endl;
+                    return false;
+                }
+            }
+        }
+        cout << "validate_bijective SUCCESS" << endl;
+        return true;
+    }
+
+    bool validate_addresses()
+    {
+        cout << "Validating validate_addresses" << endl;
+        TensorLayout nchw = TensorLayout::from_string("nchw");
+        TensorLayout nhwc = TensorLayout::from_string("nhwc");
+        TensorLayout nchw4c = TensorLayout::from_string("nchw4c");
+        // channel 2, element 3
+        if (nchw.index(2, 3, channels, plane) != 2 * plane + 3 ||
+            nhwc.index(2, 3, channels, plane) != 3 * channels + 2 ||
+            nchw4c.index(2, 3, channels, plane) != 3 * 4 + 2)
+        {
+            cout << "channel 2 element 3 FAILED!" << endl;
+            return false;
+        }
+        // channel 4 opens the second block
+        if (nchw4c.index(4, 1, channels, plane) != plane * 4 + 4 || nchw4c.size(channels, plane) != 8 * plane)
+        {
+            cout << "second block FAILED!" << endl;
+            return false;
+        }
+        cout << "validate_addresses SUCCESS" << endl;
+        return true;
+    }
+
+    bool validate_from_string()
+    {
+        cout << "Validating validate_from_string" << endl;
+        for (auto name : {"nchw", "nhwc", "nchw16c"})
+        {
+            if (TensorLayout::from_string(name).to_string() != name)
+            {
+                cout << name << " round trip FAILED!" << endl;
+                return false;
+            }
+        }
+        for (auto name : {"chwn", "nchwc", "nchw0c", "nchw4"})
+        {
+            try
+            {
+                TensorLayout::from_string(name);
+                cout << name << " accepted FAILED!" << endl;
+                return false;
+            }
+            catch (const std::invalid_argument&)
+            {
+            }
+        }
+        cout << "validate_from_string SUCCESS" << endl;
+        return true;
+    }
+
+    int run_tb()
+    {
+        for (auto name : {"nchw", "nhwc", "nchw2c", "nchw4c"})
+        {
+            if (!validate_bijective(TensorLayout::from_string(name)))
+            {
+                cout << "validate_bijective(" << name << ") FAILED!" << endl;
+                return -1;
+            }
+        }
+        if (!validate_addresses())
+        {
+            cout << "validate_addresses() FAILED!" << endl;
+            return -1;
+        }
+        if (!validate_from_string())
+        {
+            cout << "validate_from_string() FAILED!" << endl;
+            return -1;
+        }
+        cout << "ALL TESTS PASS" << endl;
+        return 0;
+    }
+};
+
+int sc_main(int argc, char* argv[])
+{
+    TensorLayout_TB tb;
+    return tb.run_tb();
+}
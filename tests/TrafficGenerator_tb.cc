@@ -0,0 +1,196 @@
+#include <systemc.h>
+#include <stdexcept>
+#include "TrafficGenerator.hh"
+#include "memory.h"
+
+// #define DEBUG
+using std::cout;
+using std::endl;
+
+struct TrafficGenerator_TB : public sc_module
+{
+    const sc_time cycle = sc_time(1, SC_NS);
+    const sc_time mem_latency = sc_time(10, SC_NS);
+
+    TrafficConfig back_to_back_config;
+    TrafficConfig paced_config;
+
+    memory mem_0;
+    memory mem_1;
+    TrafficGenerator<32> back_to_back;
+    TrafficGenerator<32> paced;
+
+    static TrafficConfig make_config(unsigned int max_outstanding, sc_time interval)
+    {
+        TrafficConfig config;
+        config.pattern = TrafficPattern::RANDOM;
+        config.range = 1024;
+        config.size = 16;
+        config.read_fraction = 0.5;
+        config.max_outstanding = max_outstanding;
+        config.interval = interval;
+        config.transactions = 10;
+        return config;
+    }
+
+    TrafficGenerator_TB(sc_module_name name) : sc_module(name),
+                                               back_to_back_config(make_config(2, SC_ZERO_TIME)),
+                                               paced_config(make_config(4, sc_time(20, SC_NS))),
+                                               mem_0("mem_0", mem_latency, 1024),
+                                               mem_1("mem_1", mem_latency, 1024),
+                                               back_to_back("back_to_back", back_to_back_config, cycle),
+                                               paced("paced", paced_config, cycle)
+    {
+        back_to_back.socket.bind(mem_0.socket);
+        paced.socket.bind(mem_1.socket);
+        // the paced run starts after the back to back one
+        paced.after = &back_to_back.done;
+        cout << "Instantiated TrafficGenerator TB with name " << this->name() << endl;
+    }
+
+    bool validate_sequence()
+    {
+        cout << "Validating validate_sequence" << endl;
+        TrafficConfig config;
+        config.base = 100;
+        config.range = 256;
+        config.size = 64;
+        TrafficSequence sequential(config);
+        vector<sc_dt::uint64> expected = {100, 164, 228, 292, 100};
+        for (auto addr : expected)
+        {
+            auto request = sequential.next();
+            if (request.addr != addr || request.cmd != tlm::TLM_WRITE_COMMAND)
+            {
+                cout << "sequential " << request.addr << " != " << addr << " FAILED!" << endl;
+                return false;
+            }
+        }
+
+        config.pattern = TrafficPattern::STRIDED;
+        config.stride = 128;
+        config.read_fraction = 1.0;
+        TrafficSequence strided(config);
+        expected = {100, 228, 100};
+        for (auto addr : expected)
+        {
+            auto request = strided.next();
+            if (request.addr != addr || request.cmd != tlm::TLM_READ_COMMAND)
+            {
+                cout << "strided " << request.addr << " != " << addr << " FAILED!" << endl;
+                return false;
+            }
+        }
+
+        config.pattern = TrafficPattern::RANDOM;
+        TrafficSequence random(config), same_seed(config);
+        for (int i = 0; i < 100; i++)
+        {
+            auto request = random.next();
+            if (request.addr < 100 || request.addr > 292 || (request.addr - 100) % 64 || request.addr != same_seed.next().addr)
+            {
+                cout << "random " << request.addr << " FAILED!" << endl;
+                return false;
+            }
+        }
+
+        config.pattern = TrafficPattern::STRIDED;
+        config.stride = 96;
+        try
+        {
+            TrafficSequence misaligned(config);
+            cout << "misaligned stride accepted FAILED!" << endl;
+            return false;
+        }
+        catch (std::invalid_argument &e)
+        {
+        }
+        cout << "validate_sequence SUCCESS" << endl;
+        return true;
+    }
+
+    bool validate_stats()
+    {
+        cout << "Validating validate_stats" << endl;
+        TrafficStats stats(10);
+        stats.first_issue = 5;
+        // latencies 1, 2, 3, 4 and 12, the last one in the second window
+        for (unsigned long int latency : {1, 2, 3, 4})
+        {
+            stats.record(5, 5 + latency, 8, latency % 2, true);
+        }
+        stats.record(10, 22, 8, false, true);
+        stats.record(10, 11, 8, false, false);
+        if (stats.transactions() != 5 || stats.errors != 1 || stats.reads != 2 || stats.bytes != 40)
+        {
+            cout << "counts FAILED!" << endl;
+            return false;
+        }
+        if (stats.latency_percentile(0.5) != 3 || stats.latency_percentile(1.0) != 12 || stats.mean_latency() != 22.0 / 5)
+        {
+            cout << "p50 " << stats.latency_percentile(0.5) << " mean " << stats.mean_latency() << " FAILED!" << endl;
+            return false;
+        }
+        if (stats.log2_histogram() != vector<unsigned long int>({0, 1, 2, 1, 1}))
+        {
+            cout << "log2_histogram FAILED!" << endl;
+            return false;
+        }
+        if (stats.window_bytes != vector<unsigned long int>({32, 8}) || stats.bytes_per_cycle() != 40.0 / 17)
+        {
+            cout << "throughput FAILED!" << endl;
+            return false;
+        }
+        cout << "validate_stats SUCCESS" << endl;
+        return true;
+    }
+
+    bool validate_generators()
+    {
+        cout << "Validating validate_generators" << endl;
+        sc_start();
+        // two in flight against a 10 cycle memory
+        auto &fast = back_to_back.stats;
+        if (fast.transactions() != 10 || fast.errors != 0 || fast.latency_percentile(1.0) != 10 || fast.last_done - fast.first_issue != 50)
+        {
+            cout << "back to back done after " << fast.last_done - fast.first_issue << " cycles FAILED!" << endl;
+            return false;
+        }
+        // the rate, not the outstanding limit, bounds the paced run
+        auto &slow = paced.stats;
+        if (slow.transactions() != 10 || slow.first_issue != fast.last_done || slow.mean_latency() != 10.0 || slow.last_done - slow.first_issue != 9 * 20 + 10)
+        {
+            cout << "paced done after " << slow.last_done - slow.first_issue << " cycles FAILED!" << endl;
+            return false;
+        }
+        cout << "validate_generators SUCCESS" << endl;
+        return true;
+    }
+
+    int run_tb()
+    {
+        if (!validate_sequence())
+        {
+            cout << "validate_sequence() FAILED!" << endl;
+            return -1;
+        }
+        if (!validate_stats())
+        {
+            cout << "validate_stats() FAILED!" << endl;
+            return -1;
+        }
+        if (!validate_generators())
+        {
+            cout << "validate_generators() FAILED!" << endl;
+            return -1;
+        }
+        cout << "ALL TESTS PASS" << endl;
+        return 0;
+    }
+};
+
+int sc_main(int argc, char *argv[])
+{
+    TrafficGenerator_TB tb("TrafficGenerator_tb");
+    return tb.run_tb();
+}
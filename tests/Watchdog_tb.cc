@@ -0,0 +1,123 @@
+#include "Watchdog.hh"
+#include <iostream>
+#include <systemc>
+
+// #define DEBUG
+using std::cout;
+using std::endl;
+
+struct Watchdog_TB
+{
+    bool validate_budget()
+    {
+        cout << "Validating validate_budget" << endl;
+        ProgressWatchdog watchdog;
+        watchdog.cycle_budget = 10;
+        // a program cycling through states never stalls, only the budget stops it
+        for (uint64_t cycle = 0; cycle < 10; cycle++)
+        {
+            if (watchdog.observe(cycle % 3) != WatchdogVerdict::RUNNING)
+            {
+                cout << "tripped at cycle " << cycle << " FAILED!" << endl;
+                return false;
+            }
+        }
+        if (watchdog.observe(1) != WatchdogVerdict::OVER_BUDGET || !watchdog.tripped())
+        {
+            cout << "cycle 11 within a budget of 10 FAILED!" << endl;
+            return false;
+        }
+        if (cycle_budget_from_estimate(100, 1.5, 7) != 157)
+        {
+            cout << "cycle_budget_from_estimate(100, 1.5, 7) != 157 FAILED!" << endl;
+            return false;
+        }
+        cout << "validate_budget SUCCESS" << endl;
+        return true;
+    }
+
+    bool validate_stall()
+    {
+        cout << "Validating validate_stall" << endl;
+        ProgressWatchdog watchdog;
+        watchdog.stall_limit = 4;
+        // changes every cycle, then sits in one state
+        for (uint64_t cycle = 0; cycle < 20; cycle++)
+        {
+            watchdog.observe(cycle);
+        }
+        for (int cycle = 0; cycle < 4; cycle++)
+        {
+            if (watchdog.observe(99) != WatchdogVerdict::RUNNING)
+            {
+                cout << "stalled after " << cycle + 1 << " unchanged cycles FAILED!" << endl;
+                return false;
+            }
+        }
+        if (watchdog.observe(99) != WatchdogVerdict::STALLED || watchdog.last_change != 20)
+        {
+            cout << "5 unchanged cycles not a stall FAILED!" << endl;
+            return false;
+        }
+        // a tripped watchdog stays tripped until reset
+        if (watchdog.observe(100) != WatchdogVerdict::STALLED)
+        {
+            cout << "verdict cleared by progress FAILED!" << endl;
+            return false;
+        }
+        watchdog.reset();
+        if (watchdog.tripped() || watchdog.observe(99) != WatchdogVerdict::RUNNING)
+        {
+            cout << "reset FAILED!" << endl;
+            return false;
+        }
+        cout << "validate_stall SUCCESS" << endl;
+        return true;
+    }
+
+    bool validate_hasher()
+    {
+        cout << "Validating validate_hasher" << endl;
+        StateHasher a, b, c;
+        a.add(1);
+        a.add(2);
+        b.add(2);
+        b.add(1);
+        c.add(1);
+        c.add(2);
+        if (a.hash == b.hash || a.hash != c.hash)
+        {
+            cout << "hash order sensitivity FAILED!" << endl;
+            return false;
+        }
+        cout << "validate_hasher SUCCESS" << endl;
+        return true;
+    }
+
+    int run_tb()
+    {
+        if (!validate_budget())
+        {
+            cout << "validate_budget() FAILED!" << endl;
+            return -1;
+        }
+        if (!validate_stall())
+        {
+            cout << "validate_stall() FAILED!" << endl;
+            return -1;
+        }
+        if (!validate_hasher())
+        {
+            cout << "validate_hasher() FAILED!" << endl;
+            return -1;
+        }
+        cout << "ALL TESTS PASS" << endl;
+        return 0;
+    }
+};
+
+int sc_main(int argc, char* argv[])
+{
+    Watchdog_TB tb;
+    return tb.run_tb();
+}
@@ -0,0 +1,140 @@
+#include "WeightPacker.hh"
+#include <systemc>
+
+// #define DEBUG
+using std::cout;
+using std::endl;
+
+struct WeightPacker_TB
+{
+    // 5 filters with a 7 long reduction on a 3x4 array, tiles of 2x3 leave
+    // partial tiles on both edges and bypassed rows/columns in every tile
+    const int f_out = 5;
+    const int reduction = 7;
+    const int filter_count = 3;
+    const int channel_count = 4;
+    vector<int> weights;
+
+    WeightPacker_TB()
+    {
+        for (int i = 0; i < f_out * reduction; i++)
+        {
+            weights.push_back(i + 1);
+        }
+    }
+
+    // what PE (row, col) holds in tile step, straight from the tile definition
+    int reference(const Mapping &mapping, int step, int row, int col)
+    {
+        auto tile = mapping.tile_schedule((f_out + mapping.filter_tile - 1) / mapping.filter_tile, (reduction + mapping.channel_tile - 1) / mapping.channel_tile).at(step);
+        int filter = tile.first * mapping.filter_tile + row;
+        int column = tile.second * mapping.channel_tile + col;
+        if (row >= mapping.filter_tile || col >= mapping.channel_tile || filter >= f_out || column >= reduction)
+        {
+            return weight_packer::PAD;
+        }
+        return weights[filter * reduction + column];
+    }
+
+    bool validate_pack(WeightDelivery delivery, LoopOrder loop_order, int weight_channel_count)
+    {
+        cout << "Validating validate_pack" << endl;
+        Mapping mapping(UnrollOrientation::HORIZONTAL, loop_order, 2, 3);
+        auto packed = pack_weights(weights.data(), f_out, reduction, mapping, filter_count, channel_count, delivery, weight_channel_count);
+        int lines = (delivery == WeightDelivery::ROW) ? filter_count : channel_count;
+        if (packed.tile_count != 3 * 3 || packed.words != packed.tile_count * lines || packed.data.size() != (unsigned int)(packed.words * packed.lanes))
+        {
+            cout << "packed dims FAILED!" << endl;
+            return false;
+        }
+        for (int step = 0; step < packed.tile_count; step++)
+        {
+            for (int line = 0; line < lines; line++)
+            {
+                int channel = line % weight_channel_count;
+                int addr = packed.region_base[channel] + step * weight_channel_lines(lines, weight_channel_count, channel) + line / weight_channel_count;
+                for (int lane = 0; lane < packed.lanes; lane++)
+                {
+                    int row = (delivery == WeightDelivery::ROW) ? line : lane;
+                    int col = (delivery == WeightDelivery::ROW) ? lane : line;
+                    if (packed.word(addr)[lane] != reference(mapping, step, row, col))
+                    {
+                        cout << "step " << step << " pe(" << row << ", " << col << ") != " << reference(mapping, step, row, col) << " FAILED!" << endl;
+                        return false;
+                    }
+                }
+            }
+        }
+        cout << "validate_pack SUCCESS" << endl;
+        return true;
+    }
+
+    // a PE row/column is active exactly where the tile definition puts a weight
+    bool validate_tiles()
+    {
+        cout << "Validating validate_tiles" << endl;
+        Mapping mapping(UnrollOrientation::HORIZONTAL, LoopOrder::FILTER_TILES_OUTER, 2, 3);
+        WeightTiles tiles(f_out, reduction, mapping);
+        if (tiles.verticle_tile_count != 3 || tiles.horizontal_tile_count != 3 || tiles.tile_count() != 9)
+        {
+            cout << "tile counts FAILED!" << endl;
+            return false;
+        }
+        auto schedule = mapping.tile_schedule(tiles.verticle_tile_count, tiles.horizontal_tile_count);
+        for (int step = 0; step < tiles.tile_count(); step++)
+        {
+            for (int row = 0; row < filter_count; row++)
+            {
+                for (int col = 0; col < channel_count; col++)
+                {
+                    bool active = tiles.filter_active(schedule[step].first, row) && tiles.column_active(schedule[step].second, col);
+                    if (active != (reference(mapping, step, row, col) != weight_packer::PAD))
+                    {
+                        cout << "step " << step << " pe(" << row << ", " << col << ") activity FAILED!" << endl;
+                        return false;
+                    }
+                }
+            }
+        }
+        cout << "validate_tiles SUCCESS" << endl;
+        return true;
+    }
+
+    int run_tb()
+    {
+        if (!validate_tiles())
+        {
+            cout << "validate_tiles FAILED!" << endl;
+            return -1;
+        }
+        if (!validate_pack(WeightDelivery::ROW, LoopOrder::FILTER_TILES_OUTER, filter_count))
+        {
+            cout << "validate_pack(ROW) FAILED!" << endl;
+            return -1;
+        }
+        if (!validate_pack(WeightDelivery::COLUMN, LoopOrder::FILTER_TILES_OUTER, channel_count))
+        {
+            cout << "validate_pack(COLUMN) FAILED!" << endl;
+            return -1;
+        }
+        // shared channels interleave rows/columns within their regions
+        if (!validate_pack(WeightDelivery::ROW, LoopOrder::CHANNEL_TILES_OUTER, 2))
+        {
+            cout << "validate_pack(ROW, 2 channels) FAILED!" << endl;
+            return -1;
+        }
+        if (!validate_pack(WeightDelivery::COLUMN, LoopOrder::CHANNEL_TILES_OUTER, 3))
+        {
+            cout << "validate_pack(COLUMN, 3 channels) FAILED!" << endl;
+            return -1;
+        }
+        cout << "ALL TESTS PASS" << endl;
+        return 0;
+    }
+};
+
+int sc_main(int argc, char* argv[])
+{
+    WeightPacker_TB tb;
+    return tb.run_tb();
+}
@@ -0,0 +1,140 @@
+#include "ZeroCompression.hh"
+#include "Memory.hh"
+#include <systemc>
+
+// #define DEBUG
+using std::cout;
+using std::endl;
+
+struct ZeroCompression_TB
+{
+    // a post relu plane: 40 elements, 12 nonzero, a 300 long zero run at the end
+    vector<int> sparse_plane()
+    {
+        vector<int> plane(340, 0);
+        for (int element = 0; element < 40; element += 4)
+        {
+            plane[element] = element + 1;
+        }
+        plane[37] = 7;
+        plane[39] = 9;
+        return plane;
+    }
+
+    bool validate_round_trip()
+    {
+        cout << "Validating validate_round_trip" << endl;
+        auto plane = sparse_plane();
+        // a long interior run needs an explicit zero in rle
+        plane[339] = 5;
+        for (auto format : {CompressionFormat::NONE, CompressionFormat::BITMASK, CompressionFormat::RLE})
+        {
+            auto compressed = compress_plane(plane.data(), plane.size(), format);
+            if (decompress_plane(compressed, format) != plane)
+            {
+                cout << compression_format_to_string(format) << " round trip FAILED!" << endl;
+                return false;
+            }
+        }
+        cout << "validate_round_trip SUCCESS" << endl;
+        return true;
+    }
+
+    bool validate_footprint()
+    {
+        cout << "Validating validate_footprint" << endl;
+        auto plane = sparse_plane();
+        auto bitmask = compress_plane(plane.data(), plane.size(), CompressionFormat::BITMASK);
+        auto rle = compress_plane(plane.data(), plane.size(), CompressionFormat::RLE);
+        // 12 values, 340 / 32 rounded up mask words
+        if (bitmask.values.size() != 12 || bitmask.words() != 12 + 11)
+        {
+            cout << "bitmask words != 23 FAILED!" << endl;
+            return false;
+        }
+        // 12 pairs, trailing zeros are free
+        if (rle.values.size() != 12 || rle.words() != 12 + 3)
+        {
+            cout << "rle words != 15 FAILED!" << endl;
+            return false;
+        }
+        auto dense = compress_plane(plane.data(), plane.size(), CompressionFormat::NONE);
+        if (dense.words() != 340)
+        {
+            cout << "uncompressed words != 340 FAILED!" << endl;
+            return false;
+        }
+        cout << "validate_footprint SUCCESS" << endl;
+        return true;
+    }
+
+    bool validate_decompressor()
+    {
+        cout << "Validating validate_decompressor" << endl;
+        auto plane = sparse_plane();
+        auto compressed = compress_plane(plane.data(), plane.size(), CompressionFormat::RLE);
+        sc_vector<sc_vector<sc_signal<sc_int<32>>>> ram("ram", 2 * compressed.words(), MemoryRowCreator<sc_int<32>>(1, nullptr));
+        ZeroDecompressor<sc_int<32>> decompressor;
+        decompressor.clear(plane.size(), CompressionFormat::RLE);
+        for (int copy = 0; copy < 2; copy++)
+        {
+            int base = copy * compressed.words();
+            for (unsigned int word = 0; word < compressed.metadata.size(); word++)
+            {
+                ram[base + word][0].write(compressed.metadata[word]);
+            }
+            for (unsigned int word = 0; word < compressed.values.size(); word++)
+            {
+                ram[base + compressed.metadata.size() + word][0].write(compressed.values[word]);
+            }
+            decompressor.add_plane(compressed, base);
+        }
+        sc_start(1, SC_NS);
+
+        // stream the second plane on channel 1
+        int access_counter = 0;
+        for (unsigned int element = 0; element < plane.size(); element++)
+        {
+            int value = decompressor.read(1, plane.size() + element, ram, access_counter);
+            if (value != plane[element])
+            {
+                cout << "element " << element << " != " << plane[element] << " FAILED!" << endl;
+                return false;
+            }
+        }
+        if (access_counter != compressed.words())
+        {
+            cout << "access_counter " << access_counter << " != " << compressed.words() << " FAILED!" << endl;
+            return false;
+        }
+        cout << "validate_decompressor SUCCESS" << endl;
+        return true;
+    }
+
+    int run_tb()
+    {
+        if (!validate_round_trip())
+        {
+            cout << "validate_round_trip() FAILED!" << endl;
+            return -1;
+        }
+        if (!validate_footprint())
+        {
+            cout << "validate_footprint() FAILED!" << endl;
+            return -1;
+        }
+        if (!validate_decompressor())
+        {
+            cout << "validate_decompressor() FAILED!" << endl;
+            return -1;
+        }
+        cout << "ALL TESTS PASS" << endl;
+        return 0;
+    }
+};
+
+int sc_main(int argc, char* argv[])
+{
+    ZeroCompression_TB tb;
+    return tb.run_tb();
+}
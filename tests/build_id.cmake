@@ -0,0 +1,23 @@
+# Writes the git describe of SOURCE_DIR to OUTPUT as BUILD_ID, touching it
+# only when the value changes so an unchanged build does not recompile.
+#   cmake -DSOURCE_DIR=<repo> -DOUTPUT=<header> -P build_id.cmake
+
+execute_process(
+    COMMAND git describe --always --dirty
+    WORKING_DIRECTORY "${SOURCE_DIR}"
+    OUTPUT_VARIABLE BUILD_ID
+    OUTPUT_STRIP_TRAILING_WHITESPACE
+    ERROR_QUIET
+)
+if(NOT BUILD_ID)
+    set(BUILD_ID "unknown")
+endif()
+
+set(content "#define BUILD_ID \"${BUILD_ID}\"\n")
+set(previous "")
+if(EXISTS "${OUTPUT}")
+    file(READ "${OUTPUT}" previous)
+endif()
+if(NOT previous STREQUAL content)
+    file(WRITE "${OUTPUT}" "${content}")
+endif()
@@ -1,767 +1,506 @@
 #ifndef __ESTIMATION_ENVIORNMENT_CC
 #define __ESTIMATION_ENVIORNMENT_CC
 
-#include "GlobalControl.hh"
-#include <assert.h>
-#include <iostream>
-#include <string>
+#include "Arch.hh"
+#include "ForkServer.hh"
+#include "RunOptions.hh"
+#include "SimClusters.hh"
+#include "SimExtrapolated.hh"
+#include "SimFastForward.hh"
+#include "SimFused.hh"
+#include "SimLayer.hh"
+#include "SimPipeline.hh"
 #include <systemc.h>
-#include <sstream>
-#include "ProcEngine.hh"
-#include "SAM.hh"
-#include <chrono>
-#include <vector>
-#include <assert.h>
+#include <climits>
+#include <fstream>
 #include <iomanip>
-#include <cmath>
-#include <deque>
-#include <memory>
-#include <tuple>
-#include "AddressGenerator.hh"
-#include <xtensor/xarray.hpp>
-#include <xtensor/xio.hpp>
-#include <xtensor/xview.hpp>
-#include <xtensor/xaxis_iterator.hpp>
-#include <xtensor/xpad.hpp>
 #include <iostream>
+#include <memory>
 #include <string>
-#include <xtensor/xadapt.hpp>
-#include <xtensor-blas/xlinalg.hpp>
+#include <vector>
 #include <boost/program_options.hpp>
 
-#define PAD -1
+// written by the build from git describe so stored results can be traced to a build
+#if defined(HAVE_BUILD_ID)
+#include "build_id.h"
+#endif
+#if !defined(BUILD_ID)
+#define BUILD_ID "unknown"
+#endif
 
 using std::cout;
-using std::deque;
 using std::endl;
 using std::string;
-using std::tuple;
 using std::vector;
-using std::chrono::duration;
-using std::chrono::duration_cast;
-using std::chrono::high_resolution_clock;
-using std::chrono::milliseconds;
 
 namespace po = boost::program_options;
-template <typename DataType>
-struct SignalVectorCreator
-{
-    SignalVectorCreator(unsigned int _width, sc_trace_file *_tf) : tf(_tf), width(_width) {}
-
-    sc_vector<sc_signal<DataType>> *operator()(const char *name, size_t)
-    {
-        return new sc_vector<sc_signal<DataType>>(name, width);
-    }
-    sc_trace_file *tf;
-    unsigned int width;
-};
 
-template <typename DataType>
-struct PeCreator
+int run_configuration(int argc, char *argv[])
 {
-    PeCreator(sc_trace_file *_tf) : tf(_tf)
-    {
-    }
-    PE<DataType> *operator()(const char *name, size_t)
+    RunOptions options;
+    try
     {
-        return new PE<DataType>(name, this->tf);
-    }
-    sc_trace_file *tf;
-};
+        po::options_description config("Configuration");
+        config.add_options()("help", "produce help message")("ifmap_h", po::value<int>(), "set input feature map width")("ifmap_w", po::value<int>(), "set input feature map height")("k", po::value<int>(), "set kernel size")("c_in", po::value<int>(), "set ifmap channel count")("f_out", po::value<int>(), "set weight filter count")("filter_count", po::value<int>(), "set arch width")("channel_count", po::value<int>(), "set arch height")("bias", "fuse per filter bias add into psum writes")("relu", "fuse relu into psum writes")("clamp_min", po::value<int>(), "fuse clamp with lower bound into psum writes")("clamp_max", po::value<int>(), "fuse clamp with upper bound into psum writes")("pool", po::value<string>(), "fuse 2x2 pooling into psum writes: none, max or avg")("chain_f_out", po::value<vector<int>>()->multitoken(), "filter counts of 1x1 conv layers fused after the first, post processing applies to every layer (use --relu/--clamp_max to keep activations in range)")("ifmap_mem_size", po::value<int>(), "set ifmap SAM capacity for fused layers")("psum_mem_size", po::value<int>(), "set psum SAM capacity for fused layers")("clusters", po::value<int>(), "set number of arch clusters sharing DRAM")("partition", po::value<string>(), "split work across clusters by: filters or rows")("dram_words_per_cycle", po::value<int>(), "set shared DRAM bandwidth")("dram_latency", po::value<int>(), "set shared DRAM access latency in cycles")("pipeline_images", po::value<int>(), "map each --chain_f_out layer onto its own cluster and pipeline this many images through them")("orientation", po::value<string>(), "spatial unroll: horizontal (filters on rows) or verticle (filters on columns)")("loop_order", po::value<string>(), "tile traversal: filters_outer or channels_outer")("filter_tile", po::value<int>(), "set filters per tile, defaults to the full array")("channel_tile", po::value<int>(), "set channel_in*k*k columns per tile, defaults to the full array")("search_mapping", "score every legal mapping and simulate the best one, capacities come from --ifmap_mem_size/--psum_mem_size")("weight_delivery", po::value<string>(), "weight SAM word layout: row (one array row per word) or column")("weight_channels", po::value<int>(), "set weight SAM channels, defaults to one per array row/column")("weight_regs", po::value<int>(), "set weight registers per PE, defaults to every weight of the layer")("ifmap_layout", po::value<string>(), "ifmap placement in ifmap mem: nchw, nhwc or nchw<block>c")("ofmap_layout", po::value<string>(), "psum/ofmap placement in psum mem: nchw, nhwc or nchw<block>c")("ifmap_line_rows", po::value<int>(), "stream the ifmap through a per column ring of this many rows refilled from DRAM instead of keeping it resident")("global_buffer", po::value<int>(), "share one buffer of this many words between the ifmap, psum and weight regions, split per layer")("global_buffer_channels", po::value<int>(), "set the global buffer's channel pool, defaults to the channels of separate SAMs")("compress", po::value<string>(), "store activations in ifmap mem and DRAM zero compressed: none, bitmask or rle")("memory_levels", po::value<string>(), "stage the ifmap through SAM levels above ifmap mem, comma separated length:width:latency outermost first, widths must divide the level above")("reuse_hit_rate", po::value<double>(), "profile reuse distances of every SAM's address stream and report the smallest LRU buffer reaching this hit rate")("reuse_window", po::value<int>(), "set accesses per working set sample of the reuse profile")("record_traces", po::value<string>(), "write every ifmap, psum and weight SAM access to <prefix>_<sam>.trace for trace_replay")("extrapolate_rows", po::value<int>(), "simulate every tile shape in detail over this many, twice and three times as many ofmap rows and extrapolate the layer to its full rows with error bounds")("fast_forward", "simulate the first filter tiles in detail, skip the rest once the run repeats per filter tile")("max_cycles", po::value<unsigned long int>(), "stop a run that has not finished after this many cycles, defaults to the analytic estimate times --cycle_margin")("cycle_margin", po::value<double>(), "set the default cycle budget relative to the analytic estimate, 0 for none")("stall_cycles", po::value<unsigned long int>(), "stop a run once no generator or PE changed state for this many cycles, 0 for never")("save_program", po::value<string>(), "write the layer's generator and PE programs and packed weights to this program image")("load_program", po::value<string>(), "load the layer's programs and weights from this program image instead of generating them")("config_path", po::value<string>(), "how the host configures the array: direct (free), registers (one register write a word) or dma (bursts)");
 
-template <typename DataType>
-struct Arch : public sc_module
-{
-    // Member Signals
-private:
-    sc_in_clk _clk;
-
-public:
-    sc_port<GlobalControlChannel_IF> control;
-    sc_vector<PE<DataType>> pe_array;
-    // sc_vector<sc_signal<DataType>> filter_psum_out{"filter_psum_out", filter_count};
-    sc_trace_file *tf;
-    SAM<DataType> psum_mem;
-    sc_vector<sc_vector<sc_signal<DataType>>> psum_mem_read;
-
-    sc_vector<sc_vector<sc_signal<DataType>>> psum_mem_write;
-    SAM<DataType> ifmap_mem;
-    sc_vector<sc_vector<sc_signal<DataType>>> ifmap_mem_read;
-    sc_vector<sc_vector<sc_signal<DataType>>> ifmap_mem_write;
-
-    unsigned int dram_access_counter{0};
-    int filter_count;
-    int channel_count;
-    int psum_mem_size;
-    int ifmap_mem_size;
-
-    void suspend_monitor()
-    {
-        while (1)
+        po::variables_map vm;
+        po::store(po::parse_command_line(argc, argv, config), vm);
+        po::notify(vm);
+
+        if (vm.count("help"))
         {
-            while (control->enable())
-            {
-                bool pes_suspended = true;
-                for (auto &pe : pe_array)
-                {
-                    pes_suspended &= (pe.program.at(pe.prog_idx).state == DescriptorState::SUSPENDED);
-                }
-                bool ifmap_generators_suspended = true;
-                for (auto &gen : ifmap_mem.generators)
-                {
-                    ifmap_generators_suspended &= (gen.currentDescriptor().state == DescriptorState::SUSPENDED);
-                }
-                bool psum_generators_suspended = true;
-                for (auto &gen : psum_mem.generators)
-                {
-                    psum_generators_suspended &= (gen.currentDescriptor().state == DescriptorState::SUSPENDED);
-                }
-                if (pes_suspended && ifmap_generators_suspended && psum_generators_suspended)
-                {
-                    sc_stop();
-                }
-                wait();
-            }
-            wait();
+            cout << config << "\n";
+            return 0;
         }
-    }
 
-    void update_1x1()
-    {
-        while (1)
+        options.ifmap_h = (vm.count("ifmap_h")) ? vm["ifmap_h"].as<int>() : options.ifmap_h;
+        options.ifmap_w = (vm.count("ifmap_w")) ? vm["ifmap_w"].as<int>() : options.ifmap_w;
+        options.k = (vm.count("k")) ? vm["k"].as<int>() : options.k;
+        options.c_in = (vm.count("c_in")) ? vm["c_in"].as<int>() : options.c_in;
+        options.f_out = (vm.count("f_out")) ? vm["f_out"].as<int>() : options.f_out;
+        options.filter_count = (vm.count("filter_count")) ? vm["filter_count"].as<int>() : options.filter_count;
+        options.channel_count = (vm.count("channel_count")) ? vm["channel_count"].as<int>() : options.channel_count;
+
+        options.post_process_config.bias = vm.count("bias");
+        options.post_process_config.relu = vm.count("relu");
+        options.post_process_config.clamp = vm.count("clamp_min") || vm.count("clamp_max");
+        options.post_process_config.clamp_min = (vm.count("clamp_min")) ? vm["clamp_min"].as<int>() : INT_MIN;
+        options.post_process_config.clamp_max = (vm.count("clamp_max")) ? vm["clamp_max"].as<int>() : INT_MAX;
+        options.post_process_config.pool = (vm.count("pool")) ? PostProcessConfig::pool_mode_from_string(vm["pool"].as<string>()) : PoolMode::NONE;
+
+        if (options.ifmap_h <= 0 || options.ifmap_w <= 0 || options.k <= 0 || options.c_in <= 0 || options.f_out <= 0 || options.filter_count <= 0 || options.channel_count <= 0)
         {
-            while (control->enable())
-            {
-                for (int filter_row = 0; filter_row < filter_count; filter_row++)
-                {
-                    PE<DataType> &first_pe_in_row = this->pe_array[filter_row * channel_count];
-                    first_pe_in_row.psum_in = psum_mem_read.at(filter_row + filter_count).at(0).read();
-                }
-                for (int filter_row = 0; filter_row < filter_count; filter_row++)
-                {
-                    for (int channel_column = 0; channel_column < channel_count - 1; channel_column++)
-                    {
-
-                        PE<DataType> &cur_pe = this->pe_array[filter_row * channel_count + channel_column];
-                        PE<DataType> &next_pe = this->pe_array[filter_row * channel_count + channel_column + 1];
-                        if (cur_pe.current_weight.read() != -1)
-                        {
-                            cur_pe.active_counter++;
-                            next_pe.psum_in = cur_pe.compute(ifmap_mem_read[channel_column][0].read());
-                        }
-                        else
-                        {
-                            // bypass
-                            cur_pe.inactive_counter++;
-                            next_pe.psum_in = cur_pe.psum_in.read();
-                        }
-                        cur_pe.updateState();
-                    }
-                    PE<DataType> &last_pe = this->pe_array[filter_row * channel_count + channel_count - 1];
-
-                    if (last_pe.current_weight.read() != -1)
-                    {
-                        last_pe.active_counter++;
-                        psum_mem_write[filter_row][0] = last_pe.compute(ifmap_mem_read[channel_count - 1][0].read());
-                    }
-                    else
-                    {
-                        last_pe.inactive_counter++;
-                        psum_mem_write[filter_row][0] = last_pe.psum_in.read();
-                    }
-                    last_pe.updateState();
-                }
-                // for(int i =0 ; i < 7; i++)
-                // {
-                //     for(int j = 0; j<9; j++)
-                //     {
-                //         cout << this->pe_array[i*9 + j].current_weight.read() << " ";
-                //     }
-                //     cout << endl;
-                // }
-                wait();
-            }
-            wait();
+            throw std::invalid_argument("all passed arguments must be positive");
         }
-    }
-
-    // Constructor
-    Arch(
-        sc_module_name name,
-        GlobalControlChannel &_control,
-        int filter_count,
-        int channel_count,
-        int psum_mem_size,
-        int ifmap_mem_size,
-        sc_trace_file *_tf) : sc_module(name),
-                              pe_array("pe_array", filter_count * channel_count, PeCreator<DataType>(_tf)),
-                              tf(_tf),
-                              psum_mem("psum_mem", _control, filter_count * 2, psum_mem_size, 1, _tf),
-                              psum_mem_read("psum_mem_read", filter_count * 2, SignalVectorCreator<DataType>(1, tf)),
-                              psum_mem_write("psum_mem_write", filter_count * 2, SignalVectorCreator<DataType>(1, tf)),
-                              ifmap_mem("ifmap_mem", _control, channel_count, ifmap_mem_size, 1, _tf),
-                              ifmap_mem_read("ifmap_mem_read", channel_count, SignalVectorCreator<DataType>(1, tf)),
-                              ifmap_mem_write("ifmap_mem_write", channel_count, SignalVectorCreator<DataType>(1, tf))
-    {
-        control(_control);
-        _clk(control->clk());
-        this->filter_count = filter_count;
-        this->channel_count = channel_count;
-        this->psum_mem_size = psum_mem_size;
-        this->ifmap_mem_size = ifmap_mem_size;
 
-        // for(auto& psum: this->filter_psum_out)
-        // {
-        //     sc_trace(tf, psum, psum.name());
-        // }
-
-        // psum_read/write
-        for (int i = 0; i < filter_count * 2; i++)
+        if ((options.ifmap_h * options.ifmap_w) < 11)
         {
-            psum_mem.read_channel_data[i][0](psum_mem_read[i][0]);
-            psum_mem.write_channel_data[i][0](psum_mem_write[i][0]);
+            throw std::invalid_argument("total ifmap sizes below 11 currently unsupported");
         }
-        for (int i = 0; i < filter_count; i++)
+
+        if (options.k > 1)
         {
-            psum_mem.channels[i].set_mode(MemoryChannelMode::WRITE);
-            sc_trace(tf, psum_mem_write[i][0], (this->psum_mem_write[i][0].name()));
+            throw std::invalid_argument("kernel sizes greater than 1 currently unsupported");
         }
-        for (int i = filter_count; i < filter_count * 2; i++)
+
+        if (options.post_process_config.clamp && options.post_process_config.clamp_min > options.post_process_config.clamp_max)
         {
-            psum_mem.channels[i].set_mode(MemoryChannelMode::READ);
-            sc_trace(tf, psum_mem_read[i][0], (this->psum_mem_read[i][0].name()));
+            throw std::invalid_argument("clamp_min must not exceed clamp_max");
         }
 
-        for (int i = 0; i < channel_count; i++)
+        if (options.post_process_config.pool != PoolMode::NONE && (options.ifmap_h - options.k + 1 < 2 || options.ifmap_w - options.k + 1 < 2))
         {
-            ifmap_mem.channels[i].set_mode(MemoryChannelMode::READ);
-            ifmap_mem.read_channel_data[i][0](ifmap_mem_read[i][0]);
-            ifmap_mem.write_channel_data[i][0](ifmap_mem_write[i][0]);
-            sc_trace(tf, ifmap_mem_read[i][0], (this->ifmap_mem_read[i][0].name()));
+            throw std::invalid_argument("pooling requires an ofmap of at least 2x2");
         }
 
-        SC_THREAD(update_1x1);
-        sensitive << _clk.pos();
-        sensitive << control->reset();
+        options.cluster_count = (vm.count("clusters")) ? vm["clusters"].as<int>() : options.cluster_count;
+        options.partition = (vm.count("partition")) ? cluster_partition_from_string(vm["partition"].as<string>()) : options.partition;
+        options.dram_words_per_cycle = (vm.count("dram_words_per_cycle")) ? vm["dram_words_per_cycle"].as<int>() : options.dram_words_per_cycle;
+        options.dram_latency = (vm.count("dram_latency")) ? vm["dram_latency"].as<int>() : options.dram_latency;
 
-        SC_THREAD(suspend_monitor);
-        sensitive << _clk.pos();
-        sensitive << control->reset();
-        cout << "Arch MODULE: " << name << " has been instantiated " << endl;
-    }
-
-    SC_HAS_PROCESS(Arch);
-};
+        if (options.cluster_count <= 0 || options.cluster_count > MAX_CLUSTERS || options.dram_words_per_cycle <= 0 || options.dram_latency < 0)
+        {
+            throw std::invalid_argument("clusters must be within 1 and " + std::to_string(MAX_CLUSTERS) + ", DRAM bandwidth positive");
+        }
 
-template <typename DataType>
-void set_channel_modes(Arch<DataType> &arch)
-{
+        options.mapping.orientation = (vm.count("orientation")) ? Mapping::orientation_from_string(vm["orientation"].as<string>()) : options.mapping.orientation;
+        options.mapping.loop_order = (vm.count("loop_order")) ? Mapping::loop_order_from_string(vm["loop_order"].as<string>()) : options.mapping.loop_order;
+        ArrayShape array{options.filter_count, options.channel_count, 0, 0};
+        options.mapping.filter_tile = (vm.count("filter_tile")) ? vm["filter_tile"].as<int>() : options.mapping.filter_rows(array);
+        options.mapping.channel_tile = (vm.count("channel_tile")) ? vm["channel_tile"].as<int>() : options.mapping.channel_cols(array);
+        bool mapping_set = vm.count("orientation") || vm.count("loop_order") || vm.count("filter_tile") || vm.count("channel_tile") || vm.count("search_mapping");
+        if (mapping_set && (vm.count("chain_f_out") || options.cluster_count > 1))
+        {
+            throw std::invalid_argument("mapping options only apply to single layer runs");
+        }
+        options.weight_config.delivery = (vm.count("weight_delivery")) ? weight_delivery_from_string(vm["weight_delivery"].as<string>()) : options.weight_config.delivery;
+        options.weight_config.channel_count = (vm.count("weight_channels")) ? vm["weight_channels"].as<int>() : options.weight_config.channel_count;
+        options.weight_config.reg_capacity = (vm.count("weight_regs")) ? vm["weight_regs"].as<int>() : options.weight_config.reg_capacity;
+        if (vm.count("weight_channels") && options.weight_config.channel_count <= 0)
+        {
+            throw std::invalid_argument("all passed arguments must be positive");
+        }
+        if (vm.count("weight_regs") && options.weight_config.reg_capacity < 2)
+        {
+            throw std::invalid_argument("weight registers must at least double buffer");
+        }
+        if ((vm.count("weight_delivery") || vm.count("weight_channels") || vm.count("weight_regs")) && (vm.count("chain_f_out") || options.cluster_count > 1))
+        {
+            throw std::invalid_argument("weight buffer options only apply to single layer runs");
+        }
 
-    for (int i = 0; i < arch.filter_count; i++)
-    {
-        arch.psum_mem.channels[i].set_mode(MemoryChannelMode::WRITE);
-    }
-    for (int i = arch.filter_count; i < arch.filter_count * 2; i++)
-    {
-        arch.psum_mem.channels[i].set_mode(MemoryChannelMode::READ);
-    }
+        options.ifmap_layout = (vm.count("ifmap_layout")) ? TensorLayout::from_string(vm["ifmap_layout"].as<string>()) : options.ifmap_layout;
+        options.ofmap_layout = (vm.count("ofmap_layout")) ? TensorLayout::from_string(vm["ofmap_layout"].as<string>()) : options.ofmap_layout;
+        if ((vm.count("ifmap_layout") || vm.count("ofmap_layout")) && (vm.count("chain_f_out") || options.cluster_count > 1))
+        {
+            throw std::invalid_argument("layout options only apply to single layer runs");
+        }
 
-    for (int i = 0; i < arch.channel_count; i++)
-    {
-        arch.ifmap_mem.channels[i].set_mode(MemoryChannelMode::READ);
-    }
-}
+        options.ifmap_line_rows = (vm.count("ifmap_line_rows")) ? vm["ifmap_line_rows"].as<int>() : options.ifmap_line_rows;
+        if (vm.count("ifmap_line_rows") && (options.ifmap_line_rows < options.k || options.ifmap_line_rows > options.ifmap_h))
+        {
+            throw std::invalid_argument("line buffer rows must cover the kernel and fit the ifmap");
+        }
+        if (vm.count("ifmap_line_rows") && (options.k != 1 || vm.count("ifmap_layout") || vm.count("chain_f_out") || options.cluster_count > 1))
+        {
+            throw std::invalid_argument("line buffers only apply to single 1x1 layer runs with the nchw ifmap layout");
+        }
 
-template <typename DataType>
-xt::xarray<int> dram_load(Arch<DataType> &arch, int channel_in, int ifmap_h, int ifmap_w)
-{
-    auto input_size = ifmap_h * ifmap_w * channel_in;
-    assert(input_size <= arch.ifmap_mem_size);
+        if (vm.count("global_buffer"))
+        {
+            if (vm.count("ifmap_mem_size") || vm.count("psum_mem_size") || options.cluster_count > 1 || vm.count("pipeline_images"))
+            {
+                throw std::invalid_argument("the global buffer replaces separate SAM capacities and only applies to single arch runs");
+            }
+            // ifmap columns, psum write and read channels and weight rows of
+            // separate SAMs, in whichever orientation needs more
+            int channel_pool = 0;
+            for (auto orientation : {UnrollOrientation::HORIZONTAL, UnrollOrientation::VERTICLE})
+            {
+                Mapping probe(orientation, LoopOrder::FILTER_TILES_OUTER, 1, 1);
+                ArrayShape physical{options.filter_count, options.channel_count, 0, 0};
+                int rows = probe.filter_rows(physical);
+                int cols = probe.channel_cols(physical);
+                channel_pool = std::max(channel_pool, cols + 2 * rows + Arch<sc_int<32>>::weight_channel_count_of(options.weight_config, rows, cols));
+            }
+            channel_pool = (vm.count("global_buffer_channels")) ? vm["global_buffer_channels"].as<int>() : channel_pool;
+            if (vm["global_buffer"].as<int>() <= 0 || channel_pool <= 0)
+            {
+                throw std::invalid_argument("all passed arguments must be positive");
+            }
+            options.global_buffer.reset(new GlobalBuffer(vm["global_buffer"].as<int>(), channel_pool));
+        }
 
-    xt::xarray<int> ifmap = xt::arange((int)1, input_size + 1);
-    ifmap.reshape({channel_in, ifmap_h, ifmap_w});
+        options.compression = (vm.count("compress")) ? compression_format_from_string(vm["compress"].as<string>()) : options.compression;
+        if (options.compression != CompressionFormat::NONE && (options.cluster_count > 1 || vm.count("pipeline_images") || vm.count("ifmap_layout") || vm.count("ifmap_line_rows") || vm.count("global_buffer")))
+        {
+            throw std::invalid_argument("compression only applies to single arch runs with the nchw ifmap layout held whole in ifmap mem");
+        }
 
-    // cout << "IFMAP" << endl;
-    // cout << ifmap << endl;
+        options.reuse_hit_rate = (vm.count("reuse_hit_rate")) ? vm["reuse_hit_rate"].as<double>() : options.reuse_hit_rate;
+        options.reuse_window = (vm.count("reuse_window")) ? vm["reuse_window"].as<int>() : options.reuse_window;
+        if (vm.count("reuse_hit_rate") && (options.reuse_hit_rate <= 0.0 || options.reuse_hit_rate > 1.0 || options.reuse_window <= 0))
+        {
+            throw std::invalid_argument("reuse hit rate must be in (0, 1] and the window positive");
+        }
+        if (vm.count("reuse_hit_rate") && (vm.count("chain_f_out") || options.cluster_count > 1))
+        {
+            throw std::invalid_argument("reuse profiles only apply to single layer runs");
+        }
 
-    for (int c = 0; c < channel_in; c++)
-    {
-        for (int i = 0; i < ifmap_h; i++)
+        options.trace_prefix = (vm.count("record_traces")) ? vm["record_traces"].as<string>() : options.trace_prefix;
+        if (vm.count("record_traces") && (options.trace_prefix.empty() || vm.count("chain_f_out") || options.cluster_count > 1))
         {
-            for (int j = 0; j < ifmap_w; j++)
-            {
-                auto &mem_ptr = arch.ifmap_mem.mem.ram.at(c * (ifmap_h * ifmap_w) + i * ifmap_w + j).at(0);
-                mem_ptr.write(ifmap(c, i, j));
-                arch.dram_access_counter++;
-                arch.ifmap_mem.mem.access_counter++;
-            }
+            throw std::invalid_argument("channel traces need a file prefix and only apply to single layer runs");
         }
-    }
-    sc_start(1, SC_NS);
-    cout << "Loaded dram contents into ifmap mem" << endl;
 
-    return ifmap;
-}
+        options.extrapolation_rows = (vm.count("extrapolate_rows")) ? vm["extrapolate_rows"].as<int>() : options.extrapolation_rows;
+        if (vm.count("extrapolate_rows") && (options.extrapolation_rows <= 0 || options.extrapolation_rows > options.ifmap_h - options.k + 1))
+        {
+            throw std::invalid_argument("extrapolated rows must lie within the ofmap");
+        }
+        if (vm.count("extrapolate_rows") && options.extrapolation_rows * options.ifmap_w < 11)
+        {
+            throw std::invalid_argument("extrapolated tile runs with ifmap sizes below 11 currently unsupported");
+        }
+        if (vm.count("extrapolate_rows") && (vm.count("chain_f_out") || options.cluster_count > 1 || options.post_process_config.enabled() || vm.count("ifmap_layout") || vm.count("ofmap_layout") || vm.count("ifmap_line_rows") || vm.count("global_buffer") || vm.count("compress") || vm.count("memory_levels") || vm.count("reuse_hit_rate") || vm.count("record_traces")))
+        {
+            throw std::invalid_argument("row extrapolation only applies to plain single layer runs");
+        }
 
-template <typename DataType>
-xt::xarray<int> dram_store(Arch<DataType> &arch, int filter_out, int ofmap_h, int ofmap_w)
-{
-    auto output_size = ofmap_h * ofmap_w * filter_out;
-    assert(output_size <= arch.psum_mem_size);
-    xt::xarray<int> result = xt::zeros<int>({filter_out, ofmap_h, ofmap_w});
-    for (int f = 0; f < filter_out; f++)
-    {
-        for (int i = 0; i < ofmap_h; i++)
+        options.watchdog_config.max_cycles = (vm.count("max_cycles")) ? vm["max_cycles"].as<unsigned long int>() : options.watchdog_config.max_cycles;
+        options.watchdog_config.cycle_margin = (vm.count("cycle_margin")) ? vm["cycle_margin"].as<double>() : options.watchdog_config.cycle_margin;
+        options.watchdog_config.stall_cycles = (vm.count("stall_cycles")) ? vm["stall_cycles"].as<unsigned long int>() : options.watchdog_config.stall_cycles;
+        if (options.watchdog_config.cycle_margin < 0.0)
         {
-            for (int j = 0; j < ofmap_w; j++)
-            {
-                auto &mem_ptr = arch.psum_mem.mem.ram.at(f * (ofmap_h * ofmap_w) + i * ofmap_w + j).at(0);
-                result(f, i, j) = mem_ptr.read();
-                arch.dram_access_counter++;
-                arch.psum_mem.mem.access_counter++;
-            }
+            throw std::invalid_argument("the cycle margin must not be negative");
         }
-    }
-    cout << "Loaded dram contents from psum mem" << endl;
-    return result;
-}
 
-template <typename DataType>
-void generate_and_load_pe_program(Arch<DataType> &arch, int ifmap_h, int ifmap_w)
-{
-    int stream_size = ifmap_h * ifmap_w;
-    int delay_offset = 1;
-    for (int channel_column = 0; channel_column < arch.channel_count; channel_column++)
-    {
-        for (int filter_row = 0; filter_row < arch.filter_count; filter_row++)
+        options.save_program = (vm.count("save_program")) ? vm["save_program"].as<string>() : options.save_program;
+        options.load_program = (vm.count("load_program")) ? vm["load_program"].as<string>() : options.load_program;
+        if ((vm.count("save_program") || vm.count("load_program")) && (vm.count("chain_f_out") || options.cluster_count > 1 || vm.count("extrapolate_rows") || vm.count("fast_forward")))
         {
-            PE<DataType> &cur_pe = arch.pe_array[filter_row * arch.channel_count + channel_column];
-            vector<Descriptor_2D> program;
-            program.push_back(Descriptor_2D::delay_inst(channel_column + delay_offset));
-            program.push_back(Descriptor_2D::genhold_inst(0, stream_size, cur_pe.weights.size() - 1, 1));
-            program.push_back(Descriptor_2D::suspend_inst());
-            cur_pe.loadProgram(program);
+            throw std::invalid_argument("program images only apply to single layer runs");
+        }
+        if (vm.count("load_program") && vm.count("ifmap_line_rows"))
+        {
+            // the line buffer feed order is worked out by the ifmap program builder
+            throw std::invalid_argument("program images can't drive ifmap line buffers");
         }
-    }
-}
 
-template <typename DataType>
-void generate_and_load_psum_program(Arch<DataType> &arch, xt::xarray<int> padded_weights, int ofmap_h, int ofmap_w)
-{
-    int verticle_tile_count = padded_weights.shape()[0] / arch.filter_count;
-    int horizontal_tile_count = padded_weights.shape()[1] / arch.channel_count;
+        options.config_path = (vm.count("config_path")) ? config_path_from_string(vm["config_path"].as<string>()) : options.config_path;
+        if (options.config_path != ConfigPath::DIRECT && (vm.count("chain_f_out") || options.cluster_count > 1 || vm.count("extrapolate_rows") || vm.count("fast_forward")))
+        {
+            throw std::invalid_argument("modelled configuration only applies to single layer runs");
+        }
 
-    int stream_size = ofmap_h * ofmap_w;
+        options.fast_forward = vm.count("fast_forward");
+        if (options.fast_forward && (vm.count("chain_f_out") || options.cluster_count > 1 || options.post_process_config.enabled() || vm.count("ifmap_layout") || vm.count("ofmap_layout") || vm.count("ifmap_line_rows") || vm.count("global_buffer") || vm.count("compress") || vm.count("memory_levels") || vm.count("reuse_hit_rate") || vm.count("record_traces") || vm.count("extrapolate_rows")))
+        {
+            throw std::invalid_argument("fast-forward only applies to plain single layer runs");
+        }
 
-    xt::xarray<int> run_bitmap = xt::zeros<int>({verticle_tile_count, (int)arch.filter_count});
-    for (auto filter_offset = 0; filter_offset < (int)padded_weights.shape()[0]; filter_offset += arch.filter_count)
-    {
-        for (auto channel_offset = 0; channel_offset < (int)padded_weights.shape()[1]; channel_offset += arch.channel_count)
+        if (vm.count("memory_levels"))
         {
-            auto tiled_view = xt::view(padded_weights, xt::range(filter_offset, filter_offset + arch.filter_count), xt::range(channel_offset, channel_offset + arch.channel_count));
-            for (int filter = 0; filter < arch.filter_count; filter++)
+            options.memory_levels = memory_levels_from_string(vm["memory_levels"].as<string>());
+            if (vm.count("chain_f_out") || options.cluster_count > 1 || vm.count("ifmap_layout") || vm.count("ifmap_line_rows") || vm.count("global_buffer") || options.compression != CompressionFormat::NONE)
             {
-                int verticle_tile_idx = filter_offset / arch.filter_count;
-                if (tiled_view(filter, 0) != -1)
+                throw std::invalid_argument("memory levels only apply to single layer runs with the nchw ifmap layout held whole in ifmap mem");
+            }
+            // transfers move whole lines of the outermost level
+            long int outer_width = options.memory_levels.front().width;
+            long int staged_words = ((long int)options.c_in * options.ifmap_h * options.ifmap_w + outer_width - 1) / outer_width * outer_width;
+            for (auto &level : options.memory_levels)
+            {
+                if ((long int)level.length * level.width < staged_words)
                 {
-                    run_bitmap(verticle_tile_idx, filter) = 1;
+                    throw std::invalid_argument("every memory level must hold the whole ifmap");
                 }
             }
         }
-    }
-
-    // cout << padded_weights << endl;
-    // cout << run_bitmap << endl;
-
-    for (int write_gen_idx = 0; write_gen_idx < arch.filter_count; write_gen_idx++)
-    {
-        vector<Descriptor_2D> program;
 
-        program.push_back(Descriptor_2D::delay_inst(arch.channel_count + 1));
-        for (int v = 0; v < verticle_tile_count; v++)
+        if (mapping_set)
         {
-            auto active = run_bitmap(v, write_gen_idx);
-            if (active)
+            LayerShape layer{options.c_in, options.f_out, options.k, options.ifmap_h - options.k + 1, options.ifmap_w - options.k + 1};
+            array.ifmap_mem_size = (vm.count("ifmap_mem_size")) ? vm["ifmap_mem_size"].as<int>() : options.c_in * options.ifmap_h * options.ifmap_w;
+            array.psum_mem_size = (vm.count("psum_mem_size")) ? vm["psum_mem_size"].as<int>() : layer.f_out * layer.ofmap_size();
+            if (vm.count("search_mapping"))
             {
-                for (int h = 0; h < horizontal_tile_count; h++)
+                auto ranked = search_mappings(layer, array);
+                if (ranked.empty())
+                {
+                    throw std::invalid_argument("no legal mapping fits the SAM capacities");
+                }
+                cout << std::left << std::setw(20) << "Mapping candidates" << ranked.size() << endl;
+                for (unsigned int rank = 0; rank < std::min((size_t)5, ranked.size()); rank++)
                 {
-                    program.push_back(Descriptor_2D::stream_inst(v * arch.filter_count * stream_size + write_gen_idx * stream_size, stream_size - 1, 0));
+                    auto &cost = ranked[rank].second;
+                    cout << "#" << rank << " " << ranked[rank].first.to_string() << " cycles " << cost.cycles << " dram " << cost.dram_words << " util " << std::setprecision(2) << cost.pe_utilization << " edp " << cost.score << endl;
                 }
+                options.mapping = ranked.front().first;
+            }
+            else if (!options.mapping.legal(layer, array))
+            {
+                throw std::invalid_argument("mapping tiles must fit the array and SAM capacities");
             }
+            cout << std::left << std::setw(20) << "Mapping" << options.mapping.to_string() << endl;
+            cout << std::left << std::setw(20) << "Model Cycles" << estimate_mapping_cost(options.mapping, layer, array).cycles << endl;
         }
 
-        program.push_back(Descriptor_2D::suspend_inst());
-        Descriptor_2D::make_sequential(program);
-        arch.psum_mem.generators.at(write_gen_idx).loadProgram(program);
-    }
-
-    for (int read_gen_idx = arch.filter_count; read_gen_idx < arch.filter_count * 2; read_gen_idx++)
-    {
-        vector<Descriptor_2D> program;
-        program.push_back(Descriptor_2D::delay_inst(3));
-
-        for (int v = 0; v < verticle_tile_count; v++)
+        if (options.cluster_count > 1)
         {
-            auto active = run_bitmap(v, (read_gen_idx - arch.filter_count));
-            if (active)
+            if (vm.count("chain_f_out"))
             {
-                program.push_back(Descriptor_2D::delay_inst(stream_size - 4 * (v == 0) - 1));
-                for (int h = 1; h < horizontal_tile_count; h++)
+                throw std::invalid_argument("fused layers are not supported across clusters");
+            }
+            int pool_alignment = (options.post_process_config.pool != PoolMode::NONE) ? 2 : 1;
+            for (auto &cluster_work : partition_cluster_work(options.partition, options.cluster_count, options.f_out, options.ifmap_h - options.k + 1, pool_alignment))
+            {
+                if ((cluster_work.row_count + options.k - 1) * options.ifmap_w < 11)
                 {
-                    program.push_back(Descriptor_2D::stream_inst((v * arch.filter_count * stream_size) + (read_gen_idx - arch.filter_count) * stream_size, stream_size - 1, 0));
+                    throw std::invalid_argument("row bands with ifmap sizes below 11 currently unsupported");
                 }
             }
         }
-        program.push_back(Descriptor_2D::suspend_inst());
-        Descriptor_2D::make_sequential(program);
-        arch.psum_mem.generators.at(read_gen_idx).loadProgram(program);
-    }
-}
 
-template <typename DataType>
-void generate_and_load_ifmap_in_program(Arch<DataType> &arch, xt::xarray<int> padded_weights, int ifmap_h, int ifmap_w)
-{
-    int verticle_tile_count = padded_weights.shape()[0] / arch.filter_count;
-    int horizontal_tile_count = padded_weights.shape()[1] / arch.channel_count;
-
-    xt::xarray<int> run_bitmap = xt::zeros<int>({verticle_tile_count, horizontal_tile_count, (int)arch.channel_count});
-    for (auto filter_offset = 0; filter_offset < (int)padded_weights.shape()[0]; filter_offset += arch.filter_count)
-    {
-        for (auto channel_offset = 0; channel_offset < (int)padded_weights.shape()[1]; channel_offset += arch.channel_count)
+        if (vm.count("chain_f_out"))
         {
-            auto tiled_view = xt::view(padded_weights, xt::range(filter_offset, filter_offset + arch.filter_count), xt::range(channel_offset, channel_offset + arch.channel_count));
-            for (int channel = 0; channel < arch.channel_count; channel++)
+            options.layer_f_out.push_back(options.f_out);
+            for (auto chain_f_out : vm["chain_f_out"].as<vector<int>>())
             {
-                int verticle_tile_idx = filter_offset / arch.filter_count;
-                int horizontal_tile_idx = channel_offset / arch.channel_count;
-                if (tiled_view(0, channel) != -1)
+                if (chain_f_out <= 0)
                 {
-                    run_bitmap(verticle_tile_idx, horizontal_tile_idx, channel) = 1;
+                    throw std::invalid_argument("all passed arguments must be positive");
                 }
+                options.layer_f_out.push_back(chain_f_out);
             }
-        }
-    }
 
-    // cout << padded_weights << endl;
-
-    // cout << run_bitmap << endl;
-
-    int ag_idx = 0;
-    for (auto &ag : arch.ifmap_mem.generators)
-    {
-        std::deque<Descriptor_2D> program;
-        auto systolic_delay = Descriptor_2D::delay_inst(ag_idx);
-        program.push_back(systolic_delay);
-        for (int v = 0; v < verticle_tile_count; v++)
-        {
-            for (int h = 0; h < horizontal_tile_count; h++)
+            // default capacities hold the largest layer of the chain in one strip
+            vector<int> layer_channels(1, options.c_in);
+            layer_channels.insert(layer_channels.end(), options.layer_f_out.begin(), options.layer_f_out.end());
+            int h = options.ifmap_h;
+            int w = options.ifmap_w;
+            for (unsigned int layer = 0; layer < options.layer_f_out.size(); layer++)
             {
-                int active = run_bitmap(v, h, ag_idx);
-                int stream_size = ifmap_h * ifmap_w;
-                int stream_start_idx = h * arch.channel_count * stream_size + ag_idx * stream_size;
+                options.ifmap_mem_size = std::max(options.ifmap_mem_size, layer_channels[layer] * h * w);
+                options.psum_mem_size = std::max(options.psum_mem_size, layer_channels[layer + 1] * h * w);
+                h = (options.post_process_config.pool != PoolMode::NONE) ? h / 2 : h;
+                w = (options.post_process_config.pool != PoolMode::NONE) ? w / 2 : w;
+            }
+            options.ifmap_mem_size = (vm.count("ifmap_mem_size")) ? vm["ifmap_mem_size"].as<int>() : options.ifmap_mem_size;
+            options.psum_mem_size = (vm.count("psum_mem_size")) ? vm["psum_mem_size"].as<int>() : options.psum_mem_size;
 
-                if (active)
+            if (vm.count("pipeline_images"))
+            {
+                options.pipeline_images = vm["pipeline_images"].as<int>();
+                if (options.pipeline_images <= 0)
                 {
-                    auto stream_inst = Descriptor_2D::stream_inst(stream_start_idx, stream_size - 1, 0);
-                    program.push_back(stream_inst);
+                    throw std::invalid_argument("all passed arguments must be positive");
                 }
-                else
+                int h = options.ifmap_h;
+                int w = options.ifmap_w;
+                for (unsigned int layer = 0; layer < options.layer_f_out.size(); layer++)
                 {
-                    auto delay_inst = Descriptor_2D::delay_inst(stream_size - 1);
-                    program.push_back(delay_inst);
+                    if (h * w < 11 || (options.post_process_config.pool != PoolMode::NONE && (h < 2 || w < 2)))
+                    {
+                        throw std::invalid_argument("pipeline stage ifmap too small, sizes below 11 currently unsupported");
+                    }
+                    h = (options.post_process_config.pool != PoolMode::NONE) ? h / 2 : h;
+                    w = (options.post_process_config.pool != PoolMode::NONE) ? w / 2 : w;
                 }
             }
+
+            vector<int> layer_weight_words;
+            for (unsigned int layer = 0; layer < options.layer_f_out.size(); layer++)
+            {
+                layer_weight_words.push_back(padded_weight_size(Mapping::full_array({options.filter_count, options.channel_count, 0, 0}), options.filter_count, options.channel_count, layer_channels[layer + 1], layer_channels[layer], options.k));
+            }
+            vector<int> layer_region_channels = {options.channel_count, 2 * options.filter_count, Arch<sc_int<32>>::weight_channel_count_of(WeightBufferConfig(), options.filter_count, options.channel_count)};
+            options.strip_rows = schedule_fused_strip_rows(layer_channels, options.ifmap_h, options.ifmap_w, options.post_process_config, options.ifmap_mem_size, options.psum_mem_size, options.global_buffer.get(), layer_weight_words, layer_region_channels);
+            if (options.strip_rows == 0 && !options.pipeline_images)
+            {
+                throw std::invalid_argument("no strip schedule of the fused layers fits the SAM capacities");
+            }
         }
-        program.push_back(Descriptor_2D::suspend_inst());
-        vector<Descriptor_2D> prog_vec(program.begin(), program.end());
-        Descriptor_2D::make_sequential(prog_vec);
-        ag.loadProgram(prog_vec);
-        ag_idx++;
     }
-}
-
-enum UnrollOrientation
-{
-    HORIZONTAL = 1,
-    VERTICLE = 2
-};
-
-template <typename DataType>
-tuple<xt::xarray<int>, xt::xarray<int>> generate_and_load_weights(Arch<DataType> &arch, int filter_out_dim, int channel_in_dim, int kernel, UnrollOrientation unroll_orientation)
-{
-    int kernel_size = kernel * kernel;
-    xt::xarray<int> weights = xt::arange(1, channel_in_dim * filter_out_dim * kernel_size + 1);
-    vector<vector<deque<int>>> pe_weights(arch.filter_count, vector<deque<int>>(arch.channel_count, deque<int>()));
-
-    long unsigned int verticle_padding;
-    long unsigned int horizontal_padding;
-
-    switch (unroll_orientation)
-    {
-    case UnrollOrientation::HORIZONTAL:
+    catch (std::exception &e)
     {
-        weights.reshape({filter_out_dim, channel_in_dim * kernel_size});
-        verticle_padding = ceil((float)filter_out_dim / arch.filter_count) * arch.filter_count - filter_out_dim;
-        horizontal_padding = ceil((float)(channel_in_dim * kernel_size) / arch.channel_count) * arch.channel_count - (channel_in_dim * kernel_size);
-        break;
+        cout << "error: " << e.what() << "\n";
+        cout << "FAIL" << endl;
+
+        return 1;
     }
-    default:
-        cout << "INVALID ORIENTATION" << endl;
-        exit(EXIT_FAILURE);
-        break;
+    catch (...)
+    {
+        cout << "Exception of unknown type!\n";
+        cout << "FAIL" << endl;
+
+        return 1;
     }
+    cout << std::left << "Simulating arch with config:" << endl;
+    cout << endl;
 
-    xt::xarray<int> padded_weights = xt::pad(weights, {{0, verticle_padding}, {0, horizontal_padding}}, xt::pad_mode::constant, PAD);
+    cout << std::left << std::setw(20) << "Build" << BUILD_ID << endl;
+
+    cout << std::left << std::setw(20) << "filter_count"  << options.filter_count << endl;;
+    cout << std::left << std::setw(20) << "channel_count"  << options.channel_count << endl;;
+    cout << endl;
 
-    // cout << padded_weights << endl;
+    cout << std::left << "With layer config:" << endl;
+    cout << endl;
+    cout << std::left << std::setw(20) << "ifmap_h"  << options.ifmap_h << endl;
+    cout << std::left << std::setw(20) << "ifmap_w" << options.ifmap_w << endl;
+    cout << std::left << std::setw(20) << "k" << options.k << endl;
+    cout << std::left << std::setw(20) << "c_in" << options.c_in << endl;
+    cout << std::left << std::setw(20) << "f_out" << options.f_out << endl;
 
-    for (auto filter_offset = 0; filter_offset < (int)padded_weights.shape()[0]; filter_offset += arch.filter_count)
+    // simulation errors, e.g. a PE's weight registers running over, fail the configuration
+    try
     {
-        for (auto channel_offset = 0; channel_offset < (int)padded_weights.shape()[1]; channel_offset += arch.channel_count)
+        if (options.cluster_count > 1)
         {
-            auto tiled_view = xt::view(padded_weights, xt::range(filter_offset, filter_offset + arch.filter_count), xt::range(channel_offset, channel_offset + arch.channel_count));
-
-            for (auto i = 0; i < arch.filter_count; i++)
-            {
-                for (auto j = 0; j < arch.channel_count; j++)
-                {
-                    pe_weights[i][j].push_back(tiled_view(i, j));
-                    arch.dram_access_counter++;
-                }
-            }
+            cout << std::left << std::setw(20) << "clusters" << options.cluster_count << endl;
+            sim_clusters_and_get_results<sc_int<32>>(options);
         }
-    }
-
-    for (int filter_row = 0; filter_row < arch.filter_count; filter_row++)
-    {
-        for (int channel_column = 0; channel_column < arch.channel_count; channel_column++)
+        else if (options.pipeline_images)
         {
-            auto &cur_pe = arch.pe_array[filter_row * arch.channel_count + channel_column];
-            vector<int> pe_weight_temp(pe_weights[filter_row][channel_column].begin(), pe_weights[filter_row][channel_column].end());
-            cur_pe.loadWeights(pe_weight_temp);
+            cout << std::left << std::setw(20) << "pipeline stages" << options.layer_f_out.size() << endl;
+            sim_pipeline_and_get_results<sc_int<32>>(options);
         }
-    }
-
-    weights.reshape({filter_out_dim, channel_in_dim, kernel, kernel});
-    return std::make_tuple(weights, padded_weights);
-}
-
-xt::xarray<int> generate_expected_output(xt::xarray<int> ifmap, xt::xarray<int> weights)
-{
-    // weights.shape() = F*C*K*K
-    assert(weights.shape().size() == 4);
-    // cout << xt::adapt(weights.shape()) << endl;
-    // ifmap.shape() = C*H*W
-    assert(ifmap.shape().size() == 3);
-    // cout << xt::adapt(ifmap.shape()) << endl;
-    // cout << ifmap << endl;
-    // symmetric kernel
-    assert(weights.shape(3) == weights.shape(2));
-
-    // ifmap channel = weights channel in
-    assert(ifmap.shape(0) == weights.shape(1));
-    int ifmap_w = ifmap.shape(2);
-    int ifmap_h = ifmap.shape(1);
-
-    int kernel = weights.shape(3);
-    assert(ifmap_w >= kernel);
-    assert(ifmap_h >= kernel);
-
-    int ofmap_w = ifmap_w - (kernel - 1);
-    int ofmap_h = ifmap_h - (kernel - 1);
-    int ofmap_c = weights.shape(0);
-
-    xt::xarray<int> ofmap = xt::arange(ofmap_c * ofmap_w * ofmap_h).reshape({ofmap_c, ofmap_h, ofmap_w});
-
-    // conv2d stride 1
-    for (auto f = 0; f < ofmap_c; f++)
-    {
-        auto weight_tensor_view = xt::view(weights, f, xt::all(), xt::all(), xt::all());
-        xt::xarray<int> flatten_weight(xt::flatten(weight_tensor_view));
-        for (auto h = 0; h < ofmap_h; h++)
+        else if (!options.layer_f_out.empty())
         {
-            for (auto w = 0; w < ofmap_w; w++)
-            {
-                auto ifmap_tensor_view = xt::view(ifmap, xt::all(), xt::range(h, h + kernel), xt::range(w, w + kernel));
-                xt::xarray<int> flattened_ifmap(xt::flatten(ifmap_tensor_view));
-                auto val = xt::linalg::dot(flattened_ifmap, flatten_weight);
-                ofmap(f, h, w) = val(0);
-            }
+            cout << std::left << std::setw(20) << "fused layers" << options.layer_f_out.size() << endl;
+            sim_fused_and_get_results<sc_int<32>>(options);
+        }
+        else if (options.fast_forward)
+        {
+            sim_fast_forward_and_get_results<sc_int<32>>(options);
+        }
+        else if (options.extrapolation_rows)
+        {
+            sim_extrapolated_and_get_results<sc_int<32>>(options);
+        }
+        else
+        {
+            sim_and_get_results<sc_int<32>>(options);
         }
     }
-
-    return ofmap;
-}
-
-bool validate_expected_output(xt::xarray<int> expected, xt::xarray<int> result)
-{
-    // cout << "EXPECTED RESULT" << endl;
-    // cout << expected << endl;
-    // cout << "ACTUAL RESULT" << endl;
-    // cout << result << endl;
-    return expected == result;
-}
-
-template <typename DataType>
-void sim_and_get_results(int ifmap_h, int ifmap_w, int k, int c_in, int f_out, int filter_count, int channel_count)
-{
-    auto t1 = high_resolution_clock::now();
-
-    int ofmap_h = (ifmap_h - k + 1);
-    int ofmap_w = (ifmap_w - k + 1);
-    int ifmap_mem_size = c_in * ifmap_h * ifmap_w;
-    int psum_mem_size = f_out * ofmap_h * ofmap_w;
-
-    xt::xarray<int> weights, padded_weights;
-
-    xt::print_options::set_threshold(10000);
-    xt::print_options::set_line_width(100);
-
-    sc_trace_file *tf = sc_create_vcd_trace_file("Arch1x1");
-    tf->set_time_unit(100, SC_PS);
-
-    GlobalControlChannel control("global_control_channel", sc_time(1, SC_NS), tf);
-    Arch<DataType> arch("arch", control, filter_count, channel_count, psum_mem_size, ifmap_mem_size, tf);
-
-    unsigned long int start_cycle_time = sc_time_stamp().value();
-    control.set_reset(true);
-    sc_start(10, SC_NS);
-    control.set_reset(false);
-    sc_start(1, SC_NS);
-
-    auto ifmap = dram_load(arch, c_in, ifmap_h, ifmap_w);
-    // cout << ifmap << endl;
-
-    set_channel_modes(arch);
-    std::tie(weights, padded_weights) = generate_and_load_weights(arch, f_out, c_in, k, UnrollOrientation::HORIZONTAL);
-
-    // cout << "PADDED WEIGHTS" << endl;
-    // cout << padded_weights << endl;
-
-    generate_and_load_pe_program(arch, ifmap_h, ifmap_w);
-    generate_and_load_ifmap_in_program(arch, padded_weights, ifmap_h, ifmap_w);
-    generate_and_load_psum_program(arch, padded_weights, ofmap_h, ofmap_w);
-
-    control.set_program(true);
-    sc_start(1, SC_NS);
-    control.set_enable(true);
-    control.set_program(false);
-    sc_start();
-
-    auto res = dram_store(arch, f_out, ofmap_h, ofmap_w);
-    auto expected_ofmap = generate_expected_output(ifmap, weights);
-    auto valid = validate_expected_output(expected_ofmap, res);
-    unsigned long int end_cycle_time = sc_time_stamp().value();
-
-    auto t2 = high_resolution_clock::now();
-    auto sim_time = duration_cast<milliseconds>(t2 - t1);
-
-    if (valid)
-    {
-        cout << "PASS" << endl;
-        int weight_access = 0;
-        xt::xarray<float> pe_utilization = xt::zeros<float>({1, (int)arch.pe_array.size()});
-        int pe_idx = 0;
-        for (auto &pe : arch.pe_array)
-        {
-            weight_access += pe.weight_access_counter;
-            pe_utilization(0, pe_idx++) = (float)pe.active_counter / (float)(pe.active_counter + pe.inactive_counter);
-        }
-        float avg_util = xt::average(pe_utilization)(0);
-        cout << std::left << std::setw(20) << "DRAM Access" << arch.dram_access_counter << endl;
-        cout << std::left << std::setw(20) << "Weight Access" << weight_access << endl;
-        cout << std::left << std::setw(20) << "Psum Access" << arch.psum_mem.mem.access_counter << endl;
-        cout << std::left << std::setw(20) << "Ifmap Access" << arch.ifmap_mem.mem.access_counter << endl;
-        cout << std::left << std::setw(20) << "Avg. Pe Util" << std::setprecision(2) << avg_util << endl;
-        cout << std::left << std::setw(20) << "Latency in cycles" << end_cycle_time - start_cycle_time << endl;
-        cout << std::left << std::setw(20) << "Simulated in " << sim_time.count() << "ms\n";
-        exit(EXIT_SUCCESS); // avoids expensive de-alloc
-    }
-    else
+    catch (std::exception &e)
     {
+        cout << "error: " << e.what() << "\n";
         cout << "FAIL" << endl;
+        return 1;
     }
+
+    return 0;
 }
 
+// With --serve the process stays loaded and forks a child per configuration
+// line, each line holds the options of a single run. Every child elaborates
+// its own arch, so SystemC only ever elaborates once per process.
 int sc_main(int argc, char *argv[])
 {
-    int ifmap_h = 10;
-    int ifmap_w = 10;
-    int k = 1;
-    int c_in = 16;
-    int f_out = 16;
-    int filter_count = 7;
-    int channel_count = 9;
+    po::options_description serve_options("Fork server");
+    serve_options.add_options()("serve", "read one configuration of options per line and run each in a forked child, results are written as JSON lines")("configs", po::value<string>(), "read configurations from this file instead of stdin")("jobs", po::value<int>(), "set concurrently running configurations, defaults to the online cores")("timeout", po::value<double>(), "kill a configuration still running after this many seconds and report it as FAIL, 0 for no limit");
+    po::variables_map vm;
+    vector<string> run_options;
     try
     {
-        po::options_description config("Configuration");
-        config.add_options()("help", "produce help message")("ifmap_h", po::value<int>(), "set input feature map width")("ifmap_w", po::value<int>(), "set input feature map height")("k", po::value<int>(), "set kernel size")("c_in", po::value<int>(), "set ifmap channel count")("f_out", po::value<int>(), "set weight filter count")("filter_count", po::value<int>(), "set arch width")("channel_count", po::value<int>(), "set arch height");
-
-        po::variables_map vm;
-        po::store(po::parse_command_line(argc, argv, config), vm);
+        auto parsed = po::command_line_parser(argc, argv).options(serve_options).allow_unregistered().run();
+        po::store(parsed, vm);
         po::notify(vm);
+        run_options = po::collect_unrecognized(parsed.options, po::include_positional);
+    }
+    catch (std::exception &e)
+    {
+        cout << "error: " << e.what() << "\n";
+        cout << "FAIL" << endl;
+        return 1;
+    }
 
-        if (vm.count("help"))
+    if (!vm.count("serve"))
+    {
+        int status = run_configuration(argc, argv);
+        for (int arg = 1; arg < argc; arg++)
         {
-            cout << config << "\n";
-            return 0;
+            if (string(argv[arg]) == "--help")
+            {
+                cout << serve_options << "\n";
+            }
         }
+        return status;
+    }
 
-        ifmap_h = (vm.count("ifmap_h")) ? vm["ifmap_h"].as<int>() : ifmap_h;
-        ifmap_w = (vm.count("ifmap_w")) ? vm["ifmap_w"].as<int>() : ifmap_w;
-        k = (vm.count("k")) ? vm["k"].as<int>() : k;
-        c_in = (vm.count("c_in")) ? vm["c_in"].as<int>() : c_in;
-        f_out = (vm.count("f_out")) ? vm["f_out"].as<int>() : f_out;
-        filter_count = (vm.count("filter_count")) ? vm["filter_count"].as<int>() : filter_count;
-        channel_count = (vm.count("channel_count")) ? vm["channel_count"].as<int>() : channel_count;
-
-        if (ifmap_h <= 0 || ifmap_w <= 0 || k <= 0 || c_in <= 0 || f_out <= 0 || filter_count <= 0 || channel_count <= 0)
+    try
+    {
+        int jobs = (vm.count("jobs")) ? vm["jobs"].as<int>() : std::max(1L, sysconf(_SC_NPROCESSORS_ONLN));
+        if (jobs <= 0 || !run_options.empty())
         {
-            throw std::invalid_argument("all passed arguments must be positive");
+            throw std::invalid_argument("jobs must be positive, run options go on the configuration lines");
         }
-
-        if ((ifmap_h * ifmap_w) < 11)
+        double timeout = (vm.count("timeout")) ? vm["timeout"].as<double>() : 0.0;
+        ForkServer server(jobs, argv[0], timeout);
+        if (vm.count("configs"))
         {
-            throw std::invalid_argument("total ifmap sizes below 11 currently unsupported");
+            std::ifstream configs(vm["configs"].as<string>());
+            if (!configs)
+            {
+                throw std::runtime_error("could not open " + vm["configs"].as<string>());
+            }
+            server.run(configs, cout, run_configuration);
         }
-
-        if (k > 1)
+        else
         {
-            throw std::invalid_argument("kernel sizes greater than 1 currently unsupported");
+            server.run(std::cin, cout, run_configuration);
         }
+        return 0;
     }
     catch (std::exception &e)
     {
         cout << "error: " << e.what() << "\n";
         cout << "FAIL" << endl;
-
         return 1;
     }
-    catch (...)
-    {
-        cout << "Exception of unknown type!\n";
-        cout << "FAIL" << endl;
-
-        return 1;
-    }
-    cout << std::left << "Simulating arch with config:" << endl;
-    cout << endl;
-
-    cout << std::left << std::setw(20) << "filter_count"  << filter_count << endl;;
-    cout << std::left << std::setw(20) << "channel_count"  << channel_count << endl;;
-    cout << endl;
-
-    cout << std::left << "With layer config:" << endl;
-    cout << endl;
-    cout << std::left << std::setw(20) << "ifmap_h"  << ifmap_h << endl;
-    cout << std::left << std::setw(20) << "ifmap_w" << ifmap_w << endl;
-    cout << std::left << std::setw(20) << "k" << k << endl;
-    cout << std::left << std::setw(20) << "c_in" << c_in << endl;
-    cout << std::left << std::setw(20) << "f_out" << f_out << endl;
-
-    sim_and_get_results<sc_int<32>>(ifmap_h, ifmap_w, k, c_in, f_out, filter_count, channel_count);
-
-    return 0;
 }
 
 #endif // MEM_HIERARCHY_CPP
@@ -0,0 +1,34 @@
+# Runs one layer in full and with --fast_forward and checks that both report
+# the same latency and access counts.
+#   cmake -DENVIRONMENT=<estimation_enviornment> "-DARGS=<layer options>" -P fast_forward_check.cmake
+
+separate_arguments(LAYER_ARGS UNIX_COMMAND "${ARGS}")
+set(METRICS "Latency in cycles" "DRAM Access" "Weight Access" "Psum Access" "Ifmap Access" "Weight SAM Access")
+
+function(run_layer mode out_var)
+    execute_process(
+        COMMAND ${ENVIRONMENT} ${LAYER_ARGS} ${ARGN}
+        OUTPUT_VARIABLE output
+        RESULT_VARIABLE result
+    )
+    if(NOT result EQUAL 0 OR NOT output MATCHES "\nPASS\n")
+        message(FATAL_ERROR "${mode} run of ${ARGS} failed:\n${output}")
+    endif()
+    set(${out_var} "${output}" PARENT_SCOPE)
+endfunction()
+
+run_layer("full" full)
+run_layer("fast-forward" fast --fast_forward)
+
+foreach(metric IN LISTS METRICS)
+    foreach(run full fast)
+        if(NOT ${run} MATCHES "${metric} *([0-9]+)\n")
+            message(FATAL_ERROR "no ${metric} in the ${run} run of ${ARGS}")
+        endif()
+        set(${run}_value ${CMAKE_MATCH_1})
+    endforeach()
+    if(NOT full_value EQUAL fast_value)
+        message(FATAL_ERROR "${metric} of ${ARGS}: ${fast_value} fast-forwarded, ${full_value} in full")
+    endif()
+endforeach()
+message(STATUS "ALL TESTS PASS")
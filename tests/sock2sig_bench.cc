@@ -0,0 +1,144 @@
+/**
+ * @file sock2sig_bench.cc
+ * @brief Pushes one block through Sock2Sig at every supported bus width,
+ * checks the beats reassemble it and reports the throughput in bytes per
+ * simulated cycle and per wall-second. The widths run one after another so
+ * each one's wall time is its own.
+ */
+
+#include <tlm_utils/simple_initiator_socket.h>
+
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <systemc>
+#include <vector>
+
+#include "sock2sig.hh"
+
+using std::chrono::duration;
+using std::chrono::high_resolution_clock;
+
+const sc_time cycle(1, SC_NS);
+
+template <unsigned int BUSWIDTH>
+class WidthBench : public sc_module {
+  SC_HAS_PROCESS(WidthBench<BUSWIDTH>);
+
+ public:
+  WidthBench(sc_module_name moduleName, const std::vector<uint8_t>& data,
+             sc_event* after)
+      : sc_module(moduleName),
+        adapter(1, "adapter"),
+        data(data),
+        after(after),
+        beats(0) {
+    adapter.inputSock(outputSock);
+    adapter.outputSig(beatSig);
+    adapter.dataReady(dataReadySig);
+    adapter.assertRead(assertReadSig);
+    SC_THREAD(send);
+    SC_THREAD(receive);
+  }
+
+  tlm_utils::simple_initiator_socket<WidthBench, BUSWIDTH> outputSock;
+  Sock2Sig<BUSWIDTH> adapter;
+  sc_signal<typename SockBeat<BUSWIDTH>::type> beatSig;
+  sc_signal<bool> dataReadySig, assertReadSig;
+
+  const std::vector<uint8_t>& data;
+  std::vector<uint8_t> received;
+  sc_event* after;
+  sc_event done;
+  unsigned long int beats;
+  sc_time simStart, simTime;
+  high_resolution_clock::time_point wallStart;
+  double wallSeconds;
+
+  bool valid() const { return received == data; }
+
+  void report() const {
+    double cycles = simTime / cycle;
+    std::cout << std::left << std::setw(10) << BUSWIDTH << std::setw(10)
+              << beats << std::setw(14) << data.size() / cycles
+              << data.size() / wallSeconds / 1e6 << std::endl;
+  }
+
+ private:
+  void send() {
+    if (after) wait(*after);
+    simStart = sc_time_stamp();
+    wallStart = high_resolution_clock::now();
+
+    tlm::tlm_generic_payload trans;
+    sc_time transportTime = SC_ZERO_TIME;
+    trans.set_write();
+    trans.set_data_ptr(const_cast<unsigned char*>(data.data()));
+    trans.set_data_length(data.size());
+    outputSock->b_transport(trans, transportTime);
+  }
+
+  void receive() {
+    const size_t beatBytes = BUSWIDTH / 8;
+    while (received.size() < data.size()) {
+      wait(dataReadySig.posedge_event());
+
+      auto value = beatSig.read();
+      size_t count = std::min(beatBytes, data.size() - received.size());
+      for (size_t lo = 0; lo < count; lo += 8) {
+        uint64_t part =
+            value.range(std::min<size_t>(8 * lo + 63, BUSWIDTH - 1), 8 * lo)
+                .to_uint64();
+        size_t partBytes = std::min<size_t>(8, count - lo);
+        received.resize(received.size() + partBytes);
+        memcpy(&received[received.size() - partBytes], &part, partBytes);
+      }
+      beats++;
+
+      assertReadSig = true;
+      wait(cycle);
+      assertReadSig = false;
+    }
+    simTime = sc_time_stamp() - simStart;
+    wallSeconds =
+        duration<double>(high_resolution_clock::now() - wallStart).count();
+    done.notify(SC_ZERO_TIME);
+  }
+};
+
+int sc_main(int argc, char* argv[]) {
+  // not a multiple of any width, the last beat of each is partial
+  std::vector<uint8_t> data(64 * 1024 + 3);
+  for (size_t i = 0; i < data.size(); i++) data[i] = (i * 131 + 7) & 0xff;
+
+  WidthBench<8> bench8("bench_8", data, nullptr);
+  WidthBench<32> bench32("bench_32", data, &bench8.done);
+  WidthBench<64> bench64("bench_64", data, &bench32.done);
+  WidthBench<128> bench128("bench_128", data, &bench64.done);
+  WidthBench<256> bench256("bench_256", data, &bench128.done);
+  WidthBench<512> bench512("bench_512", data, &bench256.done);
+  WidthBench<1024> bench1024("bench_1024", data, &bench512.done);
+
+  sc_start();
+
+  std::cout << std::left << std::setw(10) << "Bits" << std::setw(10)
+            << "Beats" << std::setw(14) << "Bytes/cycle"
+            << "MB/wall-second" << std::endl;
+  bench8.report();
+  bench32.report();
+  bench64.report();
+  bench128.report();
+  bench256.report();
+  bench512.report();
+  bench1024.report();
+
+  if (!bench8.valid() || !bench32.valid() || !bench64.valid() ||
+      !bench128.valid() || !bench256.valid() || !bench512.valid() ||
+      !bench1024.valid()) {
+    std::cout << "received data differs FAILED!" << std::endl;
+    return -1;
+  }
+  std::cout << "ALL TESTS PASS" << std::endl;
+  return 0;
+}
@@ -0,0 +1,72 @@
+#include "ChannelTrace.hh"
+#include <boost/program_options.hpp>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <systemc>
+#include <thread>
+
+namespace po = boost::program_options;
+using namespace std::chrono;
+using std::cout;
+using std::endl;
+
+// Replays channel traces written by estimation_enviornment --record_traces
+// into memory variants without re-running the array.
+int sc_main(int argc, char *argv[])
+{
+    vector<string> trace_paths;
+    vector<ReplayConfig> configs;
+    unsigned int threads = std::max(std::thread::hardware_concurrency(), 1U);
+    try
+    {
+        po::options_description config("Configuration");
+        config.add_options()("help", "produce help message")("trace", po::value<vector<string>>()->multitoken(), "channel trace files to replay")("variants", po::value<string>(), "memory variants, comma separated banks:latency:width")("threads", po::value<int>(), "set replay worker threads, defaults to the hardware threads");
+
+        po::variables_map vm;
+        po::store(po::parse_command_line(argc, argv, config), vm);
+        po::notify(vm);
+
+        if (vm.count("help"))
+        {
+            cout << config << "\n";
+            return 0;
+        }
+        if (!vm.count("trace") || !vm.count("variants"))
+        {
+            throw std::invalid_argument("--trace and --variants are required");
+        }
+        trace_paths = vm["trace"].as<vector<string>>();
+        configs = replay_configs_from_string(vm["variants"].as<string>());
+        if (vm.count("threads") && vm["threads"].as<int>() <= 0)
+        {
+            throw std::invalid_argument("all passed arguments must be positive");
+        }
+        threads = (vm.count("threads")) ? vm["threads"].as<int>() : threads;
+
+        for (auto &path : trace_paths)
+        {
+            auto t1 = high_resolution_clock::now();
+            auto trace = ChannelTrace::load(path);
+            auto results = replay_variants(trace, configs, threads);
+            auto t2 = high_resolution_clock::now();
+
+            unsigned long int span = (trace.accesses.empty()) ? 0 : trace.accesses.back().cycle - trace.accesses.front().cycle + 1;
+            cout << path << ": " << trace.accesses.size() << " accesses over " << span << " cycles on " << trace.channel_count << " channels, " << trace.length << "x" << trace.width << endl;
+            cout << std::left << std::setw(16) << "banks:lat:width" << std::setw(12) << "cycles" << std::setw(12) << "stalls" << std::setw(12) << "lines" << std::setw(12) << "conflicts" << "bank util" << endl;
+            for (auto &result : results)
+            {
+                cout << std::left << std::setw(16) << result.config.to_string() << std::setw(12) << result.cycles << std::setw(12) << result.stall_cycles << std::setw(12) << result.line_accesses << std::setw(12) << result.conflict_cycles << std::setprecision(2) << result.bank_utilization() << endl;
+            }
+            cout << std::left << std::setw(16) << "Replayed in " << duration_cast<milliseconds>(t2 - t1).count() << "ms\n";
+        }
+    }
+    catch (std::exception &e)
+    {
+        cout << "error: " << e.what() << "\n";
+        cout << "FAIL" << endl;
+
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,114 @@
+/**
+ * @file traffic_bench.cc
+ * @brief Loads the interconnect, DRAM arbiter and memory path with a set of
+ * traffic mixes and reports each one's throughput, latency distribution and
+ * simulation speed. The mixes run one after another so each one's wall time
+ * is its own, a mix whose transactions per wall-second drop well below the
+ * others points at where the simulation slows down.
+ */
+
+#include <systemc.h>
+#include <iomanip>
+#include <memory>
+#include "DramArbiter.hh"
+#include "TrafficGenerator.hh"
+#include "iconnect.h"
+#include "memory.h"
+
+using std::cout;
+using std::endl;
+
+const sc_time cycle(1, SC_NS);
+const sc_time dram_latency(10, SC_NS);
+const unsigned int dram_size = 1 << 20;
+const unsigned int bytes_per_cycle = 8;
+const unsigned long int transactions = 20000;
+
+struct TrafficMix
+{
+    string name;
+    TrafficConfig config;
+};
+
+TrafficMix make_mix(string name, TrafficPattern pattern, unsigned int size, unsigned int stride, double read_fraction, unsigned int max_outstanding, unsigned int interval_cycles)
+{
+    TrafficConfig config;
+    config.pattern = pattern;
+    config.range = 64 * 1024;
+    config.size = size;
+    config.stride = stride;
+    config.read_fraction = read_fraction;
+    config.max_outstanding = max_outstanding;
+    config.interval = cycle * interval_cycles;
+    config.transactions = transactions;
+    return {name, config};
+}
+
+void report(const string &name, const TrafficStats &stats)
+{
+    std::stringstream histogram;
+    auto bins = stats.log2_histogram();
+    for (size_t bin = 0; bin < bins.size(); bin++)
+    {
+        if (bins[bin])
+        {
+            histogram << "<" << (1ul << bin) << ":" << bins[bin] << " ";
+        }
+    }
+    cout << std::left << std::setw(22) << name << std::setw(8) << stats.transactions()
+         << std::setw(13) << std::setprecision(4) << stats.bytes_per_cycle()
+         << std::setw(8) << stats.mean_latency() << std::setw(6) << stats.latency_percentile(0.5)
+         << std::setw(6) << stats.latency_percentile(0.99) << std::setw(14) << (unsigned long int)stats.transactions_per_wall_second()
+         << histogram.str() << endl;
+}
+
+int sc_main(int argc, char *argv[])
+{
+    const vector<TrafficMix> mixes = {
+        make_mix("sequential write", TrafficPattern::SEQUENTIAL, 64, 0, 0.0, 1, 0),
+        make_mix("sequential read x4", TrafficPattern::SEQUENTIAL, 64, 0, 1.0, 4, 0),
+        make_mix("paced write x4", TrafficPattern::SEQUENTIAL, 64, 0, 0.0, 4, 16),
+        make_mix("strided 4B", TrafficPattern::STRIDED, 4, 4096, 0.5, 1, 0),
+        make_mix("random mixed x8", TrafficPattern::RANDOM, 64, 0, 0.5, 8, 0),
+        make_mix("random 4B x16", TrafficPattern::RANDOM, 4, 0, 0.5, 16, 0),
+    };
+    const unsigned int mix_count = 6;
+    assert(mixes.size() == mix_count);
+
+    iconnect<mix_count, 1> bus("bus");
+    DramArbiter arbiter("arbiter", cycle, bytes_per_cycle, 1);
+    memory dram("dram", dram_latency, dram_size);
+    bus.memmap(0, dram_size, ADDRMODE_RELATIVE, -1, arbiter.target_socket);
+    arbiter.init_socket.bind(dram.socket);
+
+    vector<std::unique_ptr<TrafficGenerator<32>>> generators;
+    for (unsigned int i = 0; i < mix_count; i++)
+    {
+        string name = "generator_" + std::to_string(i);
+        generators.emplace_back(new TrafficGenerator<32>(name.c_str(), mixes[i].config, cycle));
+        generators[i]->socket.bind(*bus.t_sk[i]);
+        bus.set_target_offset(i, 0);
+        generators[i]->after = (i) ? &generators[i - 1]->done : nullptr;
+    }
+
+    sc_start();
+
+    cout << std::left << std::setw(22) << "Mix" << std::setw(8) << "Count" << std::setw(13) << "Bytes/cycle"
+         << std::setw(8) << "Mean" << std::setw(6) << "p50" << std::setw(6) << "p99" << std::setw(14) << "Trans/wall-s"
+         << "Latency cycles" << endl;
+    for (unsigned int i = 0; i < mix_count; i++)
+    {
+        report(mixes[i].name, generators[i]->stats);
+    }
+
+    for (auto &generator : generators)
+    {
+        if (generator->stats.errors || generator->stats.transactions() != transactions)
+        {
+            cout << generator->name() << " completed " << generator->stats.transactions() << " with " << generator->stats.errors << " errors FAILED!" << endl;
+            return -1;
+        }
+    }
+    cout << "ALL TESTS PASS" << endl;
+    return 0;
+}